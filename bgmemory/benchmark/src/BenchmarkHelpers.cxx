@@ -0,0 +1,71 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "./BenchmarkHelpers.hxx"
+
+#include <stdlib.h>
+#include <new>
+#include <thread>
+
+namespace
+{
+  thread_local long threadAllocationCount = 0;
+}
+
+long getThreadAllocationCount()
+{
+  return threadAllocationCount;
+}
+
+void *CountingAllocator::allocate(size_t size, size_t alignment)
+{
+  threadAllocationCount++;
+  return bg::defaultAllocator().allocate(size, alignment);
+}
+
+void CountingAllocator::deallocate(void *pointer, size_t size, size_t alignment)
+{
+  bg::defaultAllocator().deallocate(pointer, size, alignment);
+}
+
+CountingAllocator &countingAllocator()
+{
+  static CountingAllocator allocator;
+  return allocator;
+}
+
+void reportAllocations(benchmark::State &state, long before)
+{
+  state.counters["allocs/op"] = benchmark::Counter(
+      static_cast<double>(getThreadAllocationCount() - before),
+      benchmark::Counter::kAvgIterations);
+}
+
+void threadCounts(benchmark::internal::Benchmark *b)
+{
+#ifdef BG_MEMORY_MULTITHREAD
+  const int maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+  b->ThreadRange(1, maxThreads > 1 ? maxThreads : 2);
+#else
+  b->Threads(1);
+#endif // BG_MEMORY_MULTITHREAD
+}
+
+void *operator new(size_t size)
+{
+  threadAllocationCount++;
+  void *pointer = malloc(size == 0 ? 1 : size);
+  if (pointer == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void operator delete(void *pointer) noexcept
+{
+  free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+  free(pointer);
+}
@@ -0,0 +1,50 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BENCHMARK_BENCHMARKHELPERS_HXX_
+#define BENCHMARK_BENCHMARKHELPERS_HXX_
+
+#include "bgmemory/allocators/Allocator.hxx"
+
+#include <benchmark/benchmark.h>
+#include <stddef.h>
+
+/*
+  Gets the number of allocations made so far by the calling thread, through
+  either the global operator new (replaced by the benchmark binary) or a
+  CountingAllocator.
+*/
+long getThreadAllocationCount();
+
+/*
+  Allocator forwarding to the default allocator, counting every allocation
+  towards getThreadAllocationCount. Lets allocations made through
+  bg::Allocator, which bypass operator new, show up in the reports.
+*/
+class CountingAllocator : public bg::Allocator
+{
+public:
+  void *allocate(size_t size, size_t alignment) override;
+  void deallocate(void *pointer, size_t size, size_t alignment) override;
+};
+
+/*
+  Gets the counting allocator shared by all benchmarks.
+*/
+CountingAllocator &countingAllocator();
+
+/*
+  Records allocations per iteration as the "allocs/op" counter. Counts are
+  kept per thread and summed, so this works in threaded benchmarks too.
+
+  @param state the running benchmark's state, after its loop has finished.
+  @param before the thread's allocation count taken just before the loop.
+*/
+void reportAllocations(benchmark::State &state, long before);
+
+/*
+  Applies the thread counts a pointer benchmark runs with: a range of thread
+  counts when built with BG_MEMORY_MULTITHREAD, a single thread otherwise
+  since plain counts may not be shared between threads.
+*/
+void threadCounts(benchmark::internal::Benchmark *b);
+
+#endif // BENCHMARK_BENCHMARKHELPERS_HXX_
@@ -0,0 +1,86 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/Allocator.hxx"
+#include "bgmemory/allocators/SmallObjectHeap.hxx"
+#include "bgmemory/pointers/MutableSharedPtr.hxx"
+
+#include <benchmark/benchmark.h>
+#include <stdlib.h>
+
+// Allocation of a burst of mixed size small objects, freed again in the same
+// order, through the small object heap and through the system heap.
+
+namespace
+{
+  const int burst = 64;
+  const size_t sizes[] = {8, 24, 40, 72, 136, 264, 520, 1000};
+
+  size_t sizeAt(int i)
+  {
+    return sizes[i % (sizeof(sizes) / sizeof(sizes[0]))];
+  }
+
+  struct Payload
+  {
+    long values[4];
+  };
+} // namespace
+
+static void BM_SmallObjectHeap_MixedSizes(benchmark::State &state)
+{
+  bg::SmallObjectHeap heap;
+  void *held[burst];
+  for (auto _ : state)
+  {
+    for (int i = 0; i < burst; i++)
+    {
+      held[i] = heap.allocate(sizeAt(i), 8);
+      benchmark::DoNotOptimize(held[i]);
+    }
+    for (int i = 0; i < burst; i++)
+    {
+      heap.deallocate(held[i], sizeAt(i), 8);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * burst);
+}
+BENCHMARK(BM_SmallObjectHeap_MixedSizes);
+
+static void BM_Malloc_MixedSizes(benchmark::State &state)
+{
+  void *held[burst];
+  for (auto _ : state)
+  {
+    for (int i = 0; i < burst; i++)
+    {
+      held[i] = malloc(sizeAt(i));
+      benchmark::DoNotOptimize(held[i]);
+    }
+    for (auto pointer : held)
+    {
+      free(pointer);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * burst);
+}
+BENCHMARK(BM_Malloc_MixedSizes);
+
+static void BM_SmallObjectHeap_AllocateMutableShared(benchmark::State &state)
+{
+  bg::SmallObjectHeap heap;
+  for (auto _ : state)
+  {
+    auto pointer = bg::allocateMutableShared<Payload>(heap);
+    benchmark::DoNotOptimize(pointer);
+  }
+}
+BENCHMARK(BM_SmallObjectHeap_AllocateMutableShared);
+
+static void BM_DefaultAllocator_AllocateMutableShared(benchmark::State &state)
+{
+  for (auto _ : state)
+  {
+    auto pointer = bg::allocateMutableShared<Payload>(bg::defaultAllocator());
+    benchmark::DoNotOptimize(pointer);
+  }
+}
+BENCHMARK(BM_DefaultAllocator_AllocateMutableShared);
@@ -0,0 +1,455 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pointers/MutableSharedPtr.hxx"
+#include "bgmemory/pointers/MutableWeakPtr.hxx"
+#include "bgmemory/pointers/SharedPtrMutator.hxx"
+#include "bgmemory/pointers/IntrusiveMutablePtr.hxx"
+#include "bgmemory/reclamation/DeferredDestruction.hxx"
+#include "../BenchmarkHelpers.hxx"
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Everyday pointer operations, each bg benchmark followed by its standard
+// library counterpart. Every benchmark reports allocs/op. Pointers here are
+// thread local, so in the multithreaded build the thread counts show the cost
+// of the atomic counts without contention; see ReferenceCountContention.cxx
+// for the contended case.
+
+namespace
+{
+  struct Payload
+  {
+    int value = 1;
+
+    int read() const
+    {
+      return value;
+    }
+  };
+
+  struct IntrusivePayload : bg::IntrusiveMutable<IntrusivePayload>
+  {
+    int value = 1;
+
+    int read() const
+    {
+      return value;
+    }
+  };
+
+  const int destroyBatch = 256;
+
+  // Enough separately allocated objects to fall out of cache when traversed.
+  const int traverseCount = 1 << 16;
+
+  // Shuffles pointers so traversal order does not match allocation order.
+  template <class P>
+  void shuffle(std::vector<P> &pointers)
+  {
+    std::mt19937 random(1234);
+    std::shuffle(pointers.begin(), pointers.end(), random);
+  }
+} // namespace
+
+//---------------------
+//  Construction
+//---------------------
+
+static void BM_MutableShared_ConstructFromPointer(benchmark::State &state)
+{
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    bg::MutableSharedPtr<Payload> p(new Payload());
+    benchmark::DoNotOptimize(p.get());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_MutableShared_ConstructFromPointer)->Apply(threadCounts);
+
+static void BM_StdShared_ConstructFromPointer(benchmark::State &state)
+{
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    std::shared_ptr<Payload> p(new Payload());
+    benchmark::DoNotOptimize(p.get());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_StdShared_ConstructFromPointer)->Apply(threadCounts);
+
+static void BM_MutableShared_Make(benchmark::State &state)
+{
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    auto p = bg::allocateMutableShared<Payload>(countingAllocator());
+    benchmark::DoNotOptimize(p.get());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_MutableShared_Make)->Apply(threadCounts);
+
+static void BM_StdShared_Make(benchmark::State &state)
+{
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    auto p = std::make_shared<Payload>();
+    benchmark::DoNotOptimize(p.get());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_StdShared_Make)->Apply(threadCounts);
+
+//---------------------
+//  Copy
+//---------------------
+
+static void BM_MutableShared_Copy(benchmark::State &state)
+{
+  auto source = bg::makeMutableShared<Payload>();
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    bg::MutableSharedPtr<Payload> copy(source);
+    benchmark::DoNotOptimize(copy.get());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_MutableShared_Copy)->Apply(threadCounts);
+
+static void BM_StdShared_Copy(benchmark::State &state)
+{
+  auto source = std::make_shared<Payload>();
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    std::shared_ptr<Payload> copy(source);
+    benchmark::DoNotOptimize(copy.get());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_StdShared_Copy)->Apply(threadCounts);
+
+static void BM_MutableWeak_CopyFromShared(benchmark::State &state)
+{
+  auto source = bg::makeMutableShared<Payload>();
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    bg::MutableWeakPtr<Payload> weak(source);
+    benchmark::DoNotOptimize(&weak);
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_MutableWeak_CopyFromShared)->Apply(threadCounts);
+
+static void BM_StdWeak_CopyFromShared(benchmark::State &state)
+{
+  auto source = std::make_shared<Payload>();
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    std::weak_ptr<Payload> weak(source);
+    benchmark::DoNotOptimize(&weak);
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_StdWeak_CopyFromShared)->Apply(threadCounts);
+
+//---------------------
+//  Destruction
+//---------------------
+
+// Time only the release of the last reference, which frees object and metadata.
+template <class Pointer, class Make>
+void destroyLastReferences(benchmark::State &state, Make make)
+{
+  std::vector<Pointer> pointers;
+  pointers.reserve(destroyBatch);
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    for (int i = 0; i < destroyBatch; i++)
+    {
+      pointers.push_back(make());
+    }
+    state.ResumeTiming();
+    pointers.clear();
+  }
+  state.SetItemsProcessed(state.iterations() * destroyBatch);
+}
+
+static void BM_MutableShared_DestroyLast(benchmark::State &state)
+{
+  destroyLastReferences<bg::MutableSharedPtr<Payload>>(
+      state, []() { return bg::makeMutableShared<Payload>(); });
+}
+BENCHMARK(BM_MutableShared_DestroyLast)->Apply(threadCounts);
+
+static void BM_StdShared_DestroyLast(benchmark::State &state)
+{
+  destroyLastReferences<std::shared_ptr<Payload>>(
+      state, []() { return std::make_shared<Payload>(); });
+}
+BENCHMARK(BM_StdShared_DestroyLast)->Apply(threadCounts);
+
+// Dropping the last reference inside a DeferredDestructionScope, the cost left
+// on the releasing thread. The queued objects are collected outside timing.
+static void BM_MutableShared_DestroyLastDeferred(benchmark::State &state)
+{
+  std::vector<bg::MutableSharedPtr<Payload>> pointers;
+  pointers.reserve(destroyBatch);
+  bg::DeferredDestructionScope scope;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    bg::collect();
+    for (int i = 0; i < destroyBatch; i++)
+    {
+      pointers.emplace_back(new Payload());
+    }
+    state.ResumeTiming();
+    pointers.clear();
+  }
+  bg::collect();
+  state.SetItemsProcessed(state.iterations() * destroyBatch);
+}
+BENCHMARK(BM_MutableShared_DestroyLastDeferred)->Apply(threadCounts);
+
+static void BM_MutableShared_DestroyLastFromPointer(benchmark::State &state)
+{
+  destroyLastReferences<bg::MutableSharedPtr<Payload>>(
+      state, []() { return bg::MutableSharedPtr<Payload>(new Payload()); });
+}
+BENCHMARK(BM_MutableShared_DestroyLastFromPointer)->Apply(threadCounts);
+
+//---------------------
+//  Lock
+//---------------------
+
+static void BM_MutableWeak_Lock(benchmark::State &state)
+{
+  auto source = bg::makeMutableShared<Payload>();
+  bg::MutableWeakPtr<Payload> weak(source);
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    auto locked = weak.lock();
+    benchmark::DoNotOptimize(locked.get());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_MutableWeak_Lock)->Apply(threadCounts);
+
+static void BM_StdWeak_Lock(benchmark::State &state)
+{
+  auto source = std::make_shared<Payload>();
+  std::weak_ptr<Payload> weak(source);
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    auto locked = weak.lock();
+    benchmark::DoNotOptimize(locked.get());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_StdWeak_Lock)->Apply(threadCounts);
+
+static void BM_MutableWeak_LockExpired(benchmark::State &state)
+{
+  bg::MutableWeakPtr<Payload> weak(bg::makeMutableShared<Payload>());
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    auto locked = weak.lock();
+    benchmark::DoNotOptimize(locked.get());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_MutableWeak_LockExpired)->Apply(threadCounts);
+
+static void BM_StdWeak_LockExpired(benchmark::State &state)
+{
+  std::weak_ptr<Payload> weak(std::make_shared<Payload>());
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    auto locked = weak.lock();
+    benchmark::DoNotOptimize(locked.get());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_StdWeak_LockExpired)->Apply(threadCounts);
+
+//---------------------
+//  Mutate
+//---------------------
+
+// Swaps the object seen by every pointer sharing it.
+static void BM_Mutator_Mutate(benchmark::State &state)
+{
+  auto shared = bg::makeMutableShared<Payload>();
+  bg::SharedPtrMutator<Payload> mutator(shared);
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    mutator.mutate(new Payload());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_Mutator_Mutate)->Apply(threadCounts);
+
+// The standard library way to retarget every copy: share a box holding the
+// object and replace the box's content.
+static void BM_StdBoxed_Reset(benchmark::State &state)
+{
+  auto shared = std::make_shared<std::unique_ptr<Payload>>(new Payload());
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    shared->reset(new Payload());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_StdBoxed_Reset)->Apply(threadCounts);
+
+//---------------------
+//  Dereference
+//---------------------
+
+static void BM_MutableShared_Dereference(benchmark::State &state)
+{
+  auto p = bg::makeMutableShared<Payload>();
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize((*p).value);
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_MutableShared_Dereference)->Apply(threadCounts);
+
+static void BM_StdShared_Dereference(benchmark::State &state)
+{
+  auto p = std::make_shared<Payload>();
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize((*p).value);
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_StdShared_Dereference)->Apply(threadCounts);
+
+// In the multithreaded build operator-> enters an epoch guard.
+static void BM_MutableShared_Arrow(benchmark::State &state)
+{
+  auto p = bg::makeMutableShared<Payload>();
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(p->read());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_MutableShared_Arrow)->Apply(threadCounts);
+
+static void BM_StdShared_Arrow(benchmark::State &state)
+{
+  auto p = std::make_shared<Payload>();
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(p->read());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_StdShared_Arrow)->Apply(threadCounts);
+
+static void BM_IntrusiveMutable_Arrow(benchmark::State &state)
+{
+  auto p = bg::makeIntrusiveMutable<IntrusivePayload>();
+  const long before = getThreadAllocationCount();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(p->read());
+  }
+  reportAllocations(state, before);
+}
+BENCHMARK(BM_IntrusiveMutable_Arrow)->Apply(threadCounts);
+
+//---------------------
+//  Traverse
+//---------------------
+
+// Reads through many pointers in shuffled order, where each indirection is
+// likely a cache miss: payload then object for MutableSharedPtr, the object
+// alone for the intrusive and standard pointers.
+static void BM_MutableShared_Traverse(benchmark::State &state)
+{
+  std::vector<bg::MutableSharedPtr<Payload>> pointers;
+  for (int i = 0; i < traverseCount; i++)
+  {
+    pointers.emplace_back(new Payload());
+  }
+  shuffle(pointers);
+  for (auto _ : state)
+  {
+    long sum = 0;
+    for (auto &p : pointers)
+    {
+      sum += (*p).value;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * traverseCount);
+}
+BENCHMARK(BM_MutableShared_Traverse);
+
+static void BM_IntrusiveMutable_Traverse(benchmark::State &state)
+{
+  std::vector<bg::IntrusiveMutablePtr<IntrusivePayload>> pointers;
+  for (int i = 0; i < traverseCount; i++)
+  {
+    pointers.emplace_back(new IntrusivePayload());
+  }
+  shuffle(pointers);
+  for (auto _ : state)
+  {
+    long sum = 0;
+    for (auto &p : pointers)
+    {
+      sum += (*p).value;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * traverseCount);
+}
+BENCHMARK(BM_IntrusiveMutable_Traverse);
+
+static void BM_StdShared_Traverse(benchmark::State &state)
+{
+  std::vector<std::shared_ptr<Payload>> pointers;
+  for (int i = 0; i < traverseCount; i++)
+  {
+    pointers.emplace_back(new Payload());
+  }
+  shuffle(pointers);
+  for (auto _ : state)
+  {
+    long sum = 0;
+    for (auto &p : pointers)
+    {
+      sum += (*p).value;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * traverseCount);
+}
+BENCHMARK(BM_StdShared_Traverse);
@@ -0,0 +1,72 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pointers/MutableSharedPtr.hxx"
+#include "bgmemory/pointers/MutableWeakPtr.hxx"
+#include "../BenchmarkHelpers.hxx"
+
+#include <benchmark/benchmark.h>
+#include <memory>
+
+// Reference count cost, built once per mode. Compare the single threaded
+// "benchmarks" run against "benchmarks_multithread" to see the price of the
+// atomic counts, and the multithreaded runs across thread counts to see the
+// price of contention on a single shared count.
+
+namespace
+{
+  bg::MutableSharedPtr<int> sharedSource = bg::makeMutableShared<int>(1);
+  bg::MutableWeakPtr<int> weakSource = sharedSource;
+
+  std::shared_ptr<int> stdSharedSource = std::make_shared<int>(1);
+  std::weak_ptr<int> stdWeakSource = stdSharedSource;
+} // namespace
+
+static void BM_ContendedSharedCopy(benchmark::State &state)
+{
+  for (auto _ : state)
+  {
+    bg::MutableSharedPtr<int> copy(sharedSource);
+    benchmark::DoNotOptimize(copy.get());
+  }
+}
+BENCHMARK(BM_ContendedSharedCopy)->Apply(threadCounts)->UseRealTime();
+
+static void BM_StdContendedSharedCopy(benchmark::State &state)
+{
+  for (auto _ : state)
+  {
+    std::shared_ptr<int> copy(stdSharedSource);
+    benchmark::DoNotOptimize(copy.get());
+  }
+}
+BENCHMARK(BM_StdContendedSharedCopy)->Apply(threadCounts)->UseRealTime();
+
+static void BM_ContendedWeakLock(benchmark::State &state)
+{
+  for (auto _ : state)
+  {
+    auto locked = weakSource.lock();
+    benchmark::DoNotOptimize(locked.get());
+  }
+}
+BENCHMARK(BM_ContendedWeakLock)->Apply(threadCounts)->UseRealTime();
+
+static void BM_StdContendedWeakLock(benchmark::State &state)
+{
+  for (auto _ : state)
+  {
+    auto locked = stdWeakSource.lock();
+    benchmark::DoNotOptimize(locked.get());
+  }
+}
+BENCHMARK(BM_StdContendedWeakLock)->Apply(threadCounts)->UseRealTime();
+
+static void BM_UncontendedSharedCopy(benchmark::State &state)
+{
+  auto local = bg::makeMutableShared<int>(1);
+  for (auto _ : state)
+  {
+    bg::MutableSharedPtr<int> copy(local);
+    benchmark::DoNotOptimize(copy.get());
+  }
+}
+BENCHMARK(BM_UncontendedSharedCopy)->Apply(threadCounts)->UseRealTime();
@@ -0,0 +1,76 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/bulletpool.hxx"
+#include "bgmemory/pools/ConcurrentBulletPool.hxx"
+
+#include <benchmark/benchmark.h>
+#include <mutex>
+#include <thread>
+
+// Scaling of pool acquire/release from 1 to N threads. Each iteration every
+// thread acquires a burst of objects and releases them again. The concurrent
+// pool should scale with the thread count, a mutex guarded BulletPool is the
+// baseline it should beat.
+
+namespace
+{
+  const int burst = 16;
+  const uint32_t capacity = 1 << 16;
+
+  struct Particle
+  {
+    float position[3];
+    float velocity[3];
+  };
+
+  bg::ConcurrentBulletPool<Particle> concurrentPool(capacity);
+
+  std::mutex lockedPoolMutex;
+  bg::BulletPool<Particle> lockedPool(capacity);
+
+  void scalingThreads(benchmark::internal::Benchmark *b)
+  {
+    const int maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+    b->ThreadRange(1, maxThreads > 1 ? maxThreads : 2)->UseRealTime();
+  }
+} // namespace
+
+static void BM_ConcurrentBulletPool_AcquireRelease(benchmark::State &state)
+{
+  bg::ConcurrentBulletPool<Particle>::Cache cache(concurrentPool);
+  Particle *held[burst];
+  for (auto _ : state)
+  {
+    for (auto &particle : held)
+    {
+      particle = cache.acquire();
+      benchmark::DoNotOptimize(particle);
+    }
+    for (auto particle : held)
+    {
+      cache.release(particle);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * burst);
+}
+BENCHMARK(BM_ConcurrentBulletPool_AcquireRelease)->Apply(scalingThreads);
+
+static void BM_LockedBulletPool_AcquireRelease(benchmark::State &state)
+{
+  Particle *held[burst];
+  for (auto _ : state)
+  {
+    for (auto &particle : held)
+    {
+      std::lock_guard<std::mutex> lock(lockedPoolMutex);
+      particle = lockedPool.acquire();
+      benchmark::DoNotOptimize(particle);
+    }
+    for (auto particle : held)
+    {
+      std::lock_guard<std::mutex> lock(lockedPoolMutex);
+      lockedPool.release(particle);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * burst);
+}
+BENCHMARK(BM_LockedBulletPool_AcquireRelease)->Apply(scalingThreads);
@@ -0,0 +1,99 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pools/SlotMap.hxx"
+#include "bgmemory/pointers/MutableSharedPtr.hxx"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+// Entity table access through a SlotMap against a vector of MutableSharedPtr.
+// Iterating the map is a linear scan over dense values, where every pointer
+// dereference goes through its payload first. Lookups compare a handle
+// resolved through the slot array with a plain pointer dereference.
+
+namespace
+{
+  struct Entity
+  {
+    float position[3];
+    float velocity[3];
+  };
+
+  const uint32_t entityCount = 4096;
+} // namespace
+
+static void BM_SlotMap_Iterate(benchmark::State &state)
+{
+  bg::SlotMap<Entity> map(entityCount);
+  for (uint32_t i = 0; i < entityCount; i++)
+  {
+    map.insert(Entity{{0, 0, 0}, {1, 1, 1}});
+  }
+
+  for (auto _ : state)
+  {
+    for (auto &entity : map)
+    {
+      entity.position[0] += entity.velocity[0];
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * entityCount);
+}
+BENCHMARK(BM_SlotMap_Iterate);
+
+static void BM_MutableSharedPtr_Iterate(benchmark::State &state)
+{
+  std::vector<bg::MutableSharedPtr<Entity>> entities;
+  for (uint32_t i = 0; i < entityCount; i++)
+  {
+    entities.push_back(bg::makeMutableShared<Entity>(Entity{{0, 0, 0}, {1, 1, 1}}));
+  }
+
+  for (auto _ : state)
+  {
+    for (auto &entity : entities)
+    {
+      entity->position[0] += entity->velocity[0];
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * entityCount);
+}
+BENCHMARK(BM_MutableSharedPtr_Iterate);
+
+static void BM_SlotMap_Lookup(benchmark::State &state)
+{
+  bg::SlotMap<Entity> map(entityCount);
+  std::vector<bg::SlotMapHandle> handles;
+  for (uint32_t i = 0; i < entityCount; i++)
+  {
+    handles.push_back(map.insert(Entity{{0, 0, 0}, {1, 1, 1}}));
+  }
+
+  for (auto _ : state)
+  {
+    for (auto handle : handles)
+    {
+      benchmark::DoNotOptimize(map.get(handle)->position[0]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * entityCount);
+}
+BENCHMARK(BM_SlotMap_Lookup);
+
+static void BM_SlotMap_InsertErase(benchmark::State &state)
+{
+  bg::SlotMap<Entity> map(entityCount);
+  for (uint32_t i = 0; i < entityCount / 2; i++)
+  {
+    map.insert(Entity{{0, 0, 0}, {1, 1, 1}});
+  }
+
+  for (auto _ : state)
+  {
+    auto handle = map.insert(Entity{{0, 0, 0}, {1, 1, 1}});
+    map.erase(map.handleAt(0));
+    benchmark::DoNotOptimize(handle);
+  }
+}
+BENCHMARK(BM_SlotMap_InsertErase);
@@ -0,0 +1,67 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pools/SlotMap.hxx"
+#include "bgmemory/pools/SoAPool.hxx"
+
+#include <benchmark/benchmark.h>
+
+// Position update over particles stored as separate field arrays in an
+// SoAPool against whole structs in a SlotMap. The SoAPool kernel reads two
+// dense float arrays and vectorises; the SlotMap kernel strides over every
+// field of each struct, including ones the update never uses.
+
+namespace
+{
+  struct Particle
+  {
+    float position;
+    float velocity;
+    float colour[4];
+    double age;
+  };
+
+  const uint32_t particleCount = 16384;
+} // namespace
+
+static void BM_SoAPool_UpdatePositions(benchmark::State &state)
+{
+  bg::SoAPool<float, float, double> pool(particleCount);
+  for (uint32_t i = 0; i < particleCount; i++)
+  {
+    pool.insert(0.0f, 1.0f, 0.0);
+  }
+
+  for (auto _ : state)
+  {
+    auto positions = pool.field<0>();
+    auto velocities = pool.field<1>();
+    float *position = positions.data();
+    const float *velocity = velocities.data();
+    for (uint32_t i = 0; i < positions.size(); i++)
+    {
+      position[i] += velocity[i] * 0.016f;
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * particleCount);
+}
+BENCHMARK(BM_SoAPool_UpdatePositions);
+
+static void BM_SlotMap_UpdatePositions(benchmark::State &state)
+{
+  bg::SlotMap<Particle> map(particleCount);
+  for (uint32_t i = 0; i < particleCount; i++)
+  {
+    map.insert(Particle{0.0f, 1.0f, {1, 1, 1, 1}, 0.0});
+  }
+
+  for (auto _ : state)
+  {
+    for (auto &particle : map)
+    {
+      particle.position += particle.velocity * 0.016f;
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * particleCount);
+}
+BENCHMARK(BM_SlotMap_UpdatePositions);
@@ -31,6 +31,31 @@ namespace bg
     }
   };
 
+  /*
+    Default Deletion function object for arrays allocated with
+    new[]. Array deleters take a pointer to the first element, so
+    this is a Deleter of the element type.
+*/
+  template <class T>
+  class DefaultDeleter<T[]> : public Deleter<T>
+  {
+  public:
+    constexpr DefaultDeleter() noexcept {}
+    /*
+      Object function operator for deleting the array. Simply a
+      standard delete[] call to the pointer.
+
+      @param pointer Pointer to the first element of the array.
+  */
+    void operator()(T *pointer)
+    {
+      if (pointer != nullptr)
+      {
+        delete[] pointer;
+      }
+    }
+  };
+
 } // namespace bg
 
 #endif // BGMEMORY_INCLUDE_BGMEMORY_DEFAULTDELETER_HXX_
@@ -0,0 +1,61 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_ALLOCATOR_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_ALLOCATOR_HXX_
+
+#include <stddef.h>
+
+namespace bg
+{
+    /*
+        Allocator interface used by the pools and pointers in this library to
+        obtain raw memory. Implement this to have the library draw from
+        caller supplied memory instead of the global heap.
+
+        Implementations return nullptr when a request cannot be satisfied
+        rather than throwing.
+    */
+    class Allocator
+    {
+    public:
+        virtual ~Allocator() = default;
+
+        /*
+            Allocates a block of memory.
+
+            @param sizeInBytes size of the block to allocate.
+            @param alignment power of two alignment of the block.
+            @return pointer to the block, or nullptr on failure.
+        */
+        virtual void *allocate(size_t sizeInBytes, size_t alignment) = 0;
+
+        /*
+            Releases a block previously returned by allocate on this allocator.
+            The size and alignment must match the original request.
+
+            @param pointer the block to release.
+            @param sizeInBytes size the block was allocated with.
+            @param alignment alignment the block was allocated with.
+        */
+        virtual void deallocate(void *pointer, size_t sizeInBytes, size_t alignment) = 0;
+    };
+
+    /*
+        Allocator backed by allocateAlligned/freeAlligned on the system heap.
+    */
+    class AlignedHeapAllocator : public Allocator
+    {
+    public:
+        void *allocate(size_t sizeInBytes, size_t alignment) override;
+        void deallocate(void *pointer, size_t sizeInBytes, size_t alignment) override;
+    };
+
+    /*
+        Gets the allocator used when none is supplied, a process wide
+        AlignedHeapAllocator.
+
+        @return reference to the default allocator.
+    */
+    Allocator &defaultAllocator() noexcept;
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_ALLOCATOR_HXX_
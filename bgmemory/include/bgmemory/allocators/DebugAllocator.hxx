@@ -0,0 +1,122 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_DEBUGALLOCATOR_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_DEBUGALLOCATOR_HXX_
+
+#include <stddef.h>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+#include "bgmemory/allocators/Allocator.hxx"
+#include "bgmemory/debug/MemoryDebug.hxx"
+
+namespace bg
+{
+    /*
+        Allocator which forwards to another allocator and checks how its
+        memory is used, for tracking down corruption in debug builds.
+
+        Each block is surrounded by guard bands, which are checked when the
+        block is freed. New blocks are filled with allocatedFill. Freed blocks
+        are filled with freedFill and held back in a quarantine for a while
+        before going back to the backing allocator, so writes through stale
+        pointers show up when they leave it. Frees of blocks which are not
+        live are reported as double or invalid frees.
+
+        Every live block remembers where it was allocated: the innermost
+        BG_MEMORY_ALLOCATION_SITE in scope, or else the return address of the
+        allocate call. Blocks still live when the allocator is destroyed are
+        reported as leaks and left allocated.
+
+        Problems are reported through reportMemoryError. The allocator is
+        thread safe, and slow; it is meant to stand in for the usual allocator
+        of a pool, arena or container while debugging.
+    */
+    class DebugAllocator : public Allocator
+    {
+        struct Block
+        {
+            size_t size;
+            size_t alignment;
+            const char *file;
+            int line;
+            void *returnAddress;
+        };
+
+        struct QuarantinedBlock
+        {
+            unsigned char *user;
+            size_t size;
+            size_t alignment;
+        };
+
+        Allocator *backing;
+        size_t quarantineLimit;
+        mutable std::mutex mutex;
+        std::unordered_map<const void *, Block> live;
+        std::deque<QuarantinedBlock> quarantine;
+
+        // Errors are reported once the mutex is released, so a handler may
+        // call back into the allocator.
+        static bool guardsIntact(const void *pointer, const Block &block) noexcept;
+        static void reportCorruptGuards(const void *pointer, const Block &block);
+        void releaseQuarantined(const QuarantinedBlock &block);
+
+    public:
+        // Size of the guard band after each block, and least size before it.
+        static constexpr size_t guardSize = 16;
+
+        /*
+            Constructs a debug allocator.
+
+            @param a allocator providing the memory, must outlive this one.
+            @param quarantineBlocks number of freed blocks held back before
+            being returned to the backing allocator.
+        */
+        explicit DebugAllocator(Allocator &a = defaultAllocator(), size_t quarantineBlocks = 64);
+
+        DebugAllocator(const DebugAllocator &) = delete;
+        DebugAllocator &operator=(const DebugAllocator &) = delete;
+
+        /*
+            Destructor, reports every block still live as a leak and returns
+            the quarantined blocks.
+        */
+        ~DebugAllocator() override;
+
+        void *allocate(size_t sizeInBytes, size_t alignment) override;
+        void deallocate(void *pointer, size_t sizeInBytes, size_t alignment) override;
+
+        /*
+            Checks the guard bands of every live block, reporting each
+            corrupted one.
+
+            @return the number of corrupted blocks.
+        */
+        size_t checkGuards() const;
+
+        /*
+            Writes every live block, with its size and allocation site.
+
+            @param out stream to write to.
+            @return the number of live blocks.
+        */
+        size_t reportLeaks(std::ostream &out) const;
+
+        /*
+            Gets the number of blocks allocated and not yet freed.
+
+            @return count of live blocks.
+        */
+        size_t liveCount() const;
+
+        /*
+            Returns every quarantined block to the backing allocator, checking
+            that none of them was written to.
+        */
+        void flushQuarantine();
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_DEBUGALLOCATOR_HXX_
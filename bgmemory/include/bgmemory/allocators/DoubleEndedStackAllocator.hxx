@@ -0,0 +1,183 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_DOUBLEENDEDSTACKALLOCATOR_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_DOUBLEENDEDSTACKALLOCATOR_HXX_
+
+#include <stddef.h>
+
+#include "bgmemory/allocators/Allocator.hxx"
+#include "bgmemory/allocators/inner/BumpBlock.hxx"
+#include "bgmemory/debug/MemoryDebug.hxx"
+
+namespace bg
+{
+    /*
+        Two stacks sharing one block, one growing up from the bottom and one
+        growing down from the top, so persistent data (say, a level) and
+        transient data (say, loading scratch) can share a fixed budget without
+        fixing the split between them up front. The allocator is only out of
+        room once the two ends meet.
+
+        Each end behaves like a StackAllocator: allocations carry no header,
+        deallocation must be in reverse order of allocation, and markers roll
+        an end back in one go. Each end is an Allocator in its own right.
+
+        With BG_MEMORY_DEBUG, memory is filled the same way as in
+        StackAllocator and deallocating a popped block is reported as a double
+        free.
+
+        The allocator is not thread safe.
+    */
+    class DoubleEndedStackAllocator
+    {
+    public:
+        // Position in one end of the stack which can be rolled back to.
+        using Marker = size_t;
+
+        /*
+            One end of a double ended stack.
+        */
+        class End : public Allocator
+        {
+            friend class DoubleEndedStackAllocator;
+
+            DoubleEndedStackAllocator *owner;
+            bool growsDown;
+
+            End(DoubleEndedStackAllocator *o, bool down) noexcept : owner(o), growsDown(down) {}
+
+        public:
+            End(const End &) = delete;
+            End &operator=(const End &) = delete;
+
+            /*
+                Pushes an allocation onto this end.
+
+                @param sizeInBytes size of the allocation.
+                @param alignment power of two alignment of the allocation.
+                @return pointer to the memory, or nullptr if the ends would cross.
+            */
+            void *allocate(size_t sizeInBytes, size_t alignment) override;
+
+            /*
+                Pops an allocation off this end, along with anything allocated
+                on this end after it. Deallocating nullptr does nothing.
+
+                @param pointer the allocation to pop.
+                @param sizeInBytes size the allocation was made with.
+                @param alignment alignment the allocation was made with.
+            */
+            void deallocate(void *pointer, size_t sizeInBytes, size_t alignment) override;
+
+            /*
+                Gets a marker for the current top of this end.
+
+                @return marker to pass to rollback.
+            */
+            Marker getMarker() const noexcept;
+
+            /*
+                Pops everything allocated on this end since the marker was taken.
+
+                @param marker marker taken from this end, still within its used part.
+            */
+            void rollback(Marker marker) noexcept;
+
+            /*
+                Pops everything off this end.
+            */
+            void reset() noexcept;
+
+            /*
+                Gets the number of bytes this end uses, including alignment padding.
+
+                @return bytes in use.
+            */
+            size_t used() const noexcept;
+        };
+
+    private:
+        inner::BumpBlock block;
+        // Offsets from the start of the block; the free space lies between them.
+        size_t lowerTop = 0;
+        size_t upperTop = 0;
+        End lowerEnd;
+        End upperEnd;
+
+    public:
+        /*
+            Constructs a double ended stack reserving the given number of bytes.
+
+            @param capacityInBytes size shared by both ends.
+            @param a allocator providing the block, must outlive the stack.
+            @throws std::bad_alloc if the block cannot be allocated.
+        */
+        explicit DoubleEndedStackAllocator(size_t capacityInBytes, Allocator &a = defaultAllocator());
+
+        DoubleEndedStackAllocator(const DoubleEndedStackAllocator &) = delete;
+        DoubleEndedStackAllocator &operator=(const DoubleEndedStackAllocator &) = delete;
+
+        /*
+            Gets the end growing up from the start of the block, usually used
+            for persistent data.
+
+            @return the lower end.
+        */
+        End &lower() noexcept
+        {
+            return lowerEnd;
+        }
+
+        /*
+            Gets the end growing down from the end of the block, usually used
+            for transient data.
+
+            @return the upper end.
+        */
+        End &upper() noexcept
+        {
+            return upperEnd;
+        }
+
+        /*
+            Pops everything off both ends.
+        */
+        void reset() noexcept
+        {
+            lowerEnd.reset();
+            upperEnd.reset();
+        }
+
+        /*
+            Checks whether the given pointer lies inside the stack's block.
+
+            @param pointer the pointer to check.
+            @return whether the pointer belongs to the stack.
+        */
+        bool owns(const void *pointer) const noexcept
+        {
+            return block.owns(pointer);
+        }
+
+        /*
+            Gets the size shared by both ends.
+
+            @return capacity in bytes.
+        */
+        size_t capacity() const noexcept
+        {
+            return block.size();
+        }
+
+        /*
+            Gets the number of bytes left between the two ends.
+
+            @return bytes remaining.
+        */
+        size_t remaining() const noexcept
+        {
+            return upperTop - lowerTop;
+        }
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_DOUBLEENDEDSTACKALLOCATOR_HXX_
@@ -0,0 +1,236 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_LINEARARENA_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_LINEARARENA_HXX_
+
+#include <stddef.h>
+
+#include "bgmemory/allocators/Allocator.hxx"
+#include "bgmemory/allocators/inner/BumpBlock.hxx"
+#include "bgmemory/debug/MemoryDebug.hxx"
+
+namespace bg
+{
+    /*
+        Bump pointer arena for scratch memory, such as per frame working data.
+
+        The arena reserves one cache line aligned block up front and hands out
+        memory by advancing an offset, so allocating is a couple of additions
+        and there is no per allocation bookkeeping. Individual deallocation is a
+        no-op; memory comes back all at once through reset, or back to an
+        earlier point through a marker.
+
+        Objects placed in the arena are not destroyed by reset or rollback, so
+        it is best suited to trivially destructible data and to containers
+        which are cleared before the arena is.
+
+        As an Allocator, the arena can back standard containers through
+        StdAllocator. The arena is not thread safe.
+
+        With BG_MEMORY_DEBUG, new allocations are filled with allocatedFill and
+        memory given back by reset or rollback with freedFill.
+    */
+    class LinearArena : public Allocator
+    {
+        inner::BumpBlock block;
+        size_t offset = 0;
+
+    public:
+        // Position in the arena which can be rolled back to.
+        using Marker = size_t;
+
+        /*
+            Constructs an arena reserving the given number of bytes.
+
+            @param capacityInBytes size of the arena.
+            @param a allocator providing the arena's block, must outlive the arena.
+            @throws std::bad_alloc if the block cannot be allocated.
+        */
+        explicit LinearArena(size_t capacityInBytes, Allocator &a = defaultAllocator());
+
+        LinearArena(const LinearArena &) = delete;
+        LinearArena &operator=(const LinearArena &) = delete;
+
+        /*
+            Allocates memory from the arena.
+
+            @param sizeInBytes size of the allocation.
+            @param alignment power of two alignment of the allocation.
+            @return pointer to the memory, or nullptr if the arena is out of room.
+        */
+        void *allocate(size_t sizeInBytes, size_t alignment) override;
+
+        /*
+            Does nothing, arena memory is only reclaimed by reset or rollback.
+        */
+        void deallocate(void *pointer, size_t sizeInBytes, size_t alignment) override;
+
+        /*
+            Gets a marker for the current top of the arena.
+
+            @return marker to pass to rollback.
+        */
+        Marker getMarker() const noexcept
+        {
+            return offset;
+        }
+
+        /*
+            Frees everything allocated since the marker was taken.
+
+            @param marker marker taken from this arena since its last reset.
+        */
+        void rollback(Marker marker) noexcept;
+
+        /*
+            Frees everything in the arena in constant time.
+        */
+        void reset() noexcept
+        {
+            BG_MEMORY_POISON(block.data(), offset, freedFill);
+            offset = 0;
+        }
+
+        /*
+            Checks whether the given pointer lies inside the arena's block.
+
+            @param pointer the pointer to check.
+            @return whether the pointer belongs to the arena.
+        */
+        bool owns(const void *pointer) const noexcept
+        {
+            return block.owns(pointer);
+        }
+
+        /*
+            Gets the start of the arena's block, which markers are offsets from.
+
+            @return cache line aligned start of the arena, or nullptr if it has no capacity.
+        */
+        void *data() const noexcept
+        {
+            return block.data();
+        }
+
+        /*
+            Gets the size of the arena.
+
+            @return capacity in bytes.
+        */
+        size_t capacity() const noexcept
+        {
+            return block.size();
+        }
+
+        /*
+            Gets the number of bytes in use, including alignment padding.
+
+            @return bytes in use.
+        */
+        size_t used() const noexcept
+        {
+            return offset;
+        }
+
+        /*
+            Gets the number of bytes left before the arena is full.
+
+            @return bytes remaining.
+        */
+        size_t remaining() const noexcept
+        {
+            return block.size() - offset;
+        }
+    };
+
+    /*
+        Rolls an arena back to where it was when the scope was entered, freeing
+        every allocation made inside the scope.
+    */
+    class ArenaScope
+    {
+        LinearArena &arena;
+        LinearArena::Marker marker;
+
+    public:
+        /*
+            Enters a scope on the given arena.
+
+            @param a the arena to roll back at the end of the scope.
+        */
+        explicit ArenaScope(LinearArena &a) noexcept : arena(a), marker(a.getMarker()) {}
+
+        ArenaScope(const ArenaScope &) = delete;
+        ArenaScope &operator=(const ArenaScope &) = delete;
+
+        ~ArenaScope()
+        {
+            arena.rollback(marker);
+        }
+    };
+
+    /*
+        Pair of arenas alternating each frame, for data which has to survive
+        exactly one frame: whatever was allocated from the current arena is
+        still readable through the previous arena for the whole next frame,
+        then is freed.
+    */
+    class DoubleBufferedArena
+    {
+        LinearArena first;
+        LinearArena second;
+        LinearArena *currentArena;
+        LinearArena *previousArena;
+
+    public:
+        /*
+            Constructs both arenas.
+
+            @param capacityInBytes size of each of the two arenas.
+            @param a allocator providing the arenas' blocks, must outlive them.
+            @throws std::bad_alloc if the blocks cannot be allocated.
+        */
+        explicit DoubleBufferedArena(size_t capacityInBytes, Allocator &a = defaultAllocator())
+            : first(capacityInBytes, a), second(capacityInBytes, a),
+              currentArena(&first), previousArena(&second)
+        {
+        }
+
+        DoubleBufferedArena(const DoubleBufferedArena &) = delete;
+        DoubleBufferedArena &operator=(const DoubleBufferedArena &) = delete;
+
+        /*
+            Gets the arena for allocations made this frame.
+
+            @return the current arena.
+        */
+        LinearArena &current() noexcept
+        {
+            return *currentArena;
+        }
+
+        /*
+            Gets the arena holding last frame's allocations.
+
+            @return the previous arena.
+        */
+        LinearArena &previous() noexcept
+        {
+            return *previousArena;
+        }
+
+        /*
+            Starts a new frame. The current arena becomes the previous one, and
+            the previous one, holding data from two frames ago, is reset and
+            becomes current.
+        */
+        void swapBuffers() noexcept
+        {
+            LinearArena *oldest = previousArena;
+            previousArena = currentArena;
+            currentArena = oldest;
+            currentArena->reset();
+        }
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_LINEARARENA_HXX_
@@ -0,0 +1,124 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_SMALLOBJECTHEAP_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_SMALLOBJECTHEAP_HXX_
+
+#include <stddef.h>
+#include <mutex>
+
+#include "bgmemory/allocators/Allocator.hxx"
+
+namespace bg
+{
+    namespace inner
+    {
+        struct SlabHeader;
+    } // namespace inner
+
+    /*
+        General purpose allocator for small objects of assorted sizes.
+
+        Requests up to maxSmallSize bytes are rounded up to one of a fixed set
+        of size classes. Each class carves its blocks from slabs of slabSize
+        bytes drawn from allocateAlligned. Slabs are aligned to their own size,
+        so the slab owning a block is found by masking its address and blocks
+        carry no header. Allocating and freeing are O(1).
+
+        A slab whose blocks have all been freed is returned to the system,
+        except for one empty slab kept per class so a class hovering around a
+        slab boundary does not keep allocating and freeing slabs.
+
+        Blocks are aligned to 8 bytes, or 16 for sizes above 8. Larger
+        requests, and requests for stricter alignment, go straight to
+        allocateAlligned.
+
+        The heap is only safe to share between threads when constructed as
+        thread safe, in which case each size class is guarded by its own mutex.
+    */
+    class SmallObjectHeap : public Allocator
+    {
+    public:
+        // Largest request served from the size classes.
+        static constexpr size_t maxSmallSize = 1024;
+
+        // Size and alignment of each slab.
+        static constexpr size_t slabSize = 16 * 1024;
+
+        // Number of size classes.
+        static constexpr size_t classCount = 21;
+
+    private:
+        struct SizeClass
+        {
+            std::mutex mutex;
+            // Slabs with at least one free block.
+            inner::SlabHeader *partial = nullptr;
+            // Empty slab kept back from the system.
+            inner::SlabHeader *spare = nullptr;
+        };
+
+        SizeClass classes[classCount];
+        bool threadSafe;
+
+        // Every slab owned by the heap, guarded by this mutex.
+        std::mutex slabsMutex;
+        inner::SlabHeader *slabs = nullptr;
+        size_t slabTotal = 0;
+
+        inner::SlabHeader *createSlab(size_t classIndex);
+        void destroySlab(inner::SlabHeader *slab) noexcept;
+
+    public:
+        /*
+            Constructs an empty heap. No memory is allocated until the first request.
+
+            @param isThreadSafe whether the heap may be used from several threads at once.
+        */
+        explicit SmallObjectHeap(bool isThreadSafe = false) noexcept;
+
+        SmallObjectHeap(const SmallObjectHeap &) = delete;
+        SmallObjectHeap &operator=(const SmallObjectHeap &) = delete;
+
+        /*
+            Destructor, returns every slab to the system. Blocks still
+            allocated from the heap become invalid.
+        */
+        ~SmallObjectHeap() override;
+
+        /*
+            Allocates a block.
+
+            @param sizeInBytes size of the block.
+            @param alignment power of two alignment of the block.
+            @return pointer to the block, or nullptr if no memory is available.
+        */
+        void *allocate(size_t sizeInBytes, size_t alignment) override;
+
+        /*
+            Frees a block allocated from this heap.
+
+            @param pointer the block to free.
+            @param sizeInBytes size the block was allocated with.
+            @param alignment alignment the block was allocated with.
+        */
+        void deallocate(void *pointer, size_t sizeInBytes, size_t alignment) override;
+
+        /*
+            Gets the size of the size class serving a request.
+
+            @param sizeInBytes size of the request.
+            @param alignment alignment of the request.
+            @return the size of the block handed out, 0 for requests not served
+            from the size classes.
+        */
+        static size_t classSizeFor(size_t sizeInBytes, size_t alignment) noexcept;
+
+        /*
+            Gets the number of slabs currently held by the heap.
+
+            @return count of slabs, including the kept empty ones.
+        */
+        size_t slabCount() noexcept;
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_SMALLOBJECTHEAP_HXX_
@@ -0,0 +1,61 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_STACKALLOCATOR_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_STACKALLOCATOR_HXX_
+
+#include <stddef.h>
+
+#include "bgmemory/allocators/LinearArena.hxx"
+
+namespace bg
+{
+    /*
+        Last in first out allocator, for nested scoped allocations such as
+        level loading or building parse trees.
+
+        The stack is a LinearArena whose deallocate pops: memory is handed out
+        from one cache line aligned block by moving the top of the stack up,
+        and no header is stored with an allocation, so the only overhead is
+        the padding its alignment requires. Popping the top allocation moves
+        the top back down to its start, and the padding below it is reclaimed
+        once the allocation beneath is popped too. Markers, rollback and reset
+        work as they do on the arena.
+
+        Deallocation must happen in reverse order of allocation: deallocating
+        a block frees it along with everything allocated after it. Containers
+        which reallocate as they grow break that order, use a LinearArena for
+        those instead.
+
+        With BG_MEMORY_DEBUG, new allocations are filled with allocatedFill,
+        popped memory with freedFill, and deallocating a block which was
+        already popped is reported as a double free.
+
+        The allocator is not thread safe.
+    */
+    class StackAllocator : public LinearArena
+    {
+    public:
+        /*
+            Constructs a stack reserving the given number of bytes.
+
+            @param capacityInBytes size of the stack.
+            @param a allocator providing the stack's block, must outlive the stack.
+            @throws std::bad_alloc if the block cannot be allocated.
+        */
+        explicit StackAllocator(size_t capacityInBytes, Allocator &a = defaultAllocator())
+            : LinearArena(capacityInBytes, a)
+        {
+        }
+
+        /*
+            Pops an allocation off the stack, along with anything allocated
+            after it. Deallocating nullptr does nothing.
+
+            @param pointer the allocation to pop.
+            @param sizeInBytes size the allocation was made with.
+            @param alignment alignment the allocation was made with.
+        */
+        void deallocate(void *pointer, size_t sizeInBytes, size_t alignment) override;
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_STACKALLOCATOR_HXX_
@@ -0,0 +1,107 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_STDALLOCATOR_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_STDALLOCATOR_HXX_
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+
+#include "bgmemory/allocators/Allocator.hxx"
+
+namespace bg
+{
+    /*
+        Adaptor exposing a bg::Allocator through the standard library
+        allocator interface, so standard containers can draw from any
+        allocator in this library.
+
+        The adaptor only holds a pointer to the allocator; the allocator must
+        outlive every container using it. Two adaptors compare equal when they
+        refer to the same allocator.
+    */
+    template <class T>
+    class StdAllocator
+    {
+        template <class U>
+        friend class StdAllocator;
+
+        Allocator *allocator;
+
+    public:
+        using value_type = T;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        /*
+            Constructs an adaptor over the default allocator.
+        */
+        StdAllocator() noexcept : allocator(&defaultAllocator()) {}
+
+        /*
+            Constructs an adaptor over the given allocator.
+
+            @param a the allocator to draw memory from.
+        */
+        StdAllocator(Allocator &a) noexcept : allocator(&a) {} // NOLINT
+
+        /*
+            Rebinding constructor, shares the allocator of another adaptor.
+
+            @param other the adaptor to copy the allocator from.
+        */
+        template <class U>
+        StdAllocator(const StdAllocator<U> &other) noexcept : allocator(other.allocator) {} // NOLINT
+
+        /*
+            Allocates storage for count objects of T.
+
+            @param count number of objects to allocate room for.
+            @return pointer to the storage.
+            @throws std::bad_alloc if the allocator cannot satisfy the request.
+        */
+        T *allocate(size_t count)
+        {
+            void *pointer = allocator->allocate(count * sizeof(T), alignof(T));
+            if (pointer == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            return static_cast<T *>(pointer);
+        }
+
+        /*
+            Releases storage for count objects of T.
+
+            @param pointer storage returned by allocate.
+            @param count the count passed to allocate.
+        */
+        void deallocate(T *pointer, size_t count) noexcept
+        {
+            allocator->deallocate(pointer, count * sizeof(T), alignof(T));
+        }
+
+        /*
+            Gets the allocator this adaptor draws from.
+
+            @return reference to the underlying allocator.
+        */
+        Allocator &getAllocator() const noexcept
+        {
+            return *allocator;
+        }
+
+        template <class U>
+        bool operator==(const StdAllocator<U> &other) const noexcept
+        {
+            return allocator == other.allocator;
+        }
+
+        template <class U>
+        bool operator!=(const StdAllocator<U> &other) const noexcept
+        {
+            return allocator != other.allocator;
+        }
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_STDALLOCATOR_HXX_
@@ -0,0 +1,46 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_TRACKINGALLOCATOR_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_TRACKINGALLOCATOR_HXX_
+
+#include <stddef.h>
+
+#include "bgmemory/allocators/Allocator.hxx"
+#include "bgmemory/instrumentation/MemoryTracker.hxx"
+
+namespace bg
+{
+    /*
+        Allocator which forwards to another allocator and records every
+        allocation and free in a MemoryTracker.
+
+        Several tracking allocators may share one tracker to report a whole
+        subsystem under one name, for instance every arena and pool used by
+        physics. Failed allocations are not recorded.
+    */
+    class TrackingAllocator : public Allocator
+    {
+        Allocator *backing;
+        MemoryTracker *tracker;
+
+    public:
+        /*
+            Constructs a tracking allocator.
+
+            @param a allocator doing the actual work, must outlive this one.
+            @param t tracker to record into, must outlive this allocator.
+        */
+        TrackingAllocator(Allocator &a, MemoryTracker &t) noexcept;
+
+        void *allocate(size_t sizeInBytes, size_t alignment) override;
+        void deallocate(void *pointer, size_t sizeInBytes, size_t alignment) override;
+
+        /*
+            Gets the tracker this allocator records into.
+
+            @return the tracker.
+        */
+        MemoryTracker &getTracker() const noexcept;
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_TRACKINGALLOCATOR_HXX_
@@ -0,0 +1,180 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_VIRTUALARENA_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_VIRTUALARENA_HXX_
+
+#include <stddef.h>
+
+#include "bgmemory/allocators/Allocator.hxx"
+#include "bgmemory/debug/MemoryDebug.hxx"
+
+namespace bg
+{
+    /*
+        Bump pointer arena which grows without ever moving, for data whose
+        final size is not known up front, such as level geometry or the
+        storage of a pool which must keep its addresses stable.
+
+        The arena reserves a large range of address space when constructed
+        but commits memory only as allocations reach into it, a chunk of
+        commitGranularity bytes at a time, so growing never copies anything
+        and resident memory follows what is actually in use. Reserving costs
+        no memory, so the reservation can be generous.
+
+        As with LinearArena, individual deallocation is a no-op; memory comes
+        back through reset or rollback. Memory given back stays committed, so
+        an arena reused every frame does not fault its pages in again. Call
+        trim after a large shrink, such as unloading a level, to return the
+        unused pages to the system.
+
+        The arena is not thread safe.
+
+        With BG_MEMORY_DEBUG, new allocations are filled with allocatedFill and
+        memory given back by reset or rollback with freedFill.
+    */
+    class VirtualArena : public Allocator
+    {
+        unsigned char *base = nullptr;
+        size_t reserved = 0;
+        size_t committedBytes = 0;
+        size_t offset = 0;
+        size_t granularity = 0;
+
+        // Commits enough chunks to cover the first end bytes of the range.
+        bool commitTo(size_t end) noexcept;
+
+    public:
+        // Position in the arena which can be rolled back to.
+        using Marker = size_t;
+
+        // Default amount of memory committed at a time.
+        static constexpr size_t defaultCommitGranularity = 64 * 1024;
+
+        /*
+            Constructs an arena, reserving address space for it. No memory is
+            committed until the first allocation.
+
+            @param reserveBytes maximum size the arena can grow to.
+            @param commitGranularity amount of memory committed at a time, rounded up to whole pages.
+            @throws std::bad_alloc if the address space cannot be reserved.
+        */
+        explicit VirtualArena(size_t reserveBytes, size_t commitGranularity = defaultCommitGranularity);
+
+        VirtualArena(const VirtualArena &) = delete;
+        VirtualArena &operator=(const VirtualArena &) = delete;
+
+        /*
+            Destructor, releases the reserved range and everything committed in it.
+        */
+        ~VirtualArena() override;
+
+        /*
+            Allocates memory from the arena, committing more if needed.
+
+            @param sizeInBytes size of the allocation.
+            @param alignment power of two alignment of the allocation.
+            @return pointer to the memory, or nullptr if the reservation is
+            exhausted or the system refuses to commit more memory.
+        */
+        void *allocate(size_t sizeInBytes, size_t alignment) override;
+
+        /*
+            Does nothing, arena memory is only reclaimed by reset or rollback.
+        */
+        void deallocate(void *pointer, size_t sizeInBytes, size_t alignment) override;
+
+        /*
+            Gets a marker for the current top of the arena.
+
+            @return marker to pass to rollback.
+        */
+        Marker getMarker() const noexcept
+        {
+            return offset;
+        }
+
+        /*
+            Frees everything allocated since the marker was taken. The memory
+            stays committed for reuse.
+
+            @param marker marker taken from this arena since its last reset.
+        */
+        void rollback(Marker marker) noexcept;
+
+        /*
+            Frees everything in the arena in constant time. The memory stays
+            committed for reuse.
+        */
+        void reset() noexcept
+        {
+            BG_MEMORY_POISON(base, offset, freedFill);
+            offset = 0;
+        }
+
+        /*
+            Decommits every chunk above the one holding the top of the arena,
+            returning the memory to the system.
+        */
+        void trim() noexcept;
+
+        /*
+            Checks whether the given pointer lies inside the arena's reserved range.
+
+            @param pointer the pointer to check.
+            @return whether the pointer belongs to the arena.
+        */
+        bool owns(const void *pointer) const noexcept;
+
+        /*
+            Gets the start of the reserved range, where the first allocation
+            made after a reset is placed if it needs no padding.
+
+            @return page aligned start of the arena, or nullptr if nothing was reserved.
+        */
+        void *data() const noexcept
+        {
+            return base;
+        }
+
+        /*
+            Gets the size the arena can grow to.
+
+            @return reserved bytes.
+        */
+        size_t capacity() const noexcept
+        {
+            return reserved;
+        }
+
+        /*
+            Gets the amount of memory currently committed.
+
+            @return committed bytes, a multiple of the commit granularity.
+        */
+        size_t committed() const noexcept
+        {
+            return committedBytes;
+        }
+
+        /*
+            Gets the number of bytes in use, including alignment padding.
+
+            @return bytes in use.
+        */
+        size_t used() const noexcept
+        {
+            return offset;
+        }
+
+        /*
+            Gets the number of bytes left before the reservation is exhausted.
+
+            @return bytes remaining.
+        */
+        size_t remaining() const noexcept
+        {
+            return reserved - offset;
+        }
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_VIRTUALARENA_HXX_
@@ -0,0 +1,84 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_INNER_BUMPBLOCK_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_INNER_BUMPBLOCK_HXX_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bgmemory/allocators/Allocator.hxx"
+
+namespace bg::inner
+{
+    // Returned by bumpUp and bumpDown when an allocation does not fit.
+    constexpr size_t noRoom = SIZE_MAX;
+
+    /*
+        Places an allocation at the first suitably aligned offset at or above
+        top, without letting it pass limit.
+
+        @param base start of the memory offsets are measured from.
+        @param top offset the allocation may start at.
+        @param limit offset the allocation must end at or below.
+        @param sizeInBytes size of the allocation.
+        @param alignment power of two alignment of the allocation.
+        @return offset of the allocation, or noRoom if it does not fit.
+    */
+    size_t bumpUp(const unsigned char *base, size_t top, size_t limit, size_t sizeInBytes, size_t alignment) noexcept;
+
+    /*
+        Places an allocation at the last suitably aligned offset ending at or
+        below top, without letting it start below limit.
+
+        @param base start of the memory offsets are measured from.
+        @param top offset the allocation must end at or below.
+        @param limit offset the allocation may start at.
+        @param sizeInBytes size of the allocation.
+        @param alignment power of two alignment of the allocation.
+        @return offset of the allocation, or noRoom if it does not fit.
+    */
+    size_t bumpDown(const unsigned char *base, size_t top, size_t limit, size_t sizeInBytes, size_t alignment) noexcept;
+
+    /*
+        Cache line aligned block drawn from a backing allocator and returned
+        to it on destruction, the storage of the bump allocators.
+    */
+    class BumpBlock
+    {
+        Allocator *backing;
+        unsigned char *memory = nullptr;
+        size_t bytes = 0;
+
+    public:
+        /*
+            Allocates the block. A zero sized block allocates nothing.
+
+            @param sizeInBytes size of the block.
+            @param a allocator providing the block, must outlive it.
+            @throws std::bad_alloc if the block cannot be allocated.
+        */
+        BumpBlock(size_t sizeInBytes, Allocator &a);
+
+        BumpBlock(const BumpBlock &) = delete;
+        BumpBlock &operator=(const BumpBlock &) = delete;
+
+        ~BumpBlock();
+
+        unsigned char *data() const noexcept
+        {
+            return memory;
+        }
+
+        size_t size() const noexcept
+        {
+            return bytes;
+        }
+
+        bool owns(const void *pointer) const noexcept
+        {
+            auto p = static_cast<const unsigned char *>(pointer);
+            return p >= memory && p < memory + bytes;
+        }
+    };
+} // namespace bg::inner
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_ALLOCATORS_INNER_BUMPBLOCK_HXX_
@@ -1,10 +1,407 @@
-#ifndef BULLETPOOL_HXX__INCLUDED
-#define BULLETPOOL_HXX__INCLUDED
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_BULLETPOOL_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_BULLETPOOL_HXX_
 
-namespace bg {
-    class BulletPool {
-        bool herp();
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "bgmemory/assert.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+#include "bgmemory/allocators/Allocator.hxx"
+#include "bgmemory/debug/MemoryDebug.hxx"
+
+namespace bg::inner
+{
+    // Sentinel index marking the end of a slot free list.
+    constexpr uint32_t endOfFreeList = 0xFFFFFFFFu;
+
+    /*
+        Links every slot in a block of slots into an ascending free list, writing
+        the index of the next free slot into the first bytes of each slot. The last
+        slot is terminated with endOfFreeList.
+
+        @param slots pointer to the first slot.
+        @param slotSize size of a single slot in bytes, at least sizeof(uint32_t).
+        @param capacity number of slots in the block.
+    */
+    void threadFreeList(void *slots, size_t slotSize, uint32_t capacity);
+
+    /*
+        Storage for one slot of a pool of T: large enough for a T or a free
+        list link, whichever is bigger.
+    */
+    template <class T>
+    using PoolSlot = typename std::aligned_storage<
+        (sizeof(T) > sizeof(uint32_t) ? sizeof(T) : sizeof(uint32_t)),
+        (alignof(T) > alignof(uint32_t) ? alignof(T) : alignof(uint32_t))>::type;
+
+    /*
+        Gets the number of 64 bit words needed for a bitmap tracking the given
+        number of slots.
+
+        @param capacity number of slots to track.
+        @return count of words for the bitmap.
+    */
+    constexpr size_t bitmapWordCount(size_t capacity)
+    {
+        return (capacity + 63) / 64;
+    }
+
+    /*
+        Gets the index of the lowest set bit in a non zero word.
+
+        @param word the word to scan, must not be zero.
+        @return the index of the lowest set bit.
+    */
+    inline unsigned lowestSetBit(uint64_t word)
+    {
+        return static_cast<unsigned>(__builtin_ctzll(word));
+    }
+
+    /*
+        Gets the index of the highest set bit in a non zero word.
+
+        @param word the word to scan, must not be zero.
+        @return the index of the highest set bit.
+    */
+    inline unsigned highestSetBit(uint64_t word)
+    {
+        return static_cast<unsigned>(63 - __builtin_clzll(word));
+    }
+
+    /*
+        Gets the offset of the live bitmap in a pool block, which holds the
+        slots followed by the bitmap.
+
+        @param capacity number of slots in the block.
+        @param slotSize size of a single slot in bytes.
+        @return offset of the bitmap from the start of the block.
+    */
+    constexpr size_t slotBitmapOffset(size_t capacity, size_t slotSize)
+    {
+        return alignUp(capacity * slotSize, alignof(uint64_t));
+    }
+
+    /*
+        Gets the size of a pool block holding the slots and their live bitmap.
+
+        @param capacity number of slots in the block.
+        @param slotSize size of a single slot in bytes.
+        @return size of the block in bytes.
+    */
+    constexpr size_t slotBlockSize(size_t capacity, size_t slotSize)
+    {
+        return slotBitmapOffset(capacity, slotSize) + bitmapWordCount(capacity) * sizeof(uint64_t);
+    }
+} // namespace bg::inner
+
+namespace bg
+{
+    /*
+        Fixed capacity object pool for large numbers of short lived objects of
+        the same type (bullets, particles, etc).
+
+        All slots live in a single contiguous, cache line aligned block drawn
+        from a bg::Allocator when the pool is constructed. Free slots are
+        chained through an intrusive free list stored inside the unused slots
+        themselves, so acquiring and releasing an object is O(1) and never
+        allocates after construction.
+
+        A bitmap of live slots is kept alongside the slot storage so live objects
+        can be visited in memory order, skipping empty runs 64 slots at a time.
+
+        With BG_MEMORY_DEBUG, free slots are filled with freedFill; releasing an
+        object twice and writing to a released slot are reported through
+        reportMemoryError.
+
+        The pool is not thread safe.
+    */
+    template <class T>
+    class BulletPool
+    {
+        using Slot = inner::PoolSlot<T>;
+
+        Allocator *allocator = nullptr;
+        Slot *slots = nullptr;
+        uint64_t *liveBits = nullptr;
+        uint32_t slotCount = 0;
+        uint32_t freeHead = inner::endOfFreeList;
+        uint32_t live = 0;
+
+        uint32_t &nextFree(uint32_t index) noexcept
+        {
+            return *reinterpret_cast<uint32_t *>(&slots[index]);
+        }
+
+        bool isLive(uint32_t index) const noexcept
+        {
+            return (liveBits[index / 64] & (uint64_t(1) << (index % 64))) != 0;
+        }
+
+#ifdef BG_MEMORY_DEBUG
+        // Bytes of a free slot past its free list link, poisoned while free.
+        static constexpr size_t poisonedSlotBytes = sizeof(Slot) - sizeof(uint32_t);
+
+        unsigned char *poisonedBytes(uint32_t index) noexcept
+        {
+            return reinterpret_cast<unsigned char *>(&slots[index]) + sizeof(uint32_t);
+        }
+
+        void poisonFreeSlots() noexcept
+        {
+            for (uint32_t i = 0; i < slotCount; i++)
+            {
+                poisonMemory(poisonedBytes(i), poisonedSlotBytes, freedFill);
+            }
+        }
+#endif // BG_MEMORY_DEBUG
+
+        static constexpr size_t blockAlignment =
+            alignof(Slot) > cacheLineSize ? alignof(Slot) : cacheLineSize;
+
+        template <class PoolT, class F>
+        static void visitLive(PoolT &pool, F &f)
+        {
+            const size_t words = inner::bitmapWordCount(pool.slotCount);
+            for (size_t w = 0; w < words; w++)
+            {
+                uint64_t bits = pool.liveBits[w];
+                while (bits != 0)
+                {
+                    const size_t index = w * 64 + inner::lowestSetBit(bits);
+                    bits &= bits - 1;
+                    f(*reinterpret_cast<T *>(&pool.slots[index]));
+                }
+            }
+        }
+
+    public:
+        /*
+            Constructs a pool with room for the given number of objects. This is
+            the only point at which the pool allocates memory.
+
+            @param capacity maximum number of live objects the pool can hold.
+            @param a allocator providing the slot storage, must outlive the pool.
+            @throws std::bad_alloc if the allocator cannot provide the storage.
+        */
+        explicit BulletPool(uint32_t capacity, Allocator &a = defaultAllocator())
+            : allocator(&a)
+        {
+            ASSERT(capacity < inner::endOfFreeList);
+            if (capacity == 0)
+            {
+                return;
+            }
+
+            auto block = static_cast<unsigned char *>(allocator->allocate(inner::slotBlockSize(capacity, sizeof(Slot)), blockAlignment));
+            if (block == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+
+            slotCount = capacity;
+            slots = reinterpret_cast<Slot *>(block);
+            liveBits = reinterpret_cast<uint64_t *>(block + inner::slotBitmapOffset(slotCount, sizeof(Slot)));
+            for (size_t w = 0; w < inner::bitmapWordCount(slotCount); w++)
+            {
+                liveBits[w] = 0;
+            }
+            inner::threadFreeList(slots, sizeof(Slot), slotCount);
+            freeHead = 0;
+#ifdef BG_MEMORY_DEBUG
+            poisonFreeSlots();
+#endif // BG_MEMORY_DEBUG
+        }
+
+        BulletPool(const BulletPool<T> &) = delete;
+        BulletPool<T> &operator=(const BulletPool<T> &) = delete;
+
+        /*
+            Destructor. Destroys any objects still live in the pool before
+            releasing the slot storage.
+        */
+        ~BulletPool()
+        {
+            if (slots != nullptr)
+            {
+                clear();
+                allocator->deallocate(slots, inner::slotBlockSize(slotCount, sizeof(Slot)), blockAlignment);
+            }
+        }
+
+        /*
+            Constructs a new object in a free slot.
+
+            @param args arguments forwarded to the constructor of T.
+            @return pointer to the new object, or nullptr if the pool is full.
+        */
+        template <class... Args>
+        T *acquire(Args &&... args)
+        {
+            if (freeHead == inner::endOfFreeList)
+            {
+                return nullptr;
+            }
+
+            const uint32_t index = freeHead;
+            const uint32_t next = nextFree(index);
+#ifdef BG_MEMORY_DEBUG
+            if (!isPoisoned(poisonedBytes(index), poisonedSlotBytes, freedFill))
+            {
+                reportMemoryError(MemoryError::UseAfterFree, &slots[index],
+                                  "released BulletPool slot was written to");
+            }
+#endif // BG_MEMORY_DEBUG
+            // Unlinked first, so a throwing constructor cannot leave the free
+            // list running through a half written slot.
+            freeHead = next;
+            T *object;
+            try
+            {
+                object = new (&slots[index]) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                BG_MEMORY_POISON(poisonedBytes(index), poisonedSlotBytes, freedFill);
+                nextFree(index) = next;
+                freeHead = index;
+                throw;
+            }
+            liveBits[index / 64] |= uint64_t(1) << (index % 64);
+            live++;
+            return object;
+        }
+
+        /*
+            Destroys an object previously acquired from this pool and returns its
+            slot to the free list. Releasing nullptr does nothing.
+
+            @param object pointer to the object to release.
+        */
+        void release(T *object) noexcept
+        {
+            if (object == nullptr)
+            {
+                return;
+            }
+
+            ASSERT(owns(object));
+            const uint32_t index = static_cast<uint32_t>(reinterpret_cast<Slot *>(object) - slots);
+#ifdef BG_MEMORY_DEBUG
+            if (!isLive(index))
+            {
+                reportMemoryError(MemoryError::DoubleFree, object, "object was already released to its BulletPool");
+                return;
+            }
+#else
+            ASSERT(isLive(index));
+#endif // BG_MEMORY_DEBUG
+
+            object->~T();
+            BG_MEMORY_POISON(poisonedBytes(index), poisonedSlotBytes, freedFill);
+            liveBits[index / 64] &= ~(uint64_t(1) << (index % 64));
+            nextFree(index) = freeHead;
+            freeHead = index;
+            live--;
+        }
+
+        /*
+            Destroys every live object, returning the pool to its freshly
+            constructed state.
+        */
+        void clear() noexcept
+        {
+            if (live > 0)
+            {
+                forEach([](T &object) { object.~T(); });
+            }
+            for (size_t w = 0; w < inner::bitmapWordCount(slotCount); w++)
+            {
+                liveBits[w] = 0;
+            }
+            if (slotCount > 0)
+            {
+                inner::threadFreeList(slots, sizeof(Slot), slotCount);
+                freeHead = 0;
+#ifdef BG_MEMORY_DEBUG
+                poisonFreeSlots();
+#endif // BG_MEMORY_DEBUG
+            }
+            live = 0;
+        }
+
+        /*
+            Calls the given function object with a reference to every live object,
+            in the order the objects are laid out in memory.
+
+            The function must not acquire or release objects from this pool.
+
+            @param f function object callable with a T&.
+        */
+        template <class F>
+        void forEach(F &&f)
+        {
+            visitLive(*this, f);
+        }
+
+        /*
+            Calls the given function object with a constant reference to every
+            live object, in the order the objects are laid out in memory.
+
+            @param f function object callable with a const T&.
+        */
+        template <class F>
+        void forEach(F &&f) const
+        {
+            auto constF = [&f](T &object) { f(static_cast<const T &>(object)); };
+            visitLive(*this, constF);
+        }
+
+        /*
+            Checks whether the given pointer refers to a slot inside this pool.
+
+            @param object the pointer to check.
+            @return whether the pointer lies inside the pool's slot storage.
+        */
+        bool owns(const T *object) const noexcept
+        {
+            auto slot = reinterpret_cast<const Slot *>(object);
+            return slot >= slots && slot < slots + slotCount;
+        }
+
+        /*
+            Gets the maximum number of objects the pool can hold.
+
+            @return the capacity of the pool.
+        */
+        uint32_t capacity() const noexcept
+        {
+            return slotCount;
+        }
+
+        /*
+            Gets the number of live objects in the pool.
+
+            @return count of acquired and not yet released objects.
+        */
+        uint32_t liveCount() const noexcept
+        {
+            return live;
+        }
+
+        /*
+            Gets whether every slot in the pool is in use.
+
+            @return whether the next acquire will fail.
+        */
+        bool full() const noexcept
+        {
+            return freeHead == inner::endOfFreeList;
+        }
     };
 } // namespace bg
 
-#endif //BULLETPOOL_HXX__INCLUDED_INCLUDED
\ No newline at end of file
+#endif // BGMEMORY_INCLUDE_BGMEMORY_BULLETPOOL_HXX_
@@ -0,0 +1,141 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_DEBUG_MEMORYDEBUG_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_DEBUG_MEMORYDEBUG_HXX_
+
+#include <stddef.h>
+
+namespace bg
+{
+    // Byte written over memory handed out but not yet initialised.
+    constexpr unsigned char allocatedFill = 0xCD;
+
+    // Byte written over memory once it is freed.
+    constexpr unsigned char freedFill = 0xDD;
+
+    // Byte written into the guard bands around debug allocations.
+    constexpr unsigned char guardFill = 0xFD;
+
+    /*
+        Kinds of misuse reported by the debug checks.
+    */
+    enum class MemoryError
+    {
+        // A block was freed twice.
+        DoubleFree,
+        // A pointer was freed which the allocator never handed out.
+        InvalidFree,
+        // Bytes around a block were overwritten.
+        GuardCorrupted,
+        // Freed memory was written to before it was reused.
+        UseAfterFree,
+        // An object replaced through a SharedPtrMutator was written to.
+        UseAfterMutate,
+        // A block was still allocated when its allocator went away.
+        Leak
+    };
+
+    /*
+        Function called with every memory error found by the debug checks.
+        The detail string is only valid for the duration of the call.
+    */
+    using MemoryErrorHandler = void (*)(MemoryError error, const void *pointer, const char *detail);
+
+    /*
+        Installs the function memory errors are reported to. The default
+        handler prints the error and, except for leaks, breaks into the
+        debugger the same way ASSERT does.
+
+        @param handler the new handler, nullptr restores the default one.
+        @return the previously installed handler.
+    */
+    MemoryErrorHandler setMemoryErrorHandler(MemoryErrorHandler handler) noexcept;
+
+    /*
+        Reports a memory error to the installed handler.
+
+        @param error kind of error.
+        @param pointer the memory involved.
+        @param detail human readable description.
+    */
+    void reportMemoryError(MemoryError error, const void *pointer, const char *detail);
+
+    /*
+        Gets a printable name for a kind of memory error.
+
+        @param error kind of error.
+        @return the name of the error.
+    */
+    const char *memoryErrorName(MemoryError error) noexcept;
+
+    /*
+        Fills memory with a byte pattern.
+
+        @param pointer start of the memory.
+        @param sizeInBytes number of bytes to fill.
+        @param fill byte to write.
+    */
+    void poisonMemory(void *pointer, size_t sizeInBytes, unsigned char fill) noexcept;
+
+    /*
+        Checks that memory still holds a byte pattern written by poisonMemory.
+
+        @param pointer start of the memory.
+        @param sizeInBytes number of bytes to check.
+        @param fill byte expected.
+        @return whether every byte still matches.
+    */
+    bool isPoisoned(const void *pointer, size_t sizeInBytes, unsigned char fill) noexcept;
+
+    /*
+        Source location recorded against debug allocations made while it is in
+        scope. Sites nest; the innermost one on the calling thread wins. Use
+        through BG_MEMORY_ALLOCATION_SITE.
+    */
+    class AllocationSite
+    {
+        const char *siteFile;
+        int siteLine;
+        const AllocationSite *outer;
+
+    public:
+        AllocationSite(const char *file, int line) noexcept;
+        ~AllocationSite();
+
+        AllocationSite(const AllocationSite &) = delete;
+        AllocationSite &operator=(const AllocationSite &) = delete;
+
+        const char *file() const noexcept
+        {
+            return siteFile;
+        }
+
+        int line() const noexcept
+        {
+            return siteLine;
+        }
+
+        /*
+            Gets the innermost site in scope on the calling thread.
+
+            @return the current site, or nullptr if none is in scope.
+        */
+        static const AllocationSite *current() noexcept;
+    };
+} // namespace bg
+
+/*
+    Debug hooks used inside the library. BG_MEMORY_DEBUG is defined alongside
+    ASSERTIONS_ENABLED in debug builds; without it the hooks compile to nothing.
+*/
+#ifdef BG_MEMORY_DEBUG
+#define BG_MEMORY_POISON(pointer, sizeInBytes, fill) ::bg::poisonMemory(pointer, sizeInBytes, fill)
+#define BG_MEMORY_ALLOCATION_SITE_NAME(line) bgMemoryAllocationSite##line
+#define BG_MEMORY_ALLOCATION_SITE_AT(line) \
+    ::bg::AllocationSite BG_MEMORY_ALLOCATION_SITE_NAME(line)(__FILE__, line)
+#define BG_MEMORY_ALLOCATION_SITE() BG_MEMORY_ALLOCATION_SITE_AT(__LINE__)
+#else
+#define BG_MEMORY_POISON(pointer, sizeInBytes, fill)
+#define BG_MEMORY_ALLOCATION_SITE()
+#endif // BG_MEMORY_DEBUG
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_DEBUG_MEMORYDEBUG_HXX_
@@ -0,0 +1,167 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_INSTRUMENTATION_MEMORYTRACKER_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_INSTRUMENTATION_MEMORYTRACKER_HXX_
+
+#include <stddef.h>
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bg
+{
+    /*
+        Point in time copy of the counters of a MemoryTracker.
+    */
+    struct AllocationStats
+    {
+        // Number of power of two size buckets in the histogram.
+        static constexpr size_t histogramBuckets = 16;
+
+        // Bytes allocated and not yet freed.
+        size_t liveBytes = 0;
+
+        // Largest value liveBytes has reached.
+        size_t peakBytes = 0;
+
+        size_t allocationCount = 0;
+        size_t freeCount = 0;
+
+        // Allocation counts by size. Bucket i counts sizes above 2^(i-1) and
+        // up to 2^i bytes, the last bucket also counts everything larger.
+        size_t histogram[histogramBuckets] = {};
+    };
+
+    /*
+        Counters of one tracker, as captured by snapshotMemory.
+    */
+    struct TrackerSnapshot
+    {
+        std::string name;
+        AllocationStats stats;
+    };
+
+    /*
+        Named set of allocation counters, one per allocator or per category of
+        allocations. Every tracker in existence is listed by snapshotMemory.
+
+        Counters are relaxed atomics, so a tracker can be fed from several
+        threads. Trackers cost nothing until something records into them: the
+        library only does so itself when BG_MEMORY_INSTRUMENTATION is defined,
+        and a TrackingAllocator only when one is constructed.
+    */
+    class MemoryTracker
+    {
+        std::string trackerName;
+        std::atomic<size_t> liveBytes{0};
+        std::atomic<size_t> peakBytes{0};
+        std::atomic<size_t> allocationCount{0};
+        std::atomic<size_t> freeCount{0};
+        std::atomic<size_t> histogram[AllocationStats::histogramBuckets];
+
+        // Neighbours in the registry of every tracker.
+        MemoryTracker *prev = nullptr;
+        MemoryTracker *next = nullptr;
+
+        friend std::vector<TrackerSnapshot> snapshotMemory();
+
+    public:
+        /*
+            Constructs a tracker and registers it for snapshots.
+
+            @param name name reported for the tracker, such as the subsystem it covers.
+        */
+        explicit MemoryTracker(std::string name);
+
+        MemoryTracker(const MemoryTracker &) = delete;
+        MemoryTracker &operator=(const MemoryTracker &) = delete;
+
+        /*
+            Destructor, removes the tracker from the registry.
+        */
+        ~MemoryTracker();
+
+        /*
+            Records an allocation.
+
+            @param sizeInBytes size of the allocation.
+        */
+        void recordAllocation(size_t sizeInBytes) noexcept;
+
+        /*
+            Records a free.
+
+            @param sizeInBytes size the freed block was allocated with.
+        */
+        void recordFree(size_t sizeInBytes) noexcept;
+
+        /*
+            Gets a copy of the counters. Counters are read one at a time, so a
+            copy taken while other threads record is only approximately
+            consistent.
+
+            @return the current counters.
+        */
+        AllocationStats getStats() const noexcept;
+
+        /*
+            Clears the counters. The peak restarts from the current live bytes.
+        */
+        void reset() noexcept;
+
+        /*
+            Gets the name of the tracker.
+
+            @return the name the tracker was constructed with.
+        */
+        const std::string &name() const noexcept;
+    };
+
+    /*
+        Copies the counters of every registered tracker.
+
+        @return the name and counters of each tracker, most recently created first.
+    */
+    std::vector<TrackerSnapshot> snapshotMemory();
+
+    /*
+        Writes a human readable table of every registered tracker, with its
+        counters and size histogram.
+
+        @param out stream to write the report to.
+    */
+    void dumpMemoryReport(std::ostream &out);
+
+    namespace inner
+    {
+        /*
+            Tracker fed by pointer payloads drawn from the payload pool, which
+            includes deleters stored inline.
+
+            @return the payload tracker.
+        */
+        MemoryTracker &payloadTracker();
+
+        /*
+            Tracker fed by makeMutableShared and allocateMutableShared, which
+            place the payload and the object in one block.
+
+            @return the in place object tracker.
+        */
+        MemoryTracker &inplaceTracker();
+    } // namespace inner
+} // namespace bg
+
+/*
+    Instrumentation hooks used inside the library. They compile to nothing
+    unless BG_MEMORY_INSTRUMENTATION is defined.
+*/
+#ifdef BG_MEMORY_INSTRUMENTATION
+#define BG_MEMORY_TRACK_ALLOCATION(tracker, sizeInBytes) (tracker).recordAllocation(sizeInBytes)
+#define BG_MEMORY_TRACK_FREE(tracker, sizeInBytes) (tracker).recordFree(sizeInBytes)
+#else
+#define BG_MEMORY_TRACK_ALLOCATION(tracker, sizeInBytes)
+#define BG_MEMORY_TRACK_FREE(tracker, sizeInBytes)
+#endif // BG_MEMORY_INSTRUMENTATION
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_INSTRUMENTATION_MEMORYTRACKER_HXX_
@@ -1,10 +1,125 @@
-#ifndef MEMORYFUNCTIONS_HXX__INCLUDED
-#define MEMORYFUNCTIONS_HXX__INCLUDED
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_MEMORYFUNCTIONS_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_MEMORYFUNCTIONS_HXX_
 
 #include <stdlib.h>
 
-namespace bg {
-    void* allocateAlligned(size_t sizeInBytes, size_t alignment);
-}
+namespace bg
+{
+    // Size of a cache line on the platforms we target.
+    constexpr size_t cacheLineSize = 64;
 
-#endif //MEMORYFUNCTIONS_HXX__INCLUDED_INCLUDED
\ No newline at end of file
+    // Alignment required by 128 bit (SSE/NEON) vector loads and stores.
+    constexpr size_t simd128Alignment = 16;
+
+    // Alignment required by 256 bit (AVX) vector loads and stores.
+    constexpr size_t simd256Alignment = 32;
+
+    // Alignment required by 512 bit (AVX-512) vector loads and stores.
+    constexpr size_t simd512Alignment = 64;
+
+    /*
+        Checks whether a value is a power of two, the only alignments accepted
+        by the allocation functions.
+
+        @param value the value to check.
+        @return whether the value is a non zero power of two.
+    */
+    constexpr bool isPowerOfTwo(size_t value)
+    {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+
+    /*
+        Rounds a size or address up to the next multiple of the given alignment.
+
+        @param value the value to round.
+        @param alignment power of two to round to.
+        @return the smallest multiple of alignment not less than value.
+    */
+    constexpr size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    /*
+        Rounds a size or address down to a multiple of the given alignment.
+
+        @param value the value to round.
+        @param alignment power of two to round to.
+        @return the largest multiple of alignment not greater than value.
+    */
+    constexpr size_t alignDown(size_t value, size_t alignment)
+    {
+        return value & ~(alignment - 1);
+    }
+
+    /*
+        Allocates a block of memory from the system heap whose address is a
+        multiple of the given alignment. Memory returned from this function
+        must be released with freeAlligned.
+
+        @param sizeInBytes size of the block to allocate.
+        @param alignment power of two alignment of the block.
+        @return pointer to the block, or nullptr if the allocation failed.
+    */
+    void *allocateAlligned(size_t sizeInBytes, size_t alignment);
+
+    /*
+        Releases a block allocated with allocateAlligned. Passing nullptr
+        does nothing.
+
+        @param pointer the block to release.
+    */
+    void freeAlligned(void *pointer);
+
+    /*
+        Gets the size of a virtual memory page, the unit in which address
+        space is committed and decommitted.
+
+        @return page size in bytes.
+    */
+    size_t pageSize() noexcept;
+
+    /*
+        Reserves a range of virtual address space without backing it with
+        memory. The range cannot be accessed until parts of it are committed.
+        Reserved ranges must be released with releaseVirtual.
+
+        @param sizeInBytes size of the range, rounded up to whole pages.
+        @return page aligned start of the range, or nullptr if it cannot be reserved.
+    */
+    void *reserveVirtual(size_t sizeInBytes) noexcept;
+
+    /*
+        Makes pages of a reserved range readable and writable. Pages are
+        backed by physical memory lazily as they are first touched, and read
+        as zero until written.
+
+        @param pointer page aligned start of the pages, inside a reserved range.
+        @param sizeInBytes size of the pages, a multiple of pageSize().
+        @return whether the pages were committed.
+    */
+    bool commitVirtual(void *pointer, size_t sizeInBytes) noexcept;
+
+    /*
+        Returns the physical memory behind committed pages to the system,
+        keeping their addresses reserved. The pages become inaccessible again
+        and their contents are lost.
+
+        @param pointer page aligned start of the pages, inside a reserved range.
+        @param sizeInBytes size of the pages, a multiple of pageSize().
+    */
+    void decommitVirtual(void *pointer, size_t sizeInBytes) noexcept;
+
+    /*
+        Releases a range reserved with reserveVirtual, along with any memory
+        committed in it. Passing nullptr does nothing.
+
+        @param pointer start of the range returned by reserveVirtual.
+        @param sizeInBytes size the range was reserved with.
+    */
+    void releaseVirtual(void *pointer, size_t sizeInBytes) noexcept;
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_MEMORYFUNCTIONS_HXX_
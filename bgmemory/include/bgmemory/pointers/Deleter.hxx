@@ -15,6 +15,8 @@ namespace bg
     class Deleter
     {
     public:
+        virtual ~Deleter() = default;
+
         virtual void operator()(T *pointer) = 0;
     };
 
@@ -0,0 +1,336 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INTRUSIVEMUTABLEPTR_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INTRUSIVEMUTABLEPTR_HXX_
+
+#include <stddef.h>
+#include <type_traits>
+#include <utility>
+#include "bgmemory/assert.hxx"
+#include "bgmemory/pointers/inner/ManagedPointer.hxx"
+#include "bgmemory/pointers/inner/ReferenceCount.hxx"
+
+namespace bg
+{
+    // Forward Declarations
+    template <class T>
+    class IntrusiveMutablePtr;
+
+    /*
+        Base class for objects managed by IntrusiveMutablePtr, holding the
+        reference count and forwarding pointer inside the object itself. T is
+        the class deriving from it.
+
+        Copying an object does not copy its count or forwarding pointer; the
+        copy starts unreferenced.
+    */
+    template <class T>
+    class IntrusiveMutable
+    {
+        friend class IntrusiveMutablePtr<T>;
+
+        // Count of pointers referring to this object, plus one if an object
+        // forwards here.
+        inner::ReferenceCount intrusiveCount{0};
+
+        // The object which replaced this one, if it has been mutated.
+        inner::ManagedPointer<T> forwardedTo{nullptr};
+
+    protected:
+        IntrusiveMutable() noexcept = default;
+
+        IntrusiveMutable(const IntrusiveMutable<T> &) noexcept
+        {
+        }
+
+        IntrusiveMutable<T> &operator=(const IntrusiveMutable<T> &) noexcept
+        {
+            return *this;
+        }
+
+        ~IntrusiveMutable() = default;
+    };
+
+    /*
+        Shared pointer to an object deriving from IntrusiveMutable, for our own
+        types where a MutableSharedPtr's separate payload costs an extra cache
+        miss on every dereference. The count lives inside the object, so the
+        pointer is a single pointer wide and reaches the object directly.
+
+        Objects can still be replaced for every pointer at once, through
+        reset or an IntrusivePtrMutator. Rather than swapping a shared
+        payload, the replaced object records a forwarding pointer to its
+        replacement, and each pointer moves itself over the next time it is
+        dereferenced. Until then the forwarding object holds a reference to
+        its replacement, so a pointer can always follow the chain. A replaced
+        object is destroyed once the last pointer referring to it has moved on
+        or been destroyed; pointers left untouched keep it alive.
+
+        Dereferencing a pointer which has not been forwarded costs one extra
+        load from the object's header, next to the object's own data.
+
+        Objects are destroyed with delete, so a class specific operator delete
+        is honoured.
+
+        When BG_MEMORY_MULTITHREAD is defined the count and forwarding pointer
+        are atomic. As with MutableSharedPtr, a single pointer instance must
+        not be shared between threads. Each pointer holds a reference to the
+        object it refers to, so the object it returns stays alive until that
+        pointer itself moves on; no EpochGuard is needed.
+    */
+    template <class T>
+    class IntrusiveMutablePtr
+    {
+        // The object this pointer holds a reference to. May have been
+        // forwarded; moved along lazily by resolve.
+        mutable T *object = nullptr;
+
+        static IntrusiveMutable<T> &base(T *pointer) noexcept
+        {
+            return *pointer;
+        }
+
+        // Drops a reference, destroying the object on the last one along with
+        // the reference it held on its replacement, and so on down the chain.
+        static void releaseObject(T *pointer) noexcept
+        {
+            while (pointer != nullptr && inner::decrementReference(base(pointer).intrusiveCount) == 0)
+            {
+                T *next = inner::loadManaged<T>(base(pointer).forwardedTo);
+                delete pointer;
+                pointer = next;
+            }
+        }
+
+        // Moves this pointer to the end of its object's forwarding chain.
+        T *resolve() const noexcept
+        {
+            T *current = object;
+            if (current == nullptr)
+            {
+                return nullptr;
+            }
+
+            T *next = inner::loadManaged<T>(base(current).forwardedTo);
+            if (next == nullptr)
+            {
+                return current;
+            }
+            for (T *further = inner::loadManaged<T>(base(next).forwardedTo); further != nullptr;
+                 further = inner::loadManaged<T>(base(next).forwardedTo))
+            {
+                next = further;
+            }
+
+            // The chain keeps next alive while this pointer holds current.
+            inner::incrementReference(base(next).intrusiveCount);
+            object = next;
+            releaseObject(current);
+            return next;
+        }
+
+        // Forwards the current object to a replacement, which must not be
+        // referenced by anything yet.
+        void forward(T *replacement) noexcept
+        {
+            ASSERT(inner::loadReference(base(replacement).intrusiveCount) == 0);
+            // The reference held by the forwarding link.
+            inner::incrementReference(base(replacement).intrusiveCount);
+            T *current = resolve();
+            while (!inner::compareExchangeManaged<T>(base(current).forwardedTo, nullptr, replacement))
+            {
+                current = resolve();
+            }
+            resolve();
+        }
+
+    public:
+        /*
+            Constructs a pointer with no object.
+        */
+        constexpr IntrusiveMutablePtr() noexcept
+        {
+        }
+
+        /*
+            Constructs a pointer with no object.
+        */
+        constexpr IntrusiveMutablePtr(std::nullptr_t) noexcept
+        { // NOLINT
+        }
+
+        /*
+            Constructs a pointer sharing ownership of the given object. The
+            object may already be owned by other intrusive pointers.
+
+            @param pointer the object to take a reference to.
+        */
+        explicit IntrusiveMutablePtr(T *pointer) noexcept
+        {
+            static_assert(std::is_base_of<IntrusiveMutable<T>, T>::value,
+                          "IntrusiveMutablePtr objects must derive from IntrusiveMutable<T>");
+            object = pointer;
+            if (object != nullptr)
+            {
+                inner::incrementReference(base(object).intrusiveCount);
+            }
+        }
+
+        /*
+            Copy constructor. Shares the other pointer's object.
+
+            @param original the pointer to copy.
+        */
+        IntrusiveMutablePtr(const IntrusiveMutablePtr<T> &original) noexcept
+            : IntrusiveMutablePtr(original.object)
+        {
+        }
+
+        /*
+            Move constructor. Takes over the reference held by the original
+            pointer, leaving it empty, without touching the reference count.
+
+            @param original the pointer to move from.
+        */
+        IntrusiveMutablePtr(IntrusiveMutablePtr<T> &&original) noexcept
+        {
+            object = original.object;
+            original.object = nullptr;
+        }
+
+        /*
+            Copy assignment. Shares the other pointer's object, dropping the
+            reference to the current one.
+
+            @param other the pointer to copy.
+            @return reference to this pointer.
+        */
+        IntrusiveMutablePtr<T> &operator=(const IntrusiveMutablePtr<T> &other) noexcept
+        {
+            IntrusiveMutablePtr<T>(other).swap(*this);
+            return *this;
+        }
+
+        /*
+            Move assignment. Takes over the other pointer's reference, leaving
+            it empty, and drops the reference to the current object.
+
+            @param other the pointer to move from.
+            @return reference to this pointer.
+        */
+        IntrusiveMutablePtr<T> &operator=(IntrusiveMutablePtr<T> &&other) noexcept
+        {
+            IntrusiveMutablePtr<T>(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        /*
+            Destructor
+        */
+        ~IntrusiveMutablePtr()
+        {
+            releaseObject(object);
+        }
+
+        /*
+            Replaces the object for every pointer sharing it, like
+            IntrusivePtrMutator::mutate. An empty pointer takes a reference to
+            the new object instead.
+
+            @param pointer the replacement, not yet referenced by any pointer.
+        */
+        void reset(T *pointer) noexcept
+        {
+            if (object == nullptr)
+            {
+                IntrusiveMutablePtr<T>(pointer).swap(*this);
+                return;
+            }
+            ASSERT(pointer != nullptr);
+            if (pointer != nullptr)
+            {
+                forward(pointer);
+            }
+        }
+
+        /*
+            Swaps objects between this pointer and the given one.
+
+            @param other the pointer to swap with.
+        */
+        void swap(IntrusiveMutablePtr<T> // NOLINT
+                      &other) noexcept
+        {
+            std::swap(object, other.object);
+        }
+
+        /*
+            Gets the number of references to the current object. Pointers
+            which have not yet moved on from the object it replaced are
+            counted once, through the replaced object.
+
+            @return count of references, 0 for an empty pointer.
+        */
+        long useCount() const noexcept
+        {
+            T *current = resolve();
+            return current != nullptr ? inner::loadReference(base(current).intrusiveCount) : 0;
+        }
+
+        /*
+            Gets a pointer to the current object, following any mutation.
+
+            @return raw pointer to the object, valid until this pointer is
+            destroyed, reassigned or next dereferenced after a mutation.
+        */
+        T *get() const noexcept
+        {
+            return resolve();
+        }
+
+        /*
+            Checks whether there is an object being managed.
+
+            @return whether the pointer refers to an object.
+        */
+        explicit operator bool() const noexcept
+        {
+            return object != nullptr;
+        }
+
+        /*
+            Provides access to the current object, following any mutation.
+
+            @return l-value reference to the object.
+        */
+        T &operator*() const noexcept
+        {
+            ASSERT(object != nullptr);
+            return *resolve();
+        }
+
+        /*
+            Provides access to the current object, following any mutation.
+
+            @return pointer to the object.
+        */
+        T *operator->() const noexcept
+        {
+            ASSERT(object != nullptr);
+            return resolve();
+        }
+    };
+
+    /*
+        Creates an object and an intrusive pointer owning it.
+
+        @param args arguments forwarded to the constructor of T.
+        @return pointer owning the new object.
+    */
+    template <class T, class... Args>
+    IntrusiveMutablePtr<T> makeIntrusiveMutable(Args &&... args)
+    {
+        return IntrusiveMutablePtr<T>(new T(std::forward<Args>(args)...));
+    }
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INTRUSIVEMUTABLEPTR_HXX_
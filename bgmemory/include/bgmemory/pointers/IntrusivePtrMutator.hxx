@@ -0,0 +1,54 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INTRUSIVEPTRMUTATOR_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INTRUSIVEPTRMUTATOR_HXX_
+
+#include <utility>
+#include "bgmemory/pointers/IntrusiveMutablePtr.hxx"
+
+namespace bg
+{
+    /*
+        Hook for replacing the object shared by a set of IntrusiveMutablePtr
+        pointers, the intrusive counterpart of SharedPtrMutator.
+
+        Intrusive objects have no weak count, so unlike SharedPtrMutator the
+        mutator holds a reference and keeps the current object alive.
+    */
+    template <class T>
+    class IntrusivePtrMutator
+    {
+        IntrusiveMutablePtr<T> target;
+
+    public:
+        /*
+            Constructs a mutator for the object shared with the given pointer.
+
+            @param pointer pointer to the object to mutate.
+        */
+        explicit IntrusivePtrMutator(const IntrusiveMutablePtr<T> &pointer) noexcept
+            : target(pointer)
+        {
+        }
+
+        /*
+            Replaces the object for every pointer sharing it. Each pointer
+            moves onto the replacement the next time it is dereferenced; the
+            replaced object is destroyed once the last of them has moved on.
+
+            If the mutator has no object the replacement is deleted.
+
+            @param replacement the new object, not yet referenced by any pointer.
+        */
+        void mutate(T *replacement) noexcept
+        {
+            if (!target)
+            {
+                delete replacement;
+                return;
+            }
+            target.reset(replacement);
+        }
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INTRUSIVEPTRMUTATOR_HXX_
@@ -0,0 +1,370 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_POINTERS_MUTABLESHAREDARRAY_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_POINTERS_MUTABLESHAREDARRAY_HXX_
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "bgmemory/assert.hxx"
+#include "bgmemory/allocators/Allocator.hxx"
+#include "bgmemory/DefaultDeleter.hxx"
+#include "bgmemory/pointers/MutableSharedPtr.hxx"
+#include "bgmemory/pointers/inner/SharedPointerPayload.hxx"
+
+namespace bg
+{
+    namespace inner
+    {
+        // Return type of the array factories, only for arrays of unknown bound.
+        template <class T>
+        using ArrayShared = typename std::enable_if<std::is_array<T>::value && std::extent<T>::value == 0,
+                                                    MutableSharedPtr<T>>::type;
+    } // namespace inner
+
+    template <class T>
+    inner::ArrayShared<T> allocateMutableShared(Allocator &allocator, size_t count);
+
+    /*
+        Shared pointer to a contiguous array of T, for large buffers (vertex
+        data, particle arrays) which need shared ownership and may be
+        relocated as a whole through a SharedPtrMutator<T[]>.
+
+        Each pointer is a view of a range of elements in the buffer. The
+        aliasing constructor makes a view of part of another view which shares
+        its metadata, so any number of views into one buffer cost a single
+        payload. Views store their range as an element offset rather than an
+        address, so when the buffer is mutated every view follows into the new
+        buffer at the same offset.
+
+        Arrays passed in by pointer must come from new[] unless a deleter is
+        given; the default deleter calls delete[]. Deleters for arrays are
+        called with a pointer to the first element of the whole buffer.
+
+        Thread safety is as for MutableSharedPtr. In multithreaded mode hold
+        an EpochGuard while using elements if the buffer may be mutated
+        concurrently.
+    */
+    template <class T>
+    class MutableSharedPtr<T[]>
+    {
+        inner::SharedPointerPayload<T> *payload = nullptr;
+        // Index of this view's first element within the buffer.
+        size_t offset = 0;
+        // Number of elements in this view.
+        size_t count = 0;
+        friend class SharedPtrMutator<T[]>;
+
+        template <class U>
+        friend inner::ArrayShared<U> allocateMutableShared(Allocator &allocator, size_t count);
+
+        // Adopts a payload which already accounts for this reference.
+        static MutableSharedPtr<T[]> adopt(inner::SharedPointerPayload<T> *p, size_t n) noexcept
+        {
+            MutableSharedPtr<T[]> pointer;
+            pointer.payload = p;
+            pointer.count = n;
+            return pointer;
+        }
+
+        // Drops this reference, cleaning up the buffer and payload if it was the last.
+        void release() noexcept
+        {
+            if (payload != nullptr)
+            {
+                payload->releaseShared();
+            }
+        }
+
+    public:
+        /*
+            Constructs a shared array with no buffer. Empty pointers have no
+            payload and never allocate.
+        */
+        constexpr MutableSharedPtr() noexcept
+        {
+        }
+
+        /*
+            Constructs a shared array with no buffer. Empty pointers have no
+            payload and never allocate.
+        */
+        constexpr MutableSharedPtr(std::nullptr_t) noexcept
+        { // NOLINT
+        }
+
+        /*
+            Constructs a shared array which takes ownership of a buffer
+            allocated with new[].
+
+            @param pointer the first element of the buffer.
+            @param n number of elements in the buffer.
+        */
+        MutableSharedPtr(T *pointer, size_t n) noexcept
+        {
+            payload = new inner::DeleterPayload<T, DefaultDeleter<T[]>>();
+            payload->managedObject = pointer;
+            count = n;
+        }
+
+        /*
+            Constructs a shared array which takes ownership of a buffer,
+            cleaning it up with the given deleter.
+
+            The deleter is stored inline in the pointer metadata. If the
+            metadata cannot be allocated the buffer is cleaned up with the
+            deleter before the exception propagates.
+
+            @param pointer the first element of the buffer.
+            @param n number of elements in the buffer.
+            @param d deleter callable with a T*, bg::Deleter<T> implementation or otherwise.
+            @throws std::bad_alloc if the metadata cannot be allocated.
+        */
+        template <class DeleterT>
+        MutableSharedPtr(T *pointer, size_t n, DeleterT d)
+        {
+            using Stored = inner::InlineDeleter<T, DeleterT>;
+            try
+            {
+                payload = new inner::DeleterPayload<T, Stored>(std::move(d));
+            }
+            catch (...)
+            {
+                d(pointer);
+                throw;
+            }
+            payload->managedObject = pointer;
+            count = n;
+        }
+
+        /*
+            Aliasing constructor. Constructs a view of part of another view,
+            sharing its metadata and keeping the whole buffer alive. No memory
+            is allocated.
+
+            @param owner the view to take a range of.
+            @param first index of the view's first element within owner.
+            @param n number of elements in the view.
+        */
+        MutableSharedPtr(const MutableSharedPtr<T[]> &owner, size_t first, size_t n) noexcept
+            : MutableSharedPtr(owner)
+        {
+            ASSERT(first <= owner.count && n <= owner.count - first);
+            offset += first;
+            count = n;
+        }
+
+        /*
+            Copy constructor. Constructs a view of the same range, sharing the
+            original's metadata and incrementing the pointer count.
+
+            @param original the pointer to copy.
+        */
+        MutableSharedPtr(const MutableSharedPtr<T[]> &original) noexcept
+        {
+            payload = original.payload;
+            offset = original.offset;
+            count = original.count;
+            if (payload != nullptr)
+            {
+                inner::incrementReference(payload->count);
+            }
+        }
+
+        /*
+            Move constructor. Takes over the reference held by the original
+            pointer, leaving it empty, without touching the reference counts.
+
+            @param original the pointer to move from.
+        */
+        MutableSharedPtr(MutableSharedPtr<T[]> &&original) noexcept
+        {
+            payload = original.payload;
+            offset = original.offset;
+            count = original.count;
+            original.payload = nullptr;
+            original.offset = 0;
+            original.count = 0;
+        }
+
+        /*
+            Copy assignment. Shares the other pointer's buffer and range,
+            dropping the reference to the current one.
+
+            @param other the pointer to copy.
+            @return reference to this pointer.
+        */
+        MutableSharedPtr<T[]> &operator=(const MutableSharedPtr<T[]> &other) noexcept
+        {
+            MutableSharedPtr<T[]>(other).swap(*this);
+            return *this;
+        }
+
+        /*
+            Move assignment. Takes over the other pointer's reference, leaving
+            it empty, and drops the reference to the current buffer.
+
+            @param other the pointer to move from.
+            @return reference to this pointer.
+        */
+        MutableSharedPtr<T[]> &operator=(MutableSharedPtr<T[]> &&other) noexcept
+        {
+            MutableSharedPtr<T[]>(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        /*
+            Destructor
+        */
+        ~MutableSharedPtr()
+        {
+            release();
+        }
+
+        /*
+            Swaps buffers and ranges between this instance and the given one.
+
+            @param other the instance of the shared array to swap with.
+        */
+        void swap(MutableSharedPtr<T[]> // NOLINT
+                      &other) noexcept
+        {
+            std::swap(payload, other.payload);
+            std::swap(offset, other.offset);
+            std::swap(count, other.count);
+        }
+
+        /*
+            Gets the current count of pointers and views sharing the buffer,
+            including the current one. If no buffer is being managed, returns 0.
+
+            @return count of shared pointers referring to this buffer.
+        */
+        long useCount() const noexcept
+        {
+            return payload != nullptr && inner::loadManaged<T>(payload->managedObject) != nullptr
+                       ? inner::loadReference(payload->count)
+                       : 0;
+        }
+
+        /*
+            Gets a pointer to the first element of this view.
+
+            As with MutableSharedPtr::get, in multithreaded mode the pointer is
+            only safe to use under an EpochGuard if the buffer may be mutated
+            concurrently.
+
+            @return raw pointer to the first element, or nullptr if there is no buffer.
+        */
+        T *get() const noexcept
+        {
+            T *buffer = payload != nullptr ? inner::loadManaged<T>(payload->managedObject) : nullptr;
+            return buffer != nullptr ? buffer + offset : nullptr;
+        }
+
+        /*
+            Gets the number of elements in this view.
+
+            @return count of elements.
+        */
+        size_t size() const noexcept
+        {
+            return count;
+        }
+
+        /*
+            Gets a reference to the deleter cleaning up the buffer.
+
+            @return reference to the defined deleter.
+        */
+        Deleter<T> &getDeleter() noexcept
+        {
+            return payload != nullptr ? payload->getDeleter() : inner::sharedDefaultDeleter<T[]>();
+        }
+
+        /*
+            Gets a constant reference to the deleter cleaning up the buffer.
+
+            @return constant reference to the defined deleter.
+        */
+        const Deleter<T> &getDeleter() const noexcept
+        {
+            return payload != nullptr ? payload->getDeleter() : inner::sharedDefaultDeleter<T[]>();
+        }
+
+        /*
+            Checks whether there is a buffer being managed.
+
+            @return whether there is a buffer being managed.
+        */
+        explicit operator bool() const noexcept
+        {
+            return payload != nullptr && inner::loadManaged<T>(payload->managedObject) != nullptr;
+        }
+
+        /*
+            Provides access to an element of this view.
+
+            @param index index of the element within the view, below size().
+            @return l-value reference to the element.
+        */
+        T &operator[](size_t index) const
+        {
+            ASSERT(payload != nullptr && index < count);
+            return inner::loadManaged<T>(payload->managedObject)[offset + index];
+        }
+    };
+
+    /*
+        Creates a value initialised array and a shared pointer managing it in
+        a single allocation drawn from the given allocator, with the pointer
+        metadata placed directly before the elements.
+
+        @param allocator allocator to draw the memory from, must outlive the pointer.
+        @param count number of elements in the array.
+        @return a shared array owning the new elements.
+        @throws std::bad_alloc if the allocator cannot provide the memory.
+    */
+    template <class T>
+    inner::ArrayShared<T> allocateMutableShared(Allocator &allocator, size_t count)
+    {
+        using Element = typename std::remove_extent<T>::type;
+        using Payload = inner::InplaceArrayPayload<Element>;
+        const size_t size = Payload::allocationSize(count);
+        void *memory = allocator.allocate(size, Payload::allocationAlignment());
+        if (memory == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        Payload *payload;
+        try
+        {
+            payload = new (memory) Payload(&allocator, count);
+        }
+        catch (...)
+        {
+            allocator.deallocate(memory, size, Payload::allocationAlignment());
+            throw;
+        }
+        BG_MEMORY_TRACK_ALLOCATION(inner::inplaceTracker(), size);
+        return MutableSharedPtr<T>::adopt(payload, count);
+    }
+
+    /*
+        Creates a value initialised array and a shared pointer managing it in
+        a single allocation from the default allocator, the MutableSharedPtr
+        version of std::make_shared<T[]>.
+
+        @param count number of elements in the array.
+        @return a shared array owning the new elements.
+        @throws std::bad_alloc if the memory cannot be allocated.
+    */
+    template <class T>
+    inner::ArrayShared<T> makeMutableShared(size_t count)
+    {
+        return allocateMutableShared<T>(defaultAllocator(), count);
+    }
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POINTERS_MUTABLESHAREDARRAY_HXX_
@@ -3,16 +3,15 @@
 #define BGMEMORY_INCLUDE_BGMEMORY_POINTERS_MUTABLESHAREDPTR_HXX_
 
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "bgmemory/assert.hxx"
+#include "bgmemory/allocators/Allocator.hxx"
 #include "bgmemory/pointers/Deleter.hxx"
 #include "bgmemory/DefaultDeleter.hxx"
 #include "bgmemory/pointers/inner/SharedPointerPayload.hxx"
 
-#ifdef BG_MEMORY_MULTITHREAD
-
-#endif // BG_MEMORY_MULTITHREAD
-
-// TODO: Allow for specialized allocators so metadata isn't allocated on the stack
-
 namespace bg
 {
     // Forward Declarations
@@ -22,6 +21,20 @@ namespace bg
     template <class T>
     class MutableWeakPtr;
 
+    template <class T>
+    class MutableSharedPtr;
+
+    namespace inner
+    {
+        // Return type of the single object factories, which take no part in
+        // overload resolution for arrays.
+        template <class T>
+        using NonArrayShared = typename std::enable_if<!std::is_array<T>::value, MutableSharedPtr<T>>::type;
+    } // namespace inner
+
+    template <class T, class... Args>
+    inner::NonArrayShared<T> allocateMutableShared(Allocator &allocator, Args &&... args);
+
     /*
         Shared pointer class, to be used as a drop in replacement for the
         standard library shared_ptr. The main difference is the ability
@@ -39,15 +52,27 @@ namespace bg
         but the standard implementation is far better tested, and likely
         simply better. Use this implementation only if you have a good reason.
 
-        Deleters may be provided via the deleter interface. The current implementation
-        uses a pointer, and will clean up the pointer for you.
-
-        When BG_MEMORY_MULTITHREAD is defined the pointer will start using mutex
-        locks around assignments/deletions/reads. As with all smart pointers, there is
-        no guarantee of thread safety with the stored object in memory. Any
-        reference counting and deletion will be thread safe. The object will only be
-        deleted once, and references will be atomically decremented and incremented.
-        No other guarantees are made.
+        Pointer metadata is drawn from a pooled, thread cached allocator rather
+        than the global heap, except for makeMutableShared and
+        allocateMutableShared which place it next to the object.
+
+        Deleters may be any callable taking a T*, including lambdas and
+        implementations of the deleter interface. Deleters passed by value are
+        stored inline in the pointer metadata and cost no extra allocation.
+        Deleters passed by pointer are still supported; the pointer takes
+        ownership and will clean up the deleter for you.
+
+        When BG_MEMORY_MULTITHREAD is defined the reference counts become lock
+        free atomics. As with all smart pointers, there is no guarantee of thread
+        safety with the stored object in memory, nor for a single pointer instance
+        shared between threads. Any reference counting and deletion will be thread
+        safe. The object will only be deleted once, and references will be
+        atomically decremented and incremented. No other guarantees are made.
+
+        Unlike shared_ptr there is no conversion from a pointer to a derived
+        type. Every copy shares one managed object slot which any of them may
+        mutate, so a Base pointer to a Derived object could install a plain
+        Base which the Derived pointers would then read as a Derived.
     */
     template <class T>
     class MutableSharedPtr
@@ -56,23 +81,39 @@ namespace bg
         friend class SharedPtrMutator<T>;
         friend class MutableWeakPtr<T>;
 
+        template <class U, class... Args>
+        friend inner::NonArrayShared<U> allocateMutableShared(Allocator &allocator, Args &&... args);
+
+        // Adopts a payload which already accounts for this reference.
+        explicit MutableSharedPtr(inner::SharedPointerPayload<T> *p) noexcept
+        {
+            payload = p;
+        }
+
+        // Drops this reference, cleaning up the object and payload if it was the last.
+        void release() noexcept
+        {
+            if (payload != nullptr)
+            {
+                payload->releaseShared();
+            }
+        }
+
     public:
         /*
-            Constructs a shared pointer with no owned object.
+            Constructs a shared pointer with no owned object. Empty pointers
+            have no payload and never allocate.
         */
-        MutableSharedPtr()
+        constexpr MutableSharedPtr() noexcept
         {
-            payload = new inner::SharedPointerPayload<T>();
-            payload->count++;
         }
 
         /*
-            Constructs a shared pointer with no owned object.
+            Constructs a shared pointer with no owned object. Empty pointers
+            have no payload and never allocate.
         */
         constexpr MutableSharedPtr(std::nullptr_t) noexcept
         { // NOLINT
-            payload = new inner::SharedPointerPayload<T>();
-            payload->count++;
         }
 
         /*
@@ -83,9 +124,39 @@ namespace bg
         */
         explicit MutableSharedPtr(T *pointer) noexcept
         {
-            payload = new inner::SharedPointerPayload<T>();
+            payload = new inner::DeleterPayload<T>();
+            payload->managedObject = pointer;
+        }
+
+        /*
+            Constructs a shared pointer which takes ownership of the pointer
+            passed to it, cleaning it up with the given deleter.
+
+            The deleter is stored inline in the pointer metadata. If the metadata
+            cannot be allocated the pointer is cleaned up with the deleter before
+            the exception propagates.
+
+            @param pointer the pointer to take ownership of.
+            @param d deleter callable with a T*, bg::Deleter implementation or otherwise.
+            @throws std::bad_alloc if the metadata cannot be allocated.
+        */
+        template <class DeleterT,
+                  class = typename std::enable_if<
+                      !std::is_base_of<Deleter<T>, typename std::remove_pointer<DeleterT>::type>::value ||
+                      !std::is_pointer<DeleterT>::value>::type>
+        MutableSharedPtr(T *pointer, DeleterT d)
+        {
+            using Stored = inner::InlineDeleter<T, DeleterT>;
+            try
+            {
+                payload = new inner::DeleterPayload<T, Stored>(std::move(d));
+            }
+            catch (...)
+            {
+                d(pointer);
+                throw;
+            }
             payload->managedObject = pointer;
-            payload->count++;
         }
 
         /*
@@ -96,15 +167,17 @@ namespace bg
             DeleterT must be of type bg::Deleter
             Cleanup of deleter will be handled by the pointer
 
+            Prefer passing the deleter by value, which avoids allocating it.
+
             @param pointer the pointer to take ownership of.
             @param d a reference to an instance of the deleter.
         */
-        template <class DeleterT>
+        template <class DeleterT,
+                  class = typename std::enable_if<std::is_base_of<Deleter<T>, DeleterT>::value>::type>
         MutableSharedPtr(T *pointer, DeleterT *d) noexcept
         {
-            payload = new inner::SharedPointerPayload<T>(d);
+            payload = new inner::HeapDeleterPayload<T>(d);
             payload->managedObject = pointer;
-            payload->count++;
         }
 
         /*
@@ -114,37 +187,88 @@ namespace bg
             
             @param original the pointer to copy.
         */
-        MutableSharedPtr(const MutableSharedPtr<T> &original)
+        MutableSharedPtr(const MutableSharedPtr<T> &original) noexcept
         {
             payload = original.payload;
-            payload->count++;
-        };
+            if (payload != nullptr)
+            {
+                inner::incrementReference(payload->count);
+            }
+        }
+
+        /*
+            Move constructor. Takes over the reference held by the original
+            pointer, leaving it empty, without touching the reference counts.
+
+            @param original the pointer to move from.
+        */
+        MutableSharedPtr(MutableSharedPtr<T> &&original) noexcept
+        {
+            payload = original.payload;
+            original.payload = nullptr;
+        }
+
+        /*
+            Copy assignment. Shares the other pointer's object, dropping the
+            reference to the current one.
+
+            @param other the pointer to copy.
+            @return reference to this pointer.
+        */
+        MutableSharedPtr<T> &operator=(const MutableSharedPtr<T> &other) noexcept
+        {
+            MutableSharedPtr<T>(other).swap(*this);
+            return *this;
+        }
+
+        /*
+            Move assignment. Takes over the other pointer's reference, leaving it
+            empty, and drops the reference to the current object.
+
+            @param other the pointer to move from.
+            @return reference to this pointer.
+        */
+        MutableSharedPtr<T> &operator=(MutableSharedPtr<T> &&other) noexcept
+        {
+            MutableSharedPtr<T>(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        // No converting construction or assignment, see the class comment.
+        template <class U>
+        MutableSharedPtr(const MutableSharedPtr<U> &) = delete;
+        template <class U>
+        MutableSharedPtr<T> &operator=(const MutableSharedPtr<U> &) = delete;
 
         /*
             Destructor
         */
         ~MutableSharedPtr()
         {
-            payload->count--;
-            if (payload->count < 1)
-            {
-                (*payload->deleter)(payload->managedObject);
-                if (payload->weakCount < 1)
-                {
-                    delete payload;
-                }
-            }
+            release();
         }
 
         /*
-            Replaces the managed object, cleaning up the previous pointer.
+            Replaces the managed object, cleaning up the previous pointer. Like
+            SharedPtrMutator::mutate this affects every pointer sharing the object.
+
+            An empty pointer allocates a payload to take ownership of ptr.
 
             @param ptr pointer to the object to take ownership of.
         */
-        void reset(T *ptr) noexcept
+        void reset(T *ptr)
         {
-            (*payload->deleter)(payload->managedObject);
-            payload->managedObject = ptr;
+            if (payload == nullptr)
+            {
+                if (ptr != nullptr)
+                {
+                    payload = new inner::DeleterPayload<T>();
+                    payload->managedObject = ptr;
+                }
+                return;
+            }
+
+            payload->replace(ptr);
         }
 
         /*
@@ -169,17 +293,23 @@ namespace bg
         */
         long useCount() const noexcept
         {
-            return payload->managedObject != nullptr ? payload->count : 0;
+            return payload != nullptr && inner::loadManaged<T>(payload->managedObject) != nullptr
+                       ? inner::loadReference(payload->count)
+                       : 0;
         }
 
         /*
             Gets a pointer to the managed object.
 
+            When BG_MEMORY_MULTITHREAD is defined and the object may be mutated
+            concurrently, the returned pointer is only safe to use while an
+            EpochGuard is held on the calling thread.
+
             @return raw pointer to the managed object.
         */
         T *get() const noexcept
         {
-            return payload->managedObject;
+            return payload != nullptr ? inner::loadManaged<T>(payload->managedObject) : nullptr;
         }
 
         /*
@@ -189,7 +319,7 @@ namespace bg
         */
         Deleter<T> &getDeleter() noexcept
         {
-            return *payload->deleter;
+            return payload != nullptr ? payload->getDeleter() : inner::sharedDefaultDeleter<T>();
         }
 
         /*
@@ -200,7 +330,7 @@ namespace bg
         */
         const Deleter<T> &getDeleter() const noexcept
         {
-            return *payload->deleter;
+            return payload != nullptr ? payload->getDeleter() : inner::sharedDefaultDeleter<T>();
         }
 
         /*
@@ -211,7 +341,7 @@ namespace bg
         */
         explicit operator bool() const noexcept
         {
-            return payload->managedObject != nullptr;
+            return payload != nullptr && inner::loadManaged<T>(payload->managedObject) != nullptr;
         }
 
         /*
@@ -221,11 +351,15 @@ namespace bg
             If underlying memory is released or uninitialized the results
             of this function are undefined, like accessing uninitialized memory.
 
+            As with get(), in multithreaded mode hold an EpochGuard while using
+            the reference if the object may be mutated concurrently.
+
             @return l-value reference to the underlying memory.
         */
         typename std::add_lvalue_reference<T>::type operator*() const
         {
-            return *payload->managedObject;
+            ASSERT(payload != nullptr);
+            return *inner::loadManaged<T>(payload->managedObject);
         }
 
         /*
@@ -235,14 +369,82 @@ namespace bg
             If underlying memory is released or uninitialized the results
             of this function are undefined, like accessing uninitialized memory.
 
+            In multithreaded mode this returns a guard object which keeps the
+            object from being reclaimed until the end of the full expression,
+            so p->method() is safe against a concurrent mutate.
+
             @return reference to the underlying memory.
         */
+#ifdef BG_MEMORY_MULTITHREAD
+        inner::GuardedPointer<T> operator->() const noexcept
+        {
+            ASSERT(payload != nullptr);
+            return {payload->managedObject};
+        }
+#else
         T *operator->() const noexcept
         {
-            return payload->managedObject;
+            ASSERT(payload != nullptr);
+            return inner::loadManaged<T>(payload->managedObject);
         }
+#endif // BG_MEMORY_MULTITHREAD
     };
 
+    /*
+        Creates an object and a shared pointer managing it in a single
+        allocation drawn from the given allocator, with the pointer metadata and
+        the object placed side by side. No deleter is allocated; the object is
+        destroyed in place once the last shared pointer releases it, and the
+        memory is returned to the allocator once the last weak reference goes.
+
+        @param allocator allocator to draw the memory from, must outlive the pointer.
+        @param args arguments forwarded to the constructor of T.
+        @return a shared pointer owning the new object.
+        @throws std::bad_alloc if the allocator cannot provide the memory.
+    */
+    template <class T, class... Args>
+    inner::NonArrayShared<T> allocateMutableShared(Allocator &allocator, Args &&... args)
+    {
+        using Payload = inner::InplacePayload<T>;
+        void *memory = allocator.allocate(sizeof(Payload), alignof(Payload));
+        if (memory == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        Payload *payload;
+        try
+        {
+            payload = new (memory) Payload(&allocator, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            allocator.deallocate(memory, sizeof(Payload), alignof(Payload));
+            throw;
+        }
+        BG_MEMORY_TRACK_ALLOCATION(inner::inplaceTracker(), sizeof(Payload));
+        return MutableSharedPtr<T>(payload);
+    }
+
+    /*
+        Creates an object and a shared pointer managing it in a single
+        allocation from the default allocator, the MutableSharedPtr version of
+        std::make_shared.
+
+        @param args arguments forwarded to the constructor of T.
+        @return a shared pointer owning the new object.
+        @throws std::bad_alloc if the memory cannot be allocated.
+    */
+    template <class T, class... Args>
+    inner::NonArrayShared<T> makeMutableShared(Args &&... args)
+    {
+        return allocateMutableShared<T>(defaultAllocator(), std::forward<Args>(args)...);
+    }
+
 } // namespace bg
 
+// The T[] specialization, so shared arrays are available wherever
+// MutableSharedPtr is.
+#include "bgmemory/pointers/MutableSharedArray.hxx"
+
 #endif // BGMEMORY_INCLUDE_BGMEMORY_POINTERS_MUTABLESHAREDPTR_HXX_
\ No newline at end of file
@@ -3,14 +3,11 @@
 #define BGMEMORY_INCLUDE_BGMEMORY_POINTERS_MUTABLEWEAKPTR_HXX_
 
 #include <memory>
+#include <utility>
 #include "bgmemory/pointers/inner/SharedPointerPayload.hxx"
 #include "bgmemory/pointers/MutableSharedPtr.hxx"
 #include "bgmemory/DefaultDeleter.hxx"
 
-#ifdef BG_MEMORY_MULTITHREAD
-
-#endif // BG_MEMORY_MULTITHREAD
-
 namespace bg
 {
     // Forward Declarations
@@ -33,10 +30,11 @@ namespace bg
         but the standard implementation is far better tested, and likely
         simply better. Use this implementation only if you have a good reason.
 
-        When BG_MEMORY_MULTITHREAD is defined the pointer will start using mutex
-        locks around assignments and deletion. As with all smart pointers, there is
-        no guarantee of thread safety with the stored object in memory. Any
-        reference counting and deletion will be thread safe. The object will only be
+        When BG_MEMORY_MULTITHREAD is defined the reference counts become lock
+        free atomics and lock() uses compare and swap. As with all smart pointers,
+        there is no guarantee of thread safety with the stored object in memory,
+        nor for a single pointer instance shared between threads. Any reference
+        counting and deletion will be thread safe. The object will only be
         deleted once, and references will be atomically decremented and incremented.
         No other guarantees are made.
     */
@@ -46,13 +44,32 @@ namespace bg
         inner::SharedPointerPayload<T> *payload = nullptr;
         friend class SharedPtrMutator<T>;
 
+        // Takes a weak reference on the given payload, if any.
+        void acquire(inner::SharedPointerPayload<T> *p) noexcept
+        {
+            payload = p;
+            if (payload != nullptr)
+            {
+                inner::incrementReference(payload->weakCount);
+            }
+        }
+
+        // Drops the weak reference, cleaning up the payload if it was the last reference.
+        void release() noexcept
+        {
+            if (payload != nullptr)
+            {
+                payload->releaseWeak();
+            }
+        }
+
     public:
         /*
-            Constructs a weak pointer with no object.
+            Constructs a weak pointer with no object. Empty pointers have no
+            payload and never allocate.
         */
         constexpr MutableWeakPtr() noexcept
         { // NOLINT
-            payload = new inner::SharedPointerPayload<T>();
         }
 
         /*
@@ -62,8 +79,7 @@ namespace bg
         */
         MutableWeakPtr(const MutableWeakPtr<T> &r) noexcept
         {
-            payload = r.payload;
-            payload->weakCount++;
+            acquire(r.payload);
         }
 
         /*
@@ -73,19 +89,19 @@ namespace bg
         */
         MutableWeakPtr(const MutableSharedPtr<T> &r) noexcept
         {
-            payload = r.payload;
-            payload->weakCount++;
+            acquire(r.payload);
         }
 
         /*
-            Constructs a weak pointer copying from another weak pointer.
+            Constructs a weak pointer moving from another weak pointer. Takes
+            over its reference, leaving it empty, without touching the counts.
 
-            @param r weak pointer to copy from
+            @param r weak pointer to move from
         */
         MutableWeakPtr(MutableWeakPtr<T> &&r) noexcept
         {
             payload = r.payload;
-            payload->weakCount++;
+            r.payload = nullptr;
         }
 
         /*
@@ -93,50 +109,53 @@ namespace bg
         */
         ~MutableWeakPtr()
         {
-            payload->weakCount--;
-            if (payload->count < 1 && payload->weakCount < 1)
-            {
-                delete payload;
-            }
+            release();
         }
 
         /*
             Assignment Operator from a shared pointer
 
             @param p a shared pointer you would like to copy into the weak pointer
+            @return reference to this pointer.
         */
-        void operator=(const MutableSharedPtr<T> &p)
+        MutableWeakPtr<T> &operator=(const MutableSharedPtr<T> &p) noexcept
         {
-            reset();
-            payload = p.payload;
-            payload->weakCount++;
+            MutableWeakPtr<T>(p).swap(*this);
+            return *this;
         }
 
         /*
             Assignment Operator from a weak pointer
 
             @param p a weak pointer you would like to copy
+            @return reference to this pointer.
         */
-        void operator=(const MutableWeakPtr<T> &p)
+        MutableWeakPtr<T> &operator=(const MutableWeakPtr<T> &p) noexcept
         {
-            reset();
-            payload = p.payload;
-            payload->weakCount++;
+            MutableWeakPtr<T>(p).swap(*this);
+            return *this;
         }
 
         /*
-            Replaces the managed object.
+            Move assignment. Takes over the other pointer's reference, leaving
+            it empty, without touching the counts of the new object.
 
-            @param ptr pointer to the object to take ownership of.
+            @param p a weak pointer to move from
+            @return reference to this pointer.
+        */
+        MutableWeakPtr<T> &operator=(MutableWeakPtr<T> &&p) noexcept
+        {
+            MutableWeakPtr<T>(std::move(p)).swap(*this);
+            return *this;
+        }
+
+        /*
+            Releases the reference to the managed object, leaving the pointer empty.
         */
         void reset() noexcept
         {
-            payload->weakCount--;
-            if (payload->count < 1 && payload->weakCount < 1)
-            {
-                delete payload;
-            }
-            payload->managedObject = nullptr;
+            release();
+            payload = nullptr;
         }
 
         /*
@@ -161,7 +180,9 @@ namespace bg
         */
         long useCount() const noexcept
         {
-            return payload->managedObject != nullptr ? payload->count : 0;
+            return payload != nullptr && inner::loadManaged<T>(payload->managedObject) != nullptr
+                       ? inner::loadReference(payload->count)
+                       : 0;
         }
 
         /*
@@ -171,27 +192,28 @@ namespace bg
         */
         bool expired() const noexcept
         {
-            return payload->count == 0;
+            return payload == nullptr || inner::loadReference(payload->count) < 1;
         }
 
         /*
             Attempts to lock the pointer checking whether it is expired and either
             returning a new shared pointer with a reference to the object or a blank
-            shared pointer accordingly.
+            shared pointer accordingly. Locking an expired pointer does not allocate.
+
+            The count is only incremented if it has not already dropped to zero,
+            so a lock racing the release of the last shared pointer either wins
+            and keeps the object alive, or fails and returns a blank pointer.
 
             @return a shared pointer to the object if it isn't expired, else a blank shared pointer.
         */
         MutableSharedPtr<T> lock() const noexcept
         {
-            auto ptr = MutableSharedPtr<T>();
-            if (expired())
+            if (payload == nullptr || !inner::incrementReferenceIfNotZero(payload->count))
             {
-                return ptr;
+                return MutableSharedPtr<T>();
             }
 
-            ptr.payload = payload;
-            payload->count++;
-            return ptr;
+            return MutableSharedPtr<T>(payload);
         }
     };
 } // namespace bg
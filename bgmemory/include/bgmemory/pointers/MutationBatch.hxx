@@ -0,0 +1,334 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_POINTERS_MUTATIONBATCH_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_POINTERS_MUTATIONBATCH_HXX_
+
+#include <stddef.h>
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <vector>
+#include "bgmemory/pointers/inner/SharedPointerPayload.hxx"
+#include "bgmemory/pointers/SharedPtrMutator.hxx"
+
+#ifdef BG_MEMORY_MULTITHREAD
+#include "bgmemory/reclamation/EpochReclamation.hxx"
+#endif // BG_MEMORY_MULTITHREAD
+
+namespace bg
+{
+    /*
+        Collects many mutations and applies them together, for relocating
+        large numbers of objects such as during defragmentation.
+
+        Each mutation queued with add or relocate holds a shared reference to
+        its object until the batch is committed. Committing first retargets
+        every pointer, then cleans up all the replaced objects in one pass:
+        either through their own deleters, or handed over all at once to a
+        recycle function which can free their storage in bulk.
+
+        Batching widens the window a mutation is in flight: every pointer
+        keeps referring to its old object until the commit, so a write made
+        through one after the object was relocated is lost with the old
+        object. Callers must keep other threads from writing to queued objects
+        until the batch is committed.
+
+        When BG_MEMORY_MULTITHREAD is defined the replaced objects are retired
+        as a single entry, so the whole batch waits on one epoch rather than
+        one per object. Should the retire entry not be allocatable the commit
+        instead waits for readers and cleans up straight away, so committing
+        never fails once pointers have been retargeted.
+
+        Mutations still queued when the batch is destroyed are committed. The
+        batch is not thread safe; use one per thread.
+    */
+    template <class T>
+    class MutationBatch
+    {
+        using Payload = inner::SharedPointerPayload<T>;
+
+        // Queued payloads, each holding a shared reference taken by add.
+        std::vector<Payload *> payloads;
+
+        // Replacement objects until commit, then the objects they replaced.
+        std::vector<T *> objects;
+
+        // Cleans up replaced objects through their payloads' deleters.
+        struct DisposeEach
+        {
+            void operator()(std::vector<Payload *> &p, std::vector<T *> &o) const noexcept
+            {
+                for (size_t i = 0; i < o.size(); i++)
+                {
+                    if (o[i] != nullptr)
+                    {
+                        p[i]->dispose(o[i]);
+                    }
+                }
+            }
+        };
+
+        // Hands every non null replaced object to a recycle function at once.
+        template <class F>
+        struct RecycleAll
+        {
+            F recycle;
+
+            void operator()(std::vector<Payload *> &, std::vector<T *> &o)
+            {
+                o.erase(std::remove(o.begin(), o.end(), nullptr), o.end());
+                if (!o.empty())
+                {
+                    recycle(o.data(), o.size());
+                }
+            }
+        };
+
+#ifdef BG_MEMORY_MULTITHREAD
+        // A committed batch waiting for readers to leave its replaced objects.
+        template <class CleanupT>
+        struct RetiredBatch
+        {
+            std::vector<Payload *> payloads;
+            std::vector<T *> objects;
+            CleanupT cleanup;
+
+            static void reclaim(void *object, void *) noexcept
+            {
+                auto batch = static_cast<RetiredBatch *>(object);
+                batch->cleanup(batch->payloads, batch->objects);
+                for (auto payload : batch->payloads)
+                {
+                    payload->releaseWeak();
+                }
+                delete batch;
+            }
+        };
+#endif // BG_MEMORY_MULTITHREAD
+
+        // Makes room for one more mutation, so queueing it cannot throw.
+        void makeRoom()
+        {
+            if (payloads.size() == payloads.capacity())
+            {
+                const size_t grown = payloads.empty() ? 16 : payloads.size() * 2;
+                payloads.reserve(grown);
+                objects.reserve(grown);
+            }
+        }
+
+        template <class CleanupT>
+        void apply(CleanupT &&cleanup)
+        {
+            if (payloads.empty())
+            {
+                return;
+            }
+
+#ifdef BG_MEMORY_MULTITHREAD
+            // Allocated before any pointer is retargeted, so a failure here
+            // leaves nothing half applied.
+            using Retired = RetiredBatch<typename std::decay<CleanupT>::type>;
+            auto batch = new (std::nothrow) Retired{{}, {}, cleanup};
+#endif // BG_MEMORY_MULTITHREAD
+
+            for (size_t i = 0; i < payloads.size(); i++)
+            {
+                objects[i] = payloads[i]->exchange(objects[i]);
+            }
+
+#ifdef BG_MEMORY_MULTITHREAD
+            // Trade each shared reference for a weak one, so the payloads
+            // outlive the retired objects without keeping the new ones alive.
+            for (auto payload : payloads)
+            {
+                inner::incrementReference(payload->weakCount);
+                payload->releaseShared();
+            }
+            if (batch != nullptr)
+            {
+                batch->payloads.swap(payloads);
+                batch->objects.swap(objects);
+                try
+                {
+                    retire(batch, &Retired::reclaim, nullptr);
+                    return;
+                }
+                catch (...)
+                {
+                    batch->payloads.swap(payloads);
+                    batch->objects.swap(objects);
+                    delete batch;
+                }
+            }
+            // No retire entry, so wait out every reader instead.
+            synchronizeRetired();
+            cleanup(payloads, objects);
+            for (auto payload : payloads)
+            {
+                payload->releaseWeak();
+            }
+#else
+            cleanup(payloads, objects);
+            for (auto payload : payloads)
+            {
+                payload->releaseShared();
+            }
+#endif // BG_MEMORY_MULTITHREAD
+            payloads.clear();
+            objects.clear();
+        }
+
+    public:
+        MutationBatch() = default;
+
+        /*
+            Constructs a batch with room reserved for the given number of
+            mutations.
+
+            @param expected number of mutations expected.
+        */
+        explicit MutationBatch(size_t expected)
+        {
+            payloads.reserve(expected);
+            objects.reserve(expected);
+        }
+
+        MutationBatch(const MutationBatch<T> &) = delete;
+        MutationBatch<T> &operator=(const MutationBatch<T> &) = delete;
+
+        /*
+            Destructor, commits any mutations still queued. Must not run inside
+            an EpochGuard in multithreaded mode, as the commit may wait for
+            readers.
+        */
+        ~MutationBatch()
+        {
+            commit();
+        }
+
+        /*
+            Queues a mutation, taking ownership of the replacement object.
+
+            As with SharedPtrMutator::mutate, if no shared pointer is keeping
+            the object alive the replacement is cleaned up immediately instead.
+
+            @param mutator mutator for the pointers to retarget.
+            @param replacement the new object.
+            @return whether the mutation was queued.
+        */
+        bool add(const SharedPtrMutator<T> &mutator, T *replacement)
+        {
+            auto payload = mutator.payload;
+            if (payload == nullptr || !inner::incrementReferenceIfNotZero(payload->count))
+            {
+                if (payload != nullptr && replacement != nullptr)
+                {
+                    payload->dispose(replacement);
+                }
+                else
+                {
+                    inner::sharedDefaultDeleter<T>()(replacement);
+                }
+                return false;
+            }
+
+            try
+            {
+                makeRoom();
+            }
+            catch (...)
+            {
+                if (replacement != nullptr)
+                {
+                    payload->dispose(replacement);
+                }
+                payload->releaseShared();
+                throw;
+            }
+            payloads.push_back(payload);
+            objects.push_back(replacement);
+            return true;
+        }
+
+        /*
+            Moves the current object into the given storage and queues the
+            moved object as its replacement. The moved from object stays in
+            place, and is what every pointer still sees, until the batch is
+            committed; writes made through them in between are lost.
+
+            The storage is not owned by the batch, so this is meant to be used
+            with a recycle function which knows how to free it.
+
+            In multithreaded mode the object is moved from under an EpochGuard,
+            so a concurrent mutate cannot reclaim it mid move.
+
+            @param mutator mutator for the pointers to retarget.
+            @param destination uninitialised storage for a T.
+            @return the moved object, or nullptr if the object has expired and
+            nothing was moved.
+        */
+        T *relocate(const SharedPtrMutator<T> &mutator, void *destination)
+        {
+            auto payload = mutator.payload;
+            if (payload == nullptr || !inner::incrementReferenceIfNotZero(payload->count))
+            {
+                return nullptr;
+            }
+
+            T *moved;
+            try
+            {
+                makeRoom();
+#ifdef BG_MEMORY_MULTITHREAD
+                EpochGuard guard;
+#endif // BG_MEMORY_MULTITHREAD
+                moved = new (destination) T(std::move(*inner::loadManaged<T>(payload->managedObject)));
+            }
+            catch (...)
+            {
+                payload->releaseShared();
+                throw;
+            }
+            payloads.push_back(payload);
+            objects.push_back(moved);
+            return moved;
+        }
+
+        /*
+            Applies every queued mutation, cleaning up the replaced objects
+            through their deleters. Does not throw.
+        */
+        void commit()
+        {
+            apply(DisposeEach());
+        }
+
+        /*
+            Applies every queued mutation, handing the replaced objects to a
+            recycle function instead of their deleters. The function is called
+            once, with every non null replaced object, and becomes responsible
+            for destroying them and freeing their storage. In multithreaded
+            mode it is called once no reader can still see them, possibly on
+            another thread.
+
+            @param recycle function object callable with (T *const *objects, size_t count).
+        */
+        template <class F>
+        void commit(F &&recycle)
+        {
+            apply(RecycleAll<typename std::decay<F>::type>{std::forward<F>(recycle)});
+        }
+
+        /*
+            Gets the number of queued mutations.
+
+            @return count of mutations waiting for commit.
+        */
+        size_t size() const noexcept
+        {
+            return payloads.size();
+        }
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POINTERS_MUTATIONBATCH_HXX_
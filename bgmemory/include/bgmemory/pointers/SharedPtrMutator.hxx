@@ -2,18 +2,25 @@
 #ifndef BGMEMORY_INCLUDE_BGMEMORY_POINTERS_SHAREDPTRMUTATOR_HXX_
 #define BGMEMORY_INCLUDE_BGMEMORY_POINTERS_SHAREDPTRMUTATOR_HXX_
 
+#include <stddef.h>
 #include <functional>
+#include <type_traits>
+#include <utility>
+#include "bgmemory/assert.hxx"
 #include "bgmemory/pointers/inner/SharedPointerPayload.hxx"
 #include "bgmemory/pointers/MutableSharedPtr.hxx"
 #include "bgmemory/pointers/MutableWeakPtr.hxx"
 #include "bgmemory/DefaultDeleter.hxx"
 
 #ifdef BG_MEMORY_MULTITHREAD
-
+#include "bgmemory/reclamation/EpochReclamation.hxx"
 #endif // BG_MEMORY_MULTITHREAD
 
 namespace bg
 {
+    template <class T>
+    class MutationBatch;
+
     /*
         Limited Weak Pointer class used as a hook for mutating MutableSharedPtr
         and MutableWeakPtr pointers. Acts as a hook to mutate the underlying 
@@ -22,11 +29,42 @@ namespace bg
         This acts as a weak pointer, and must be disposed of like a weak pointer
         before the metadata is freed from memory. However, since it's a weak pointer
         it will not keep references to the managed object alive.
+
+        For shared arrays, SharedPtrMutator<T[]>, the whole buffer is replaced
+        and every view into it keeps its element offset into the new buffer.
     */
     template <class T>
     class SharedPtrMutator
     {
-        inner::SharedPointerPayload<T> *payload = nullptr;
+        using Element = typename std::remove_extent<T>::type;
+
+        inner::SharedPointerPayload<Element> *payload = nullptr;
+        // For arrays, one past the last element of the view the mutator was
+        // made from, the least a replacement buffer must hold.
+        size_t extent = 0;
+        friend class MutationBatch<T>;
+
+        template <class P>
+        static size_t viewExtent(const P &) noexcept
+        {
+            return 0;
+        }
+
+        template <class U>
+        static size_t viewExtent(const MutableSharedPtr<U[]> &r) noexcept
+        {
+            return r.offset + r.count;
+        }
+
+        // Takes a weak reference on the given payload, if any.
+        void acquire(inner::SharedPointerPayload<Element> *p) noexcept
+        {
+            payload = p;
+            if (payload != nullptr)
+            {
+                inner::incrementReference(payload->weakCount);
+            }
+        }
 
     public:
         /*
@@ -36,8 +74,7 @@ namespace bg
         */
         SharedPtrMutator(const MutableWeakPtr<T> &r) noexcept
         {
-            payload = r.payload;
-            payload->weakCount++;
+            acquire(r.payload);
         }
 
         /*
@@ -47,8 +84,7 @@ namespace bg
         */
         SharedPtrMutator(MutableWeakPtr<T> &&r) noexcept
         {
-            payload = r.payload;
-            payload->weakCount++;
+            acquire(r.payload);
         }
 
         /*
@@ -58,8 +94,8 @@ namespace bg
         */
         SharedPtrMutator(const MutableSharedPtr<T> &r) noexcept
         {
-            payload = r.payload;
-            payload->weakCount++;
+            acquire(r.payload);
+            extent = viewExtent(r);
         }
 
         /*
@@ -68,9 +104,63 @@ namespace bg
             @param r weak pointer to copy from
         */
         SharedPtrMutator(MutableSharedPtr<T> &&r) noexcept
+        {
+            acquire(r.payload);
+            extent = viewExtent(r);
+        }
+
+        /*
+            Copy constructor. Both mutators hook the same object.
+
+            @param r mutator to copy from
+        */
+        SharedPtrMutator(const SharedPtrMutator<T> &r) noexcept
+        {
+            acquire(r.payload);
+            extent = r.extent;
+        }
+
+        /*
+            Move constructor. Takes over the other mutator's hook, leaving it
+            unable to mutate anything.
+
+            @param r mutator to move from
+        */
+        SharedPtrMutator(SharedPtrMutator<T> &&r) noexcept
         {
             payload = r.payload;
-            payload->weakCount++;
+            extent = r.extent;
+            r.payload = nullptr;
+        }
+
+        /*
+            Copy assignment. Hooks the other mutator's object instead of the
+            current one.
+
+            @param r mutator to copy from
+            @return reference to this mutator.
+        */
+        SharedPtrMutator<T> &operator=(const SharedPtrMutator<T> &r) noexcept
+        {
+            SharedPtrMutator<T> copy(r);
+            std::swap(payload, copy.payload);
+            extent = copy.extent;
+            return *this;
+        }
+
+        /*
+            Move assignment. Takes over the other mutator's hook, leaving it
+            unable to mutate anything.
+
+            @param r mutator to move from
+            @return reference to this mutator.
+        */
+        SharedPtrMutator<T> &operator=(SharedPtrMutator<T> &&r) noexcept
+        {
+            SharedPtrMutator<T> moved(std::move(r));
+            std::swap(payload, moved.payload);
+            extent = moved.extent;
+            return *this;
         }
 
         /*
@@ -78,23 +168,96 @@ namespace bg
         */
         ~SharedPtrMutator()
         {
-            payload->weakCount--;
-            if (payload->count < 1 && payload->weakCount < 1)
+            if (payload != nullptr)
             {
-                delete payload;
+                payload->releaseWeak();
             }
         }
 
-        void mutate(T *ptr)
+        /*
+            Replaces the managed object for every shared and weak pointer
+            referring to it, cleaning up the previous object.
+
+            If no shared pointer is keeping the object alive there is nothing
+            to retarget, and the new object is cleaned up immediately instead
+            of being leaked.
+
+            When BG_MEMORY_MULTITHREAD is defined the swap is a single atomic
+            exchange and is safe against concurrent readers and other mutators.
+            The previous object is retired through epoch based reclamation and
+            only cleaned up once every reader inside an EpochGuard (including
+            the implicit one held by MutableSharedPtr::operator->) has moved on.
+
+            For arrays the replacement must have been allocated with new[] and
+            hold at least as many elements as the buffer it replaces, so every
+            view into the buffer stays in range. Prefer the overload taking the
+            replacement's length, which checks it.
+
+            @param ptr pointer to the object to take ownership of.
+        */
+        void mutate(Element *ptr)
         {
-            if (payload->managedObject != nullptr)
+            if (payload == nullptr)
+            {
+                inner::sharedDefaultDeleter<T>()(ptr);
+                return;
+            }
+
+#ifdef BG_MEMORY_MULTITHREAD
+            // Hold a shared reference for the swap, so the object can't expire
+            // halfway through and leave the new object unowned.
+            if (!inner::incrementReferenceIfNotZero(payload->count))
             {
-                (*payload->deleter)(payload->managedObject);
+                if (ptr != nullptr)
+                {
+                    payload->dispose(ptr);
+                }
+                return;
             }
-            if (payload->count > 0)
+
+            payload->replace(ptr);
+            payload->releaseShared();
+#else
+            if (inner::loadReference(payload->count) < 1)
             {
-                payload->managedObject = ptr;
+                if (ptr != nullptr)
+                {
+                    payload->dispose(ptr);
+                }
+                return;
             }
+
+            payload->replace(ptr);
+#endif // BG_MEMORY_MULTITHREAD
+        }
+
+        /*
+            Replaces a shared array's buffer, asserting that the replacement is
+            long enough for the view the mutator was made from. Views of other
+            ranges of the buffer are not known to the mutator and are not
+            checked.
+
+            @param ptr first element of the new buffer, allocated with new[].
+            @param n number of elements in the new buffer.
+        */
+        template <class U = T, class = typename std::enable_if<std::is_array<U>::value>::type>
+        void mutate(Element *ptr, size_t n)
+        {
+            ASSERT(ptr == nullptr || n >= extent);
+            static_cast<void>(n);
+            mutate(ptr);
+        }
+
+        /*
+            Gets the number of elements a replacement buffer must at least hold
+            for the view the mutator was made from.
+
+            @return one past the last element of that view.
+        */
+        template <class U = T, class = typename std::enable_if<std::is_array<U>::value>::type>
+        size_t requiredLength() const noexcept
+        {
+            return extent;
         }
     };
 } // namespace bg
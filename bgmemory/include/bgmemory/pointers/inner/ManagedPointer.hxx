@@ -0,0 +1,117 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INNER_MANAGEDPOINTER_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INNER_MANAGEDPOINTER_HXX_
+
+#ifdef BG_MEMORY_MULTITHREAD
+#include <atomic>
+#include "bgmemory/reclamation/EpochReclamation.hxx"
+#endif // BG_MEMORY_MULTITHREAD
+
+namespace bg::inner
+{
+    /*
+        Pointer to the managed object held by the pointer payloads.
+
+        When BG_MEMORY_MULTITHREAD is defined the pointer is atomic so it can be
+        swapped by a SharedPtrMutator while other threads read it, otherwise it
+        is a plain pointer.
+    */
+#ifdef BG_MEMORY_MULTITHREAD
+    template <class T>
+    using ManagedPointer = std::atomic<T *>;
+#else
+    template <class T>
+    using ManagedPointer = T *;
+#endif // BG_MEMORY_MULTITHREAD
+
+    /*
+        Reads the managed pointer. Acquire ordering so the object a new pointer
+        refers to is fully constructed when seen.
+
+        @param pointer the managed pointer to read.
+        @return the current object.
+    */
+    template <class T>
+    inline T *loadManaged(const ManagedPointer<T> &pointer) noexcept
+    {
+#ifdef BG_MEMORY_MULTITHREAD
+        return pointer.load(std::memory_order_acquire);
+#else
+        return pointer;
+#endif // BG_MEMORY_MULTITHREAD
+    }
+
+    /*
+        Replaces the managed pointer, returning the previous object.
+
+        @param pointer the managed pointer to replace.
+        @param value the new object.
+        @return the previous object.
+    */
+    template <class T>
+    inline T *exchangeManaged(ManagedPointer<T> &pointer, T *value) noexcept
+    {
+#ifdef BG_MEMORY_MULTITHREAD
+        return pointer.exchange(value, std::memory_order_acq_rel);
+#else
+        T *previous = pointer;
+        pointer = value;
+        return previous;
+#endif // BG_MEMORY_MULTITHREAD
+    }
+
+    /*
+        Replaces the managed pointer only if it still holds the expected
+        object.
+
+        @param pointer the managed pointer to replace.
+        @param expected the object the pointer must hold.
+        @param value the new object.
+        @return whether the pointer was replaced.
+    */
+    template <class T>
+    inline bool compareExchangeManaged(ManagedPointer<T> &pointer, T *expected, T *value) noexcept
+    {
+#ifdef BG_MEMORY_MULTITHREAD
+        return pointer.compare_exchange_strong(expected, value, std::memory_order_acq_rel,
+                                               std::memory_order_acquire);
+#else
+        if (pointer != expected)
+        {
+            return false;
+        }
+        pointer = value;
+        return true;
+#endif // BG_MEMORY_MULTITHREAD
+    }
+
+#ifdef BG_MEMORY_MULTITHREAD
+    /*
+        Result of MutableSharedPtr::operator-> in multithreaded mode. Holds an
+        EpochGuard for the rest of the full expression, so an object swapped
+        out by a concurrent mutate is not reclaimed while it is being used.
+    */
+    template <class T>
+    class GuardedPointer
+    {
+        EpochGuard guard;
+        T *pointer;
+
+    public:
+        GuardedPointer(const ManagedPointer<T> &source) noexcept // NOLINT
+            : guard(), pointer(loadManaged<T>(source))
+        {
+        }
+
+        GuardedPointer(const GuardedPointer<T> &) = delete;
+        GuardedPointer<T> &operator=(const GuardedPointer<T> &) = delete;
+
+        T *operator->() const noexcept
+        {
+            return pointer;
+        }
+    };
+#endif // BG_MEMORY_MULTITHREAD
+} // namespace bg::inner
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INNER_MANAGEDPOINTER_HXX_
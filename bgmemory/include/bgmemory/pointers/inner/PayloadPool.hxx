@@ -0,0 +1,40 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INNER_PAYLOADPOOL_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INNER_PAYLOADPOOL_HXX_
+
+#include <stddef.h>
+
+namespace bg::inner
+{
+    // Payload blocks are handed out in multiples of this size, and aligned to it.
+    constexpr size_t payloadGranularity = 16;
+
+    // Largest payload served from the pool, bigger ones go to the heap directly.
+    constexpr size_t payloadMaxPooledSize = 256;
+
+    /*
+        Allocates memory for a pointer payload.
+
+        Payloads are served from per size class slabs through a thread local
+        cache, so in the steady state creating a pointer takes no lock and
+        never reaches malloc, and payloads created together sit next to each
+        other in memory. Slabs are refilled and drained in batches through a
+        shared pool. Slab memory is kept for reuse and never returned.
+
+        @param sizeInBytes size of the payload, at most payloadMaxPooledSize to be pooled.
+        @return pointer to memory aligned to payloadGranularity.
+        @throws std::bad_alloc if no memory is available.
+    */
+    void *allocatePayload(size_t sizeInBytes);
+
+    /*
+        Returns memory obtained from allocatePayload. It may be returned from
+        any thread, not only the one which allocated it.
+
+        @param pointer the payload memory to return.
+        @param sizeInBytes size the payload was allocated with.
+    */
+    void deallocatePayload(void *pointer, size_t sizeInBytes) noexcept;
+} // namespace bg::inner
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INNER_PAYLOADPOOL_HXX_
@@ -0,0 +1,130 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INNER_REFERENCECOUNT_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INNER_REFERENCECOUNT_HXX_
+
+#if defined(BG_MEMORY_MULTITHREAD) || defined(BG_MEMORY_COUNT_REFERENCE_OPERATIONS)
+#include <atomic>
+#endif // BG_MEMORY_MULTITHREAD || BG_MEMORY_COUNT_REFERENCE_OPERATIONS
+
+namespace bg::inner
+{
+    /*
+        Reference count used by the pointer payloads.
+
+        When BG_MEMORY_MULTITHREAD is defined the count is a lock free atomic,
+        otherwise it is a plain long and every operation compiles down to the
+        ordinary arithmetic.
+    */
+#ifdef BG_MEMORY_MULTITHREAD
+    using ReferenceCount = std::atomic<long>;
+#else
+    using ReferenceCount = long;
+#endif // BG_MEMORY_MULTITHREAD
+
+#ifdef BG_MEMORY_COUNT_REFERENCE_OPERATIONS
+    /*
+        Gets the number of reference count operations performed so far, across
+        every thread. Only available when BG_MEMORY_COUNT_REFERENCE_OPERATIONS is
+        defined, which is meant for tests checking that an operation leaves the
+        counts untouched.
+
+        @return the counter of reference count operations.
+    */
+    inline std::atomic<long> &referenceOperationCount() noexcept
+    {
+        static std::atomic<long> operations(0);
+        return operations;
+    }
+
+#define BG_MEMORY_COUNT_REFERENCE_OPERATION() \
+    ::bg::inner::referenceOperationCount().fetch_add(1, std::memory_order_relaxed)
+#else
+#define BG_MEMORY_COUNT_REFERENCE_OPERATION()
+#endif // BG_MEMORY_COUNT_REFERENCE_OPERATIONS
+
+    /*
+        Adds a reference. The caller already holds a reference, so no ordering
+        is needed beyond atomicity.
+
+        @param count the count to increment.
+    */
+    inline void incrementReference(ReferenceCount &count) noexcept
+    {
+        BG_MEMORY_COUNT_REFERENCE_OPERATION();
+#ifdef BG_MEMORY_MULTITHREAD
+        count.fetch_add(1, std::memory_order_relaxed);
+#else
+        count++;
+#endif // BG_MEMORY_MULTITHREAD
+    }
+
+    /*
+        Drops a reference. Release ordering publishes this thread's writes to
+        whichever thread drops the last reference, and acquire ordering on the
+        last drop makes those writes visible before cleanup runs.
+
+        @param count the count to decrement.
+        @return the count after decrementing, zero for the last reference.
+    */
+    inline long decrementReference(ReferenceCount &count) noexcept
+    {
+        BG_MEMORY_COUNT_REFERENCE_OPERATION();
+#ifdef BG_MEMORY_MULTITHREAD
+        return count.fetch_sub(1, std::memory_order_acq_rel) - 1;
+#else
+        return --count;
+#endif // BG_MEMORY_MULTITHREAD
+    }
+
+    /*
+        Adds a reference only if the count has not already reached zero. Used
+        to promote a weak reference, where the last strong reference may be
+        dropped concurrently; a compare and swap loop guarantees a count that
+        hit zero is never resurrected.
+
+        @param count the count to increment.
+        @return whether a reference was added.
+    */
+    inline bool incrementReferenceIfNotZero(ReferenceCount &count) noexcept
+    {
+        BG_MEMORY_COUNT_REFERENCE_OPERATION();
+#ifdef BG_MEMORY_MULTITHREAD
+        long current = count.load(std::memory_order_relaxed);
+        while (current > 0)
+        {
+            if (count.compare_exchange_weak(current, current + 1,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+        return false;
+#else
+        if (count < 1)
+        {
+            return false;
+        }
+        count++;
+        return true;
+#endif // BG_MEMORY_MULTITHREAD
+    }
+
+    /*
+        Reads the current count. Acquire ordering so a reader observing zero
+        also observes the cleanup that preceded it.
+
+        @param count the count to read.
+        @return the current count.
+    */
+    inline long loadReference(const ReferenceCount &count) noexcept
+    {
+#ifdef BG_MEMORY_MULTITHREAD
+        return count.load(std::memory_order_acquire);
+#else
+        return count;
+#endif // BG_MEMORY_MULTITHREAD
+    }
+} // namespace bg::inner
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POINTERS_INNER_REFERENCECOUNT_HXX_
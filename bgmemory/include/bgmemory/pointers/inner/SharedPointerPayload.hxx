@@ -2,53 +2,476 @@
 #ifndef BGMEMORY_INCLUDE_BGMEMORY_POINTERS_SHAREDPOINTERPAYLOAD_HXX_
 #define BGMEMORY_INCLUDE_BGMEMORY_POINTERS_SHAREDPOINTERPAYLOAD_HXX_
 
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include "bgmemory/pointers/Deleter.hxx"
-
-#ifdef BG_MEMORY_MULTITHREAD
-
-#endif // BG_MEMORY_MULTITHREAD
+#include "bgmemory/DefaultDeleter.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+#include "bgmemory/allocators/Allocator.hxx"
+#include "bgmemory/debug/MemoryDebug.hxx"
+#include "bgmemory/instrumentation/MemoryTracker.hxx"
+#include "bgmemory/pointers/inner/ReferenceCount.hxx"
+#include "bgmemory/pointers/inner/ManagedPointer.hxx"
+#include "bgmemory/pointers/inner/PayloadPool.hxx"
+#include "bgmemory/reclamation/DeferredDestruction.hxx"
 
 namespace bg::inner
 {
+    /*
+        Gets an address unique to the given type, a static stand in for
+        typeid which needs no RTTI.
+
+        @return tag identifying P.
+    */
+    template <class P>
+    const void *typeTag() noexcept
+    {
+        static const char tag = 0;
+        return &tag;
+    }
+
+    /*
+        Gets a shared default deleter instance, reported as the deleter of
+        payloads which do not store one of their own. For arrays, T[], this
+        is a deleter of the element type calling delete[].
+
+        @return reference to the shared default deleter for T.
+    */
+    template <class T>
+    Deleter<typename std::remove_extent<T>::type> &sharedDefaultDeleter() noexcept
+    {
+        static DefaultDeleter<T> deleter;
+        return deleter;
+    }
+
     /*
         Payload object for pointers
+
+        The payload owns the counts and the managed object pointer. How the
+        managed object is cleaned up and how the payload itself is freed is up
+        to the concrete payload type.
     */
     template <class T>
     struct SharedPointerPayload
     {
         // The object being managed by the smart pointer
-        T *managedObject = nullptr;
+        ManagedPointer<T> managedObject{nullptr};
 
         // Count of actual references to the object, at zero the
-        // managed object will be cleaned up
-        long count = 0;
+        // managed object will be cleaned up. A payload is always created
+        // on behalf of its first shared pointer.
+        ReferenceCount count{1};
 
         // Count of weak references to the object. This count
         // does not keep the managed object alive but does keep
         // the payload metadata alive so any remaining weak references
-        // can find out if the managed object is still alive
-        long weakCount = 0;
+        // can find out if the managed object is still alive.
+        // All shared pointers together hold one extra weak reference, so
+        // the payload is freed exactly once, by whoever drops the last
+        // weak reference, even while the object is being cleaned up.
+        ReferenceCount weakCount{1};
+
+        // Drops a shared reference, cleaning up the object on the last one.
+        // Inside a DeferredDestructionScope the object is queued for collect
+        // instead, grouped by payload type so objects sharing a deleter are
+        // cleaned up together.
+        void releaseShared() noexcept
+        {
+            if (decrementReference(count) == 0)
+            {
+                T *object = exchangeManaged<T>(managedObject, nullptr);
+                if (object == nullptr || !deferringDestruction() ||
+                    !deferDestruction(object, &SharedPointerPayload<T>::reclaimObject, this, deferGroup()))
+                {
+                    dispose(object);
+                    releaseWeak();
+                }
+            }
+        }
+
+        /*
+            Swaps in a new managed object and cleans up the previous one. The
+            caller must hold a shared reference.
+
+            In multithreaded mode the swap is atomic and the previous object is
+            retired rather than cleaned up on the spot, so readers inside an
+            EpochGuard never see it freed. The payload stays alive until the
+            retired object has been reclaimed.
+        */
+        void replace(T *pointer) noexcept
+        {
+            T *previous = exchangeManaged<T>(managedObject, pointer);
+            if (previous == nullptr)
+            {
+                return;
+            }
+#ifdef BG_MEMORY_MULTITHREAD
+            incrementReference(weakCount);
+            retire(previous, &SharedPointerPayload<T>::reclaimObject, this);
+#else
+            dispose(previous);
+#endif // BG_MEMORY_MULTITHREAD
+        }
+
+        /*
+            Swaps in a new managed object and hands the previous one back to
+            the caller, who becomes responsible for cleaning it up. The caller
+            must hold a shared reference.
+        */
+        T *exchange(T *pointer) noexcept
+        {
+            return exchangeManaged<T>(managedObject, pointer);
+        }
+
+        // Drops a weak reference, freeing the payload on the last one.
+        void releaseWeak() noexcept
+        {
+            if (decrementReference(weakCount) == 0)
+            {
+                destroy();
+            }
+        }
+
+        // Cleans up an object owned by this payload.
+        virtual void dispose(T *pointer) noexcept = 0;
+
+        // Frees the payload itself, once no references remain.
+        virtual void destroy() noexcept = 0;
+
+        // Gets the deleter used to clean up objects owned by this payload.
+        virtual Deleter<T> &getDeleter() noexcept = 0;
+
+        // Gets the typeTag of the concrete payload, grouping its deferred objects.
+        virtual const void *deferGroup() const noexcept = 0;
+
+        // Payloads created with new are drawn from the payload pool.
+        static void *operator new(size_t sizeInBytes)
+        {
+            void *memory = allocatePayload(sizeInBytes);
+            BG_MEMORY_TRACK_ALLOCATION(payloadTracker(), sizeInBytes);
+            return memory;
+        }
+
+        static void operator delete(void *pointer, size_t sizeInBytes) noexcept
+        {
+            BG_MEMORY_TRACK_FREE(payloadTracker(), sizeInBytes);
+            deallocatePayload(pointer, sizeInBytes);
+        }
 
+        // Placement new, for payloads living in caller provided memory.
+        static void *operator new(size_t, void *memory) noexcept
+        {
+            return memory;
+        }
+
+        static void operator delete(void *, void *) noexcept
+        {
+        }
+
+    protected:
+        virtual ~SharedPointerPayload() = default;
+
+    private:
+        // Cleans up an object retired by replace or queued by releaseShared,
+        // then drops the weak reference which kept the payload alive meanwhile.
+        static void reclaimObject(void *object, void *context) noexcept
+        {
+            auto payload = static_cast<SharedPointerPayload<T> *>(context);
+            payload->dispose(static_cast<T *>(object));
+            payload->releaseWeak();
+        }
+    };
+
+    /*
+        Adapts any callable taking a T* into the Deleter interface, so lambdas
+        and function objects can be stored inline in a payload and still be
+        handed out through getDeleter().
+    */
+    template <class T, class F>
+    class CallableDeleter final : public Deleter<T>
+    {
+        F function;
+
+    public:
+        explicit CallableDeleter(F &&f) : function(std::move(f)) {}
+
+        void operator()(T *pointer) override
+        {
+            function(pointer);
+        }
+    };
+
+    /*
+        Picks the type stored inline for a deleter: Deleter implementations are
+        stored as is, any other callable is wrapped in a CallableDeleter.
+    */
+    template <class T, class D>
+    using InlineDeleter = typename std::conditional<std::is_base_of<Deleter<T>, D>::value,
+                                                    D,
+                                                    CallableDeleter<T, D>>::type;
+
+    /*
+        Payload storing its deleter inline, so the deleter costs no allocation
+        of its own. D is the concrete deleter type, which lets the compiler
+        resolve the call on release statically.
+    */
+    template <class T, class D = DefaultDeleter<T>>
+    struct DeleterPayload final : SharedPointerPayload<T>
+    {
         // Functional object in charge of cleaning up the managed object.
-        Deleter<T> *deleter;
+        D deleter;
+
+        DeleterPayload() = default;
+
+        template <class F>
+        explicit DeleterPayload(F &&d) : deleter(std::forward<F>(d))
+        {
+        }
 
-        SharedPointerPayload()
+        void dispose(T *pointer) noexcept override
         {
-            deleter = new DefaultDeleter<T>();
+            deleter(pointer);
         }
 
+        void destroy() noexcept override
+        {
+            delete this;
+        }
+
+        Deleter<T> &getDeleter() noexcept override
+        {
+            return deleter;
+        }
+
+        const void *deferGroup() const noexcept override
+        {
+            return typeTag<DeleterPayload<T, D>>();
+        }
+    };
+
+    /*
+        Payload holding a heap allocated deleter which it owns, for deleters
+        handed over by pointer.
+    */
+    template <class T>
+    struct HeapDeleterPayload final : SharedPointerPayload<T>
+    {
+        // Functional object in charge of cleaning up the managed object.
+        Deleter<T> *deleter;
+
         // Creates a shared payload with a deleter pointer owned by this class.
-        SharedPointerPayload(Deleter<T> *d)
+        explicit HeapDeleterPayload(Deleter<T> *d)
         {
             deleter = d;
         }
 
-        ~SharedPointerPayload()
+        ~HeapDeleterPayload() override
         {
             delete deleter;
         }
+
+        void dispose(T *pointer) noexcept override
+        {
+            (*deleter)(pointer);
+        }
+
+        void destroy() noexcept override
+        {
+            delete this;
+        }
+
+        Deleter<T> &getDeleter() noexcept override
+        {
+            return *deleter;
+        }
+
+        const void *deferGroup() const noexcept override
+        {
+            return typeTag<HeapDeleterPayload<T>>();
+        }
+    };
+
+    /*
+        Payload which stores the managed object inside itself, so a pointer
+        and its object take a single allocation. Created by makeMutableShared.
+
+        The in place object is destroyed without freeing memory. Objects
+        installed later through a SharedPtrMutator are heap objects and are
+        cleaned up with the default deleter.
+
+        With BG_MEMORY_DEBUG the storage is filled with freedFill once the in
+        place object is destroyed, and writes to it through stale pointers are
+        reported when the payload is freed.
+    */
+    template <class T>
+    struct InplacePayload final : SharedPointerPayload<T>
+    {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        // Allocator the payload was drawn from.
+        Allocator *allocator;
+
+#ifdef BG_MEMORY_DEBUG
+        // Whether the in place object was replaced while still shared.
+        bool mutatedAway = false;
+#endif // BG_MEMORY_DEBUG
+
+        template <class... Args>
+        explicit InplacePayload(Allocator *a, Args &&... args)
+        {
+            allocator = a;
+            exchangeManaged<T>(this->managedObject, new (&storage) T(std::forward<Args>(args)...));
+        }
+
+        void dispose(T *pointer) noexcept override
+        {
+            if (pointer == reinterpret_cast<T *>(&storage))
+            {
+                pointer->~T();
+#ifdef BG_MEMORY_DEBUG
+                poisonMemory(&storage, sizeof(storage), freedFill);
+                mutatedAway = loadReference(this->count) > 0;
+#endif // BG_MEMORY_DEBUG
+            }
+            else
+            {
+                sharedDefaultDeleter<T>()(pointer);
+            }
+        }
+
+        void destroy() noexcept override
+        {
+#ifdef BG_MEMORY_DEBUG
+            if (!isPoisoned(&storage, sizeof(storage), freedFill))
+            {
+                reportMemoryError(mutatedAway ? MemoryError::UseAfterMutate : MemoryError::UseAfterFree, &storage,
+                                  "destroyed in place object was written to");
+            }
+#endif // BG_MEMORY_DEBUG
+            auto a = allocator;
+            this->~InplacePayload();
+            BG_MEMORY_TRACK_FREE(inplaceTracker(), sizeof(InplacePayload<T>));
+            a->deallocate(this, sizeof(InplacePayload<T>), alignof(InplacePayload<T>));
+        }
+
+        Deleter<T> &getDeleter() noexcept override
+        {
+            return sharedDefaultDeleter<T>();
+        }
+
+        const void *deferGroup() const noexcept override
+        {
+            return typeTag<InplacePayload<T>>();
+        }
+    };
+
+    /*
+        Payload which stores an array of T directly after itself, so a shared
+        array and its elements take a single allocation. Created by
+        makeMutableShared<T[]>.
+
+        The in place elements are destroyed without freeing memory. Arrays
+        installed later through a SharedPtrMutator were allocated with new[]
+        and are cleaned up with delete[].
+    */
+    template <class T>
+    struct InplaceArrayPayload final : SharedPointerPayload<T>
+    {
+        // Allocator the payload was drawn from.
+        Allocator *allocator;
+
+        // Number of elements stored in place.
+        size_t elementCount;
+
+        /*
+            Value initialises the given number of elements in place. If an
+            element throws, the elements already constructed are destroyed.
+        */
+        InplaceArrayPayload(Allocator *a, size_t n)
+        {
+            allocator = a;
+            elementCount = n;
+            T *first = elements();
+            size_t constructed = 0;
+            try
+            {
+                for (; constructed < elementCount; constructed++)
+                {
+                    new (first + constructed) T();
+                }
+            }
+            catch (...)
+            {
+                destroyElements(first, constructed);
+                throw;
+            }
+            exchangeManaged<T>(this->managedObject, first);
+        }
+
+        static size_t elementsOffset() noexcept
+        {
+            return alignUp(sizeof(InplaceArrayPayload<T>), alignof(T));
+        }
+
+        // Size of the allocation holding a payload and its elements.
+        static size_t allocationSize(size_t n) noexcept
+        {
+            return elementsOffset() + n * sizeof(T);
+        }
+
+        // Alignment of the allocation holding a payload and its elements.
+        static size_t allocationAlignment() noexcept
+        {
+            return alignof(InplaceArrayPayload<T>) > alignof(T) ? alignof(InplaceArrayPayload<T>) : alignof(T);
+        }
+
+        T *elements() noexcept
+        {
+            return reinterpret_cast<T *>(reinterpret_cast<unsigned char *>(this) + elementsOffset());
+        }
+
+        static void destroyElements(T *first, size_t n) noexcept
+        {
+            while (n > 0)
+            {
+                first[--n].~T();
+            }
+        }
+
+        void dispose(T *pointer) noexcept override
+        {
+            if (pointer == elements())
+            {
+                destroyElements(pointer, elementCount);
+            }
+            else
+            {
+                sharedDefaultDeleter<T[]>()(pointer);
+            }
+        }
+
+        void destroy() noexcept override
+        {
+            auto a = allocator;
+            const size_t size = allocationSize(elementCount);
+            this->~InplaceArrayPayload();
+            BG_MEMORY_TRACK_FREE(inplaceTracker(), size);
+            a->deallocate(this, size, allocationAlignment());
+        }
+
+        Deleter<T> &getDeleter() noexcept override
+        {
+            return sharedDefaultDeleter<T[]>();
+        }
+
+        const void *deferGroup() const noexcept override
+        {
+            return typeTag<InplaceArrayPayload<T>>();
+        }
     };
 
 } // namespace bg::inner
 
-#endif // BGMEMORY_INCLUDE_BGMEMORY_POINTERS_SHAREDPOINTERPAYLOAD_HXX_
\ No newline at end of file
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POINTERS_SHAREDPOINTERPAYLOAD_HXX_
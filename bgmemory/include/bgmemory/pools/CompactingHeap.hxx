@@ -0,0 +1,505 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_POOLS_COMPACTINGHEAP_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_POOLS_COMPACTINGHEAP_HXX_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "bgmemory/assert.hxx"
+#include "bgmemory/bulletpool.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+#include "bgmemory/allocators/Allocator.hxx"
+#include "bgmemory/pointers/Deleter.hxx"
+#include "bgmemory/pointers/MutableSharedPtr.hxx"
+#include "bgmemory/pointers/MutableWeakPtr.hxx"
+#include "bgmemory/pointers/MutationBatch.hxx"
+#include "bgmemory/pointers/SharedPtrMutator.hxx"
+
+namespace bg
+{
+    /*
+        Snapshot of how fragmented a CompactingHeap is.
+    */
+    struct CompactingHeapStats
+    {
+        // Number of slots in the heap.
+        uint32_t capacity = 0;
+
+        // Number of slots holding a live object.
+        uint32_t liveCount = 0;
+
+        // One past the highest live slot, the span of memory in use.
+        uint32_t highWaterMark = 0;
+
+        // Free slots below the high water mark.
+        uint32_t holes = 0;
+
+        // Fraction of the used span which is holes, 0 when fully compact.
+        double fragmentation = 0.0;
+    };
+
+    /*
+        Fixed capacity heap of T which hands out MutableSharedPtr handles and
+        can compact its live objects towards the front of its storage.
+
+        Objects are allocated into the lowest free slot. Over a long session
+        releases leave holes; defragment() moves the highest live objects down
+        into the lowest holes (move constructing where T allows it) and
+        retargets every shared and weak pointer to the object through a
+        SharedPtrMutator, so outstanding handles never notice.
+
+        Raw pointers and references obtained from handles are invalidated by
+        defragment(). The heap must outlive every handle it gives out. With
+        BG_MEMORY_DEBUG, free slots are filled with freedFill, and writes
+        through such stale pointers are reported when the slot is next used.
+
+        When BG_MEMORY_MULTITHREAD is defined slot bookkeeping is guarded by a
+        mutex, so handles may be copied and released from any thread, even
+        while defragment() runs. Objects themselves must not be read or
+        written during defragment(): they are moved out of their old slots, so
+        until the handles are retargeted they refer to moved from objects.
+        Relocated objects are retired, so their old slots are only freed once
+        epoch reclamation gets to them.
+    */
+    template <class T>
+    class CompactingHeap
+    {
+        using Slot = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+        // Deleter given to every handle, returning the object's slot to the heap.
+        class SlotDeleter : public Deleter<T>
+        {
+            CompactingHeap<T> *heap;
+
+        public:
+            explicit SlotDeleter(CompactingHeap<T> *h) noexcept : heap(h) {}
+
+            void operator()(T *pointer) override
+            {
+                if (pointer != nullptr)
+                {
+                    heap->releaseSlot(pointer);
+                }
+            }
+        };
+
+        Allocator *allocator = nullptr;
+        Slot *slots = nullptr;
+        MutableWeakPtr<T> *owners = nullptr;
+        uint64_t *liveBits = nullptr;
+        uint32_t slotCount = 0;
+        uint32_t live = 0;
+        // Lowest bitmap word that may contain a free slot.
+        size_t firstFreeWord = 0;
+        // Guards the bookkeeping above, only locked in multithreaded mode.
+        mutable std::mutex mutex;
+
+        static constexpr size_t blockAlignment =
+            alignof(Slot) > cacheLineSize ? alignof(Slot) : cacheLineSize;
+
+        static size_t ownersOffset(size_t capacity) noexcept
+        {
+            return alignUp(capacity * sizeof(Slot), alignof(MutableWeakPtr<T>));
+        }
+
+        static size_t bitmapOffset(size_t capacity) noexcept
+        {
+            return alignUp(ownersOffset(capacity) + capacity * sizeof(MutableWeakPtr<T>), alignof(uint64_t));
+        }
+
+        static size_t blockSize(size_t capacity) noexcept
+        {
+            return bitmapOffset(capacity) + inner::bitmapWordCount(capacity) * sizeof(uint64_t);
+        }
+
+        std::unique_lock<std::mutex> lockSlots() const
+        {
+#ifdef BG_MEMORY_MULTITHREAD
+            return std::unique_lock<std::mutex>(mutex);
+#else
+            return std::unique_lock<std::mutex>(mutex, std::defer_lock);
+#endif // BG_MEMORY_MULTITHREAD
+        }
+
+        T *slotObject(uint32_t index) noexcept
+        {
+            return reinterpret_cast<T *>(&slots[index]);
+        }
+
+        bool isLive(uint32_t index) const noexcept
+        {
+            return (liveBits[index / 64] & (uint64_t(1) << (index % 64))) != 0;
+        }
+
+        void markLive(uint32_t index) noexcept
+        {
+            liveBits[index / 64] |= uint64_t(1) << (index % 64);
+            live++;
+        }
+
+        void markFree(uint32_t index) noexcept
+        {
+            BG_MEMORY_POISON(&slots[index], sizeof(Slot), freedFill);
+            liveBits[index / 64] &= ~(uint64_t(1) << (index % 64));
+            if (index / 64 < firstFreeWord)
+            {
+                firstFreeWord = index / 64;
+            }
+            live--;
+        }
+
+#ifdef BG_MEMORY_DEBUG
+        // Reports writes to a claimed slot made while it was free.
+        void checkFreeSlot(uint32_t index) noexcept
+        {
+            if (!isPoisoned(&slots[index], sizeof(Slot), freedFill))
+            {
+                reportMemoryError(MemoryError::UseAfterFree, &slots[index],
+                                  "released or relocated CompactingHeap slot was written to");
+            }
+        }
+#endif // BG_MEMORY_DEBUG
+
+        // Finds and claims the lowest free slot, endOfFreeList if the heap is full.
+        uint32_t claimLowestFree() noexcept
+        {
+            const size_t words = inner::bitmapWordCount(slotCount);
+            for (size_t w = firstFreeWord; w < words; w++)
+            {
+                const uint64_t freeBits = ~liveBits[w];
+                if (freeBits != 0)
+                {
+                    const uint32_t index = static_cast<uint32_t>(w * 64 + inner::lowestSetBit(freeBits));
+                    if (index >= slotCount)
+                    {
+                        break;
+                    }
+                    firstFreeWord = w;
+                    markLive(index);
+                    return index;
+                }
+            }
+            firstFreeWord = words;
+            return inner::endOfFreeList;
+        }
+
+        // Finds the highest live slot, endOfFreeList if the heap is empty.
+        uint32_t highestLive() const noexcept
+        {
+            for (size_t w = inner::bitmapWordCount(slotCount); w > 0; w--)
+            {
+                const uint64_t bits = liveBits[w - 1];
+                if (bits != 0)
+                {
+                    return static_cast<uint32_t>((w - 1) * 64 + inner::highestSetBit(bits));
+                }
+            }
+            return inner::endOfFreeList;
+        }
+
+        // Finds the highest slot whose object still has handles and so can be
+        // moved, skipping slots which are only waiting to be freed.
+        uint32_t highestMovable() const noexcept
+        {
+            for (size_t w = inner::bitmapWordCount(slotCount); w > 0; w--)
+            {
+                uint64_t bits = liveBits[w - 1];
+                while (bits != 0)
+                {
+                    const unsigned bit = inner::highestSetBit(bits);
+                    const uint32_t index = static_cast<uint32_t>((w - 1) * 64 + bit);
+                    if (!owners[index].expired())
+                    {
+                        return index;
+                    }
+                    bits &= ~(uint64_t(1) << bit);
+                }
+            }
+            return inner::endOfFreeList;
+        }
+
+        // Called by SlotDeleter once the object in a slot is no longer referenced.
+        void releaseSlot(T *object) noexcept
+        {
+            const uint32_t index = static_cast<uint32_t>(reinterpret_cast<Slot *>(object) - slots);
+            ASSERT(index < slotCount);
+            object->~T();
+
+            auto lock = lockSlots();
+            ASSERT(isLive(index));
+            owners[index].reset();
+            markFree(index);
+        }
+
+        // Moves the object in slot from into the free slot to, queueing the
+        // retarget of its handles on the batch.
+        bool relocate(uint32_t from, uint32_t to, MutationBatch<T> &batch)
+        {
+            MutableWeakPtr<T> owner;
+            {
+                auto lock = lockSlots();
+                owner = owners[from];
+            }
+
+#ifdef BG_MEMORY_DEBUG
+            checkFreeSlot(to);
+#endif // BG_MEMORY_DEBUG
+            // The batch holds a strong reference from here to the commit, so
+            // the object cannot be released mid move.
+            T *target;
+            try
+            {
+                target = batch.relocate(SharedPtrMutator<T>(owner), &slots[to]);
+            }
+            catch (...)
+            {
+                auto lock = lockSlots();
+                markFree(to);
+                throw;
+            }
+
+            auto lock = lockSlots();
+            if (target == nullptr)
+            {
+                markFree(to);
+                return false;
+            }
+            // The old slot stays live until the batch recycles it, but has no
+            // owner so it is never picked for another move.
+            owners[to] = owner;
+            owners[from].reset();
+            return true;
+        }
+
+        // Recycles the slots a committed batch moved objects out of.
+        void releaseSlots(T *const *objects, size_t count) noexcept
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                objects[i]->~T();
+            }
+
+            auto lock = lockSlots();
+            for (size_t i = 0; i < count; i++)
+            {
+                const uint32_t index = static_cast<uint32_t>(reinterpret_cast<Slot *>(objects[i]) - slots);
+                ASSERT(index < slotCount && isLive(index));
+                owners[index].reset();
+                markFree(index);
+            }
+        }
+
+    public:
+        /*
+            Constructs a heap with room for the given number of objects.
+
+            @param capacity maximum number of live objects in the heap.
+            @param a allocator providing the heap's storage, must outlive the heap.
+            @throws std::bad_alloc if the allocator cannot provide the storage.
+        */
+        explicit CompactingHeap(uint32_t capacity, Allocator &a = defaultAllocator())
+            : allocator(&a)
+        {
+            ASSERT(capacity < inner::endOfFreeList);
+            if (capacity == 0)
+            {
+                return;
+            }
+
+            auto block = static_cast<unsigned char *>(allocator->allocate(blockSize(capacity), blockAlignment));
+            if (block == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+
+            slotCount = capacity;
+            slots = reinterpret_cast<Slot *>(block);
+            owners = reinterpret_cast<MutableWeakPtr<T> *>(block + ownersOffset(slotCount));
+            liveBits = reinterpret_cast<uint64_t *>(block + bitmapOffset(slotCount));
+            for (uint32_t i = 0; i < slotCount; i++)
+            {
+                new (&owners[i]) MutableWeakPtr<T>();
+            }
+            for (size_t w = 0; w < inner::bitmapWordCount(slotCount); w++)
+            {
+                liveBits[w] = 0;
+            }
+            BG_MEMORY_POISON(slots, sizeof(Slot) * slotCount, freedFill);
+        }
+
+        CompactingHeap(const CompactingHeap<T> &) = delete;
+        CompactingHeap<T> &operator=(const CompactingHeap<T> &) = delete;
+
+        /*
+            Destructor. Every handle from the heap must already be gone. In
+            multithreaded mode objects this thread relocated are reclaimed first;
+            objects relocated by other threads must be reclaimed beforehand.
+        */
+        ~CompactingHeap()
+        {
+#ifdef BG_MEMORY_MULTITHREAD
+            synchronizeRetired();
+#endif // BG_MEMORY_MULTITHREAD
+            ASSERT(live == 0);
+            if (slots == nullptr)
+            {
+                return;
+            }
+            for (uint32_t i = 0; i < slotCount; i++)
+            {
+                owners[i].~MutableWeakPtr<T>();
+            }
+            allocator->deallocate(slots, blockSize(slotCount), blockAlignment);
+        }
+
+        /*
+            Constructs a new object in the lowest free slot.
+
+            @param args arguments forwarded to the constructor of T.
+            @return a handle owning the object, or an empty handle if the heap is full.
+        */
+        template <class... Args>
+        MutableSharedPtr<T> make(Args &&... args)
+        {
+            uint32_t index;
+            {
+                auto lock = lockSlots();
+                index = claimLowestFree();
+            }
+            if (index == inner::endOfFreeList)
+            {
+                return MutableSharedPtr<T>();
+            }
+
+#ifdef BG_MEMORY_DEBUG
+            checkFreeSlot(index);
+#endif // BG_MEMORY_DEBUG
+            T *object;
+            try
+            {
+                object = new (&slots[index]) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                auto lock = lockSlots();
+                markFree(index);
+                throw;
+            }
+
+            MutableSharedPtr<T> handle(object, SlotDeleter(this));
+            auto lock = lockSlots();
+            owners[index] = handle;
+            return handle;
+        }
+
+        /*
+            Compacts the heap by moving live objects from the top of the used
+            span into the lowest free slots, until the live objects are packed
+            at the front or the move budget runs out. Every shared and weak
+            handle to a moved object is retargeted to its new address.
+
+            The moves go through one MutationBatch: handles are retargeted
+            together once every object has been moved, and the old slots are
+            then freed under a single lock (in multithreaded mode, once the
+            batch's single retire entry is reclaimed). No thread may use the
+            heap's objects until defragment returns.
+
+            @param maxMoves upper bound on objects to move, for spreading the work over frames.
+            @return number of objects moved.
+        */
+        uint32_t defragment(uint32_t maxMoves = inner::endOfFreeList)
+        {
+            MutationBatch<T> batch;
+            uint32_t moves = 0;
+            while (moves < maxMoves)
+            {
+                uint32_t from;
+                uint32_t to;
+                {
+                    auto lock = lockSlots();
+                    from = highestMovable();
+                    if (from == inner::endOfFreeList)
+                    {
+                        break;
+                    }
+                    to = claimLowestFree();
+                    if (to == inner::endOfFreeList || to > from)
+                    {
+                        if (to != inner::endOfFreeList)
+                        {
+                            markFree(to);
+                        }
+                        break;
+                    }
+                }
+
+                if (relocate(from, to, batch))
+                {
+                    moves++;
+                }
+            }
+
+            batch.commit([this](T *const *objects, size_t count) { releaseSlots(objects, count); });
+            return moves;
+        }
+
+        /*
+            Gets a snapshot of the heap's occupancy and fragmentation.
+
+            @return the current statistics.
+        */
+        CompactingHeapStats getStats() const
+        {
+            auto lock = lockSlots();
+            CompactingHeapStats stats;
+            stats.capacity = slotCount;
+            stats.liveCount = live;
+            const uint32_t highest = highestLive();
+            stats.highWaterMark = highest == inner::endOfFreeList ? 0 : highest + 1;
+            stats.holes = stats.highWaterMark - live;
+            stats.fragmentation = stats.highWaterMark == 0
+                                      ? 0.0
+                                      : static_cast<double>(stats.holes) / stats.highWaterMark;
+            return stats;
+        }
+
+        /*
+            Checks whether the given pointer refers to a slot inside this heap.
+
+            @param object the pointer to check.
+            @return whether the pointer lies inside the heap's storage.
+        */
+        bool owns(const T *object) const noexcept
+        {
+            auto slot = reinterpret_cast<const Slot *>(object);
+            return slot >= slots && slot < slots + slotCount;
+        }
+
+        /*
+            Gets the maximum number of objects the heap can hold.
+
+            @return the capacity of the heap.
+        */
+        uint32_t capacity() const noexcept
+        {
+            return slotCount;
+        }
+
+        /*
+            Gets the number of live objects in the heap.
+
+            @return count of objects still referenced by a handle.
+        */
+        uint32_t liveCount() const
+        {
+            auto lock = lockSlots();
+            return live;
+        }
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POOLS_COMPACTINGHEAP_HXX_
@@ -0,0 +1,370 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_POOLS_CONCURRENTBULLETPOOL_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_POOLS_CONCURRENTBULLETPOOL_HXX_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "bgmemory/assert.hxx"
+#include "bgmemory/bulletpool.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+#include "bgmemory/allocators/Allocator.hxx"
+
+namespace bg
+{
+    /*
+        Fixed capacity object pool for many threads acquiring and releasing
+        objects of the same type at once.
+
+        Threads never touch the shared free list per object. Each worker owns
+        a Cache holding two magazines of free slots; acquire and release work
+        on the magazines alone, and only when both are empty or both are full
+        does a whole batch of slots move between the cache and the pool's
+        shared free list, a lock free stack of batches. Objects may be released
+        through a different cache than the one which acquired them, their slots
+        simply join the releasing cache.
+
+        The links chaining free slots are kept beside the slot storage rather
+        than inside it, so a slot being reused never races with a thread
+        reading a stale link.
+
+        Up to two batches of free slots can sit in each cache, so acquire can
+        fail on one cache while others hold free slots. Size the pool with
+        that in mind. Every object must be released and every cache destroyed
+        before the pool; the pool does not destroy objects still in use.
+    */
+    template <class T>
+    class ConcurrentBulletPool
+    {
+        using Slot = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+        // Head of the batch stack, a slot index tagged with a counter bumped
+        // on every change to rule out ABA.
+        using TaggedIndex = uint64_t;
+
+        static constexpr TaggedIndex retag(TaggedIndex head, uint32_t index) noexcept
+        {
+            return (((head >> 32) + 1) << 32) | index;
+        }
+
+        // A chain of free slots linked through nextFree, owned by one cache.
+        struct Magazine
+        {
+            uint32_t head = inner::endOfFreeList;
+            uint32_t count = 0;
+        };
+
+        Allocator *allocator = nullptr;
+        Slot *slots = nullptr;
+        uint32_t *nextFree = nullptr;
+        std::atomic<uint32_t> *nextBatch = nullptr;
+        uint32_t *batchCounts = nullptr;
+        uint32_t slotCount = 0;
+        uint32_t magazineSize = 0;
+        std::atomic<TaggedIndex> batchHead{inner::endOfFreeList};
+        std::atomic<uint32_t> cacheCount{0};
+
+        static constexpr size_t blockAlignment =
+            alignof(Slot) > cacheLineSize ? alignof(Slot) : cacheLineSize;
+
+        static size_t nextBatchOffset(size_t capacity) noexcept
+        {
+            return alignUp(capacity * sizeof(Slot), alignof(std::atomic<uint32_t>));
+        }
+
+        static size_t nextFreeOffset(size_t capacity) noexcept
+        {
+            return nextBatchOffset(capacity) + capacity * sizeof(std::atomic<uint32_t>);
+        }
+
+        static size_t batchCountOffset(size_t capacity) noexcept
+        {
+            return nextFreeOffset(capacity) + capacity * sizeof(uint32_t);
+        }
+
+        static size_t blockSize(size_t capacity) noexcept
+        {
+            return batchCountOffset(capacity) + capacity * sizeof(uint32_t);
+        }
+
+        void pushBatch(const Magazine &magazine) noexcept
+        {
+            batchCounts[magazine.head] = magazine.count;
+            TaggedIndex head = batchHead.load(std::memory_order_relaxed);
+            do
+            {
+                nextBatch[magazine.head].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            } while (!batchHead.compare_exchange_weak(head, retag(head, magazine.head),
+                                                      std::memory_order_release,
+                                                      std::memory_order_relaxed));
+        }
+
+        Magazine popBatch() noexcept
+        {
+            Magazine magazine;
+            TaggedIndex head = batchHead.load(std::memory_order_acquire);
+            while (static_cast<uint32_t>(head) != inner::endOfFreeList)
+            {
+                const uint32_t index = static_cast<uint32_t>(head);
+                const uint32_t next = nextBatch[index].load(std::memory_order_relaxed);
+                if (batchHead.compare_exchange_weak(head, retag(head, next),
+                                                    std::memory_order_acquire,
+                                                    std::memory_order_acquire))
+                {
+                    magazine.head = index;
+                    magazine.count = batchCounts[index];
+                    break;
+                }
+            }
+            return magazine;
+        }
+
+    public:
+        /*
+            Per thread front end of a ConcurrentBulletPool. A cache must only be
+            used by one thread at a time, and must not outlive its pool. Free
+            slots held by the cache go back to the pool when it is destroyed.
+        */
+        class Cache
+        {
+            ConcurrentBulletPool<T> *pool;
+            Magazine loaded;
+            Magazine previous;
+
+        public:
+            /*
+                Constructs an empty cache over the given pool.
+
+                @param p the pool to draw slots from.
+            */
+            explicit Cache(ConcurrentBulletPool<T> &p) noexcept : pool(&p)
+            {
+                pool->cacheCount.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            Cache(const Cache &) = delete;
+            Cache &operator=(const Cache &) = delete;
+
+            /*
+                Move constructor, takes over the other cache's free slots.
+
+                @param other the cache to move from, left unusable.
+            */
+            Cache(Cache &&other) noexcept
+                : pool(other.pool), loaded(other.loaded), previous(other.previous)
+            {
+                other.pool = nullptr;
+                other.loaded = Magazine();
+                other.previous = Magazine();
+            }
+
+            /*
+                Destructor, returns the cached free slots to the pool.
+            */
+            ~Cache()
+            {
+                if (pool != nullptr)
+                {
+                    flush();
+                    pool->cacheCount.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+
+            /*
+                Constructs a new object in a free slot.
+
+                @param args arguments forwarded to the constructor of T.
+                @return pointer to the new object, or nullptr if no free slot could be found.
+            */
+            template <class... Args>
+            T *acquire(Args &&... args)
+            {
+                if (loaded.count == 0)
+                {
+                    if (previous.count > 0)
+                    {
+                        std::swap(loaded, previous);
+                    }
+                    else
+                    {
+                        loaded = pool->popBatch();
+                        if (loaded.count == 0)
+                        {
+                            return nullptr;
+                        }
+                    }
+                }
+
+                const uint32_t index = loaded.head;
+                T *object = new (&pool->slots[index]) T(std::forward<Args>(args)...);
+                loaded.head = pool->nextFree[index];
+                loaded.count--;
+                return object;
+            }
+
+            /*
+                Destroys an object from this cache's pool and keeps its slot in
+                the cache for reuse. The object may have been acquired through
+                any cache. Releasing nullptr does nothing.
+
+                @param object pointer to the object to release.
+            */
+            void release(T *object) noexcept
+            {
+                if (object == nullptr)
+                {
+                    return;
+                }
+
+                ASSERT(pool->owns(object));
+                const uint32_t index = static_cast<uint32_t>(reinterpret_cast<Slot *>(object) - pool->slots);
+                object->~T();
+
+                if (loaded.count == pool->magazineSize)
+                {
+                    if (previous.count > 0)
+                    {
+                        pool->pushBatch(previous);
+                    }
+                    previous = loaded;
+                    loaded = Magazine();
+                }
+                pool->nextFree[index] = loaded.head;
+                loaded.head = index;
+                loaded.count++;
+            }
+
+            /*
+                Returns every free slot held by the cache to the pool, so other
+                caches can use them.
+            */
+            void flush() noexcept
+            {
+                if (loaded.count > 0)
+                {
+                    pool->pushBatch(loaded);
+                    loaded = Magazine();
+                }
+                if (previous.count > 0)
+                {
+                    pool->pushBatch(previous);
+                    previous = Magazine();
+                }
+            }
+
+            /*
+                Gets the number of free slots held by the cache.
+
+                @return count of cached free slots.
+            */
+            uint32_t cachedCount() const noexcept
+            {
+                return loaded.count + previous.count;
+            }
+        };
+
+        /*
+            Constructs a pool with room for the given number of objects. This is
+            the only point at which the pool allocates memory.
+
+            @param capacity maximum number of live objects the pool can hold.
+            @param batchSize number of slots moved between a cache and the pool at a time.
+            @param a allocator providing the slot storage, must outlive the pool.
+            @throws std::bad_alloc if the allocator cannot provide the storage.
+        */
+        explicit ConcurrentBulletPool(uint32_t capacity, uint32_t batchSize = 32,
+                                      Allocator &a = defaultAllocator())
+            : allocator(&a), magazineSize(batchSize)
+        {
+            ASSERT(capacity < inner::endOfFreeList);
+            ASSERT(batchSize > 0);
+            if (capacity == 0)
+            {
+                return;
+            }
+
+            auto block = static_cast<unsigned char *>(allocator->allocate(blockSize(capacity), blockAlignment));
+            if (block == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+
+            slotCount = capacity;
+            slots = reinterpret_cast<Slot *>(block);
+            nextBatch = reinterpret_cast<std::atomic<uint32_t> *>(block + nextBatchOffset(slotCount));
+            nextFree = reinterpret_cast<uint32_t *>(block + nextFreeOffset(slotCount));
+            batchCounts = reinterpret_cast<uint32_t *>(block + batchCountOffset(slotCount));
+            for (uint32_t i = 0; i < slotCount; i++)
+            {
+                new (&nextBatch[i]) std::atomic<uint32_t>(inner::endOfFreeList);
+                nextFree[i] = i + 1;
+            }
+
+            // Pushed from the back so the lowest slots are handed out first.
+            for (uint32_t first = (slotCount - 1) / magazineSize * magazineSize;; first -= magazineSize)
+            {
+                Magazine batch;
+                batch.head = first;
+                batch.count = slotCount - first < magazineSize ? slotCount - first : magazineSize;
+                pushBatch(batch);
+                if (first == 0)
+                {
+                    break;
+                }
+            }
+        }
+
+        ConcurrentBulletPool(const ConcurrentBulletPool<T> &) = delete;
+        ConcurrentBulletPool<T> &operator=(const ConcurrentBulletPool<T> &) = delete;
+
+        /*
+            Destructor. Every cache must already be destroyed.
+        */
+        ~ConcurrentBulletPool()
+        {
+            ASSERT(cacheCount.load() == 0);
+            if (slots != nullptr)
+            {
+                allocator->deallocate(slots, blockSize(slotCount), blockAlignment);
+            }
+        }
+
+        /*
+            Checks whether the given pointer refers to a slot inside this pool.
+
+            @param object the pointer to check.
+            @return whether the pointer lies inside the pool's slot storage.
+        */
+        bool owns(const T *object) const noexcept
+        {
+            auto slot = reinterpret_cast<const Slot *>(object);
+            return slot >= slots && slot < slots + slotCount;
+        }
+
+        /*
+            Gets the maximum number of objects the pool can hold.
+
+            @return the capacity of the pool.
+        */
+        uint32_t capacity() const noexcept
+        {
+            return slotCount;
+        }
+
+        /*
+            Gets the number of slots moved between a cache and the pool at a time.
+
+            @return the batch size.
+        */
+        uint32_t batchSize() const noexcept
+        {
+            return magazineSize;
+        }
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POOLS_CONCURRENTBULLETPOOL_HXX_
@@ -0,0 +1,384 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_POOLS_GROWABLEPOOL_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_POOLS_GROWABLEPOOL_HXX_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <utility>
+
+#include "bgmemory/assert.hxx"
+#include "bgmemory/bulletpool.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+#include "bgmemory/allocators/VirtualArena.hxx"
+#include "bgmemory/debug/MemoryDebug.hxx"
+
+namespace bg
+{
+    /*
+        Object pool which grows on demand without ever moving its objects, for
+        pools whose peak size is unknown or far above their usual size.
+
+        The pool works like a BulletPool, with an intrusive free list and a
+        bitmap of live slots, but its slots and bitmap live in VirtualArenas
+        reserved for the maximum capacity. When the free list runs dry the
+        pool commits another chunk of slots in place, so pointers to objects
+        stay valid for as long as the objects live and growing copies
+        nothing. trim hands trailing chunks with no live objects back to the
+        system.
+
+        With BG_MEMORY_DEBUG, releasing an object twice is reported through
+        reportMemoryError.
+
+        The pool is not thread safe.
+    */
+    template <class T>
+    class GrowablePool
+    {
+        using Slot = inner::PoolSlot<T>;
+
+        VirtualArena slotArena;
+        VirtualArena bitArena;
+        Slot *slots = nullptr;
+        uint64_t *liveBits = nullptr;
+        uint32_t maxSlots = 0;
+        uint32_t chunkSlots = 0;
+        uint32_t slotCount = 0;
+        uint32_t freeHead = inner::endOfFreeList;
+        uint32_t live = 0;
+
+        // Slots committed per chunk, a whole number of bitmap words filling
+        // at least one commit granule.
+        static uint32_t slotsPerChunk() noexcept
+        {
+            const size_t slotsPerGranule = VirtualArena::defaultCommitGranularity / sizeof(Slot);
+            return static_cast<uint32_t>(alignUp(slotsPerGranule > 0 ? slotsPerGranule : 1, 64));
+        }
+
+        uint32_t &nextFree(uint32_t index) noexcept
+        {
+            return *reinterpret_cast<uint32_t *>(&slots[index]);
+        }
+
+        bool isLive(uint32_t index) const noexcept
+        {
+            return (liveBits[index / 64] & (uint64_t(1) << (index % 64))) != 0;
+        }
+
+        // Commits the next chunk of slots and pushes them onto the free list.
+        bool grow() noexcept
+        {
+            if (slotCount == maxSlots)
+            {
+                return false;
+            }
+
+            const uint32_t count = maxSlots - slotCount < chunkSlots ? maxSlots - slotCount : chunkSlots;
+            const size_t words = inner::bitmapWordCount(count);
+            auto newSlots = static_cast<Slot *>(slotArena.allocate(count * sizeof(Slot), alignof(Slot)));
+            if (newSlots == nullptr)
+            {
+                return false;
+            }
+            auto newBits = static_cast<uint64_t *>(bitArena.allocate(words * sizeof(uint64_t), alignof(uint64_t)));
+            if (newBits == nullptr)
+            {
+                slotArena.rollback(slotArena.getMarker() - count * sizeof(Slot));
+                return false;
+            }
+            ASSERT(newSlots == slots + slotCount && newBits == liveBits + inner::bitmapWordCount(slotCount));
+
+            for (size_t w = 0; w < words; w++)
+            {
+                newBits[w] = 0;
+            }
+            for (uint32_t i = slotCount; i < slotCount + count; i++)
+            {
+                nextFree(i) = i + 1 < slotCount + count ? i + 1 : freeHead;
+            }
+            freeHead = slotCount;
+            slotCount += count;
+            return true;
+        }
+
+        // Relinks every free slot below slotCount into an ascending free list.
+        void rebuildFreeList() noexcept
+        {
+            freeHead = inner::endOfFreeList;
+            for (uint32_t i = slotCount; i > 0; i--)
+            {
+                if (!isLive(i - 1))
+                {
+                    nextFree(i - 1) = freeHead;
+                    freeHead = i - 1;
+                }
+            }
+        }
+
+        template <class PoolT, class F>
+        static void visitLive(PoolT &pool, F &f)
+        {
+            const size_t words = inner::bitmapWordCount(pool.slotCount);
+            for (size_t w = 0; w < words; w++)
+            {
+                uint64_t bits = pool.liveBits[w];
+                while (bits != 0)
+                {
+                    const size_t index = w * 64 + inner::lowestSetBit(bits);
+                    bits &= bits - 1;
+                    f(*reinterpret_cast<T *>(&pool.slots[index]));
+                }
+            }
+        }
+
+    public:
+        /*
+            Constructs a pool which can grow to the given number of objects,
+            reserving address space for all of them. No memory is committed
+            until the first acquire.
+
+            @param maxCapacity maximum number of live objects the pool can hold.
+            @throws std::bad_alloc if the address space cannot be reserved.
+        */
+        explicit GrowablePool(uint32_t maxCapacity)
+            : slotArena(static_cast<size_t>(maxCapacity) * sizeof(Slot), slotsPerChunk() * sizeof(Slot)),
+              bitArena(inner::bitmapWordCount(maxCapacity) * sizeof(uint64_t), pageSize())
+        {
+            ASSERT(maxCapacity < inner::endOfFreeList && alignof(Slot) <= pageSize());
+            maxSlots = maxCapacity;
+            chunkSlots = slotsPerChunk();
+            slots = static_cast<Slot *>(slotArena.data());
+            liveBits = static_cast<uint64_t *>(bitArena.data());
+        }
+
+        GrowablePool(const GrowablePool<T> &) = delete;
+        GrowablePool<T> &operator=(const GrowablePool<T> &) = delete;
+
+        /*
+            Destructor. Destroys any objects still live in the pool before
+            releasing the address space.
+        */
+        ~GrowablePool()
+        {
+            if (live > 0)
+            {
+                forEach([](T &object) { object.~T(); });
+            }
+        }
+
+        /*
+            Constructs a new object in a free slot, committing another chunk of
+            slots if none are free.
+
+            @param args arguments forwarded to the constructor of T.
+            @return pointer to the new object, or nullptr if the pool is at its
+            maximum capacity or more memory cannot be committed.
+        */
+        template <class... Args>
+        T *acquire(Args &&... args)
+        {
+            if (freeHead == inner::endOfFreeList && !grow())
+            {
+                return nullptr;
+            }
+
+            const uint32_t index = freeHead;
+            const uint32_t next = nextFree(index);
+            // Unlinked first, so a throwing constructor cannot leave the free
+            // list running through a half written slot.
+            freeHead = next;
+            T *object;
+            try
+            {
+                object = new (&slots[index]) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                nextFree(index) = next;
+                freeHead = index;
+                throw;
+            }
+            liveBits[index / 64] |= uint64_t(1) << (index % 64);
+            live++;
+            return object;
+        }
+
+        /*
+            Destroys an object previously acquired from this pool and returns its
+            slot to the free list. Releasing nullptr does nothing.
+
+            @param object pointer to the object to release.
+        */
+        void release(T *object) noexcept
+        {
+            if (object == nullptr)
+            {
+                return;
+            }
+
+            ASSERT(owns(object));
+            const uint32_t index = static_cast<uint32_t>(reinterpret_cast<Slot *>(object) - slots);
+#ifdef BG_MEMORY_DEBUG
+            if (!isLive(index))
+            {
+                reportMemoryError(MemoryError::DoubleFree, object, "object was already released to its GrowablePool");
+                return;
+            }
+#else
+            ASSERT(isLive(index));
+#endif // BG_MEMORY_DEBUG
+
+            object->~T();
+            liveBits[index / 64] &= ~(uint64_t(1) << (index % 64));
+            nextFree(index) = freeHead;
+            freeHead = index;
+            live--;
+        }
+
+        /*
+            Destroys every live object. The committed slots are kept for reuse;
+            call trim afterwards to give them back.
+        */
+        void clear() noexcept
+        {
+            if (live > 0)
+            {
+                forEach([](T &object) { object.~T(); });
+            }
+            for (size_t w = 0; w < inner::bitmapWordCount(slotCount); w++)
+            {
+                liveBits[w] = 0;
+            }
+            live = 0;
+            rebuildFreeList();
+        }
+
+        /*
+            Decommits trailing chunks of slots which hold no live objects,
+            returning their memory to the system. Slots below the highest live
+            object stay committed, so objects never move. Takes time linear in
+            the committed capacity.
+        */
+        void trim() noexcept
+        {
+            uint32_t keep = slotCount;
+            while (keep > 0)
+            {
+                const uint32_t chunkStart = (keep - 1) / chunkSlots * chunkSlots;
+                bool empty = true;
+                for (size_t w = chunkStart / 64; w < inner::bitmapWordCount(keep); w++)
+                {
+                    empty = empty && liveBits[w] == 0;
+                }
+                if (!empty)
+                {
+                    break;
+                }
+                keep = chunkStart;
+            }
+            if (keep == slotCount)
+            {
+                return;
+            }
+
+            slotCount = keep;
+            slotArena.rollback(slotCount * sizeof(Slot));
+            bitArena.rollback(inner::bitmapWordCount(slotCount) * sizeof(uint64_t));
+            slotArena.trim();
+            bitArena.trim();
+            rebuildFreeList();
+        }
+
+        /*
+            Calls the given function object with a reference to every live object,
+            in the order the objects are laid out in memory.
+
+            The function must not acquire or release objects from this pool.
+
+            @param f function object callable with a T&.
+        */
+        template <class F>
+        void forEach(F &&f)
+        {
+            visitLive(*this, f);
+        }
+
+        /*
+            Calls the given function object with a constant reference to every
+            live object, in the order the objects are laid out in memory.
+
+            @param f function object callable with a const T&.
+        */
+        template <class F>
+        void forEach(F &&f) const
+        {
+            auto constF = [&f](T &object) { f(static_cast<const T &>(object)); };
+            visitLive(*this, constF);
+        }
+
+        /*
+            Checks whether the given pointer refers to a committed slot inside
+            this pool.
+
+            @param object the pointer to check.
+            @return whether the pointer lies inside the pool's slot storage.
+        */
+        bool owns(const T *object) const noexcept
+        {
+            auto slot = reinterpret_cast<const Slot *>(object);
+            return slot >= slots && slot < slots + slotCount;
+        }
+
+        /*
+            Gets the number of slots currently committed.
+
+            @return the current capacity of the pool.
+        */
+        uint32_t capacity() const noexcept
+        {
+            return slotCount;
+        }
+
+        /*
+            Gets the number of objects the pool can grow to.
+
+            @return the maximum capacity of the pool.
+        */
+        uint32_t maxCapacity() const noexcept
+        {
+            return maxSlots;
+        }
+
+        /*
+            Gets the amount of memory currently committed for slots and bitmap.
+
+            @return committed bytes.
+        */
+        size_t committedBytes() const noexcept
+        {
+            return slotArena.committed() + bitArena.committed();
+        }
+
+        /*
+            Gets the number of live objects in the pool.
+
+            @return count of acquired and not yet released objects.
+        */
+        uint32_t liveCount() const noexcept
+        {
+            return live;
+        }
+
+        /*
+            Gets whether the pool holds its maximum number of objects.
+
+            @return whether the next acquire will fail.
+        */
+        bool full() const noexcept
+        {
+            return live == maxSlots;
+        }
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POOLS_GROWABLEPOOL_HXX_
@@ -0,0 +1,518 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_POOLS_PERSISTENTPOOL_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_POOLS_PERSISTENTPOOL_HXX_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "bgmemory/assert.hxx"
+#include "bgmemory/bulletpool.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+#include "bgmemory/debug/MemoryDebug.hxx"
+
+namespace bg::inner
+{
+    /*
+        A file mapped read/write into the address space, shared with the file
+        so writes to the mapping end up in the file. Pages are only read from
+        disk when first touched.
+    */
+    class MappedFile
+    {
+        void *mapping = nullptr;
+        size_t mappedSize = 0;
+        bool wasCreated = false;
+
+    public:
+        /*
+            Maps the file at the given path, creating it with the given size
+            if it does not exist or is empty. A newly created file reads as
+            zeroes.
+
+            @param path path of the file to map.
+            @param createSize size to give the file when creating it.
+            @throws std::system_error if the file cannot be opened, sized or mapped.
+        */
+        MappedFile(const std::string &path, size_t createSize);
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        /*
+            Destructor, unmaps the file. Modified pages are written back by the
+            operating system; use flush to wait for them.
+        */
+        ~MappedFile();
+
+        /*
+            Writes every modified page back to the file, returning once the
+            data is on disk.
+
+            @throws std::system_error if the pages cannot be written.
+        */
+        void flush();
+
+        void *data() const noexcept
+        {
+            return mapping;
+        }
+
+        size_t size() const noexcept
+        {
+            return mappedSize;
+        }
+
+        // Whether the file was created by this mapping rather than opened.
+        bool created() const noexcept
+        {
+            return wasCreated;
+        }
+    };
+
+    // Identifies a file as a PersistentPool ("BGPP").
+    constexpr uint32_t persistentPoolMagic = 0x50504742u;
+
+    // Bumped whenever the layout of a PersistentPool file changes.
+    constexpr uint32_t persistentPoolVersion = 1;
+
+    /*
+        Header at the start of a PersistentPool file, describing the slot
+        layout the file was created with and the pool's state.
+    */
+    struct PersistentPoolHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t fileSize;
+        uint64_t slotSize;
+        uint64_t slotAlignment;
+        uint64_t slotsOffset;
+        uint32_t capacity;
+        uint32_t live;
+        // Head of the list of released slots.
+        uint32_t freeHead;
+        // Slots below this index have been handed out at least once.
+        uint32_t bumpIndex;
+    };
+
+    /*
+        Gets the offset of the slots in a PersistentPool file, after the
+        header and aligned for the slots.
+
+        @param slotAlignment alignment of a slot.
+        @return offset of the first slot from the start of the file.
+    */
+    constexpr size_t persistentSlotsOffset(size_t slotAlignment)
+    {
+        return alignUp(sizeof(PersistentPoolHeader),
+                       slotAlignment > cacheLineSize ? slotAlignment : cacheLineSize);
+    }
+} // namespace bg::inner
+
+namespace bg
+{
+    /*
+        Handle to an object in a PersistentPool: the byte offset of the
+        object's slot from the start of the pool's file. Handles do not depend
+        on where the file is mapped, so they stay valid across process
+        restarts and can be stored inside the pool's own objects to link them
+        together. A default constructed handle refers to nothing.
+    */
+    struct PersistentHandle
+    {
+        uint64_t offset = 0;
+
+        explicit operator bool() const noexcept
+        {
+            return offset != 0;
+        }
+
+        bool operator==(const PersistentHandle &other) const noexcept
+        {
+            return offset == other.offset;
+        }
+
+        bool operator!=(const PersistentHandle &other) const noexcept
+        {
+            return offset != other.offset;
+        }
+    };
+
+    /*
+        Fixed capacity pool of trivially copyable records kept in a memory
+        mapped file, so a large pool can be saved and loaded back without any
+        serialisation. Opening an existing file only maps it; pages are read
+        from disk as they are first touched.
+
+        The file holds a small header followed by a block laid out exactly
+        like a BulletPool's: the slots, with released slots chained through an
+        intrusive free list, then a bitmap of live slots. Slots which have
+        never been used are handed out from a bump index instead of being
+        threaded onto the free list up front, so creating a pool does not
+        touch every page of the file.
+
+        Objects are addressed by PersistentHandle rather than by pointer, as
+        the file may be mapped at a different address next time. Records which
+        refer to each other should store handles.
+
+        The file is only guaranteed to be consistent after flush or once the
+        pool is destroyed. It is tied to the machine that wrote it: the header
+        checks the slot size and alignment, not the type or byte order.
+
+        With BG_MEMORY_DEBUG, releasing an object twice is reported through
+        reportMemoryError.
+
+        The pool is not thread safe, and a file must only be opened by one
+        pool at a time.
+    */
+    template <class T>
+    class PersistentPool
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "PersistentPool records are saved as raw bytes and must be trivially copyable");
+
+        using Slot = inner::PoolSlot<T>;
+
+        inner::MappedFile file;
+        inner::PersistentPoolHeader *header;
+        Slot *slots;
+        uint64_t *liveBits;
+
+        static size_t fileSizeFor(uint32_t capacity) noexcept
+        {
+            return inner::persistentSlotsOffset(alignof(Slot)) + inner::slotBlockSize(capacity, sizeof(Slot));
+        }
+
+        uint32_t &nextFree(uint32_t index) noexcept
+        {
+            return *reinterpret_cast<uint32_t *>(&slots[index]);
+        }
+
+        bool isLive(uint32_t index) const noexcept
+        {
+            return (liveBits[index / 64] & (uint64_t(1) << (index % 64))) != 0;
+        }
+
+        uint64_t offsetOf(uint32_t index) const noexcept
+        {
+            return header->slotsOffset + uint64_t(index) * sizeof(Slot);
+        }
+
+        // Gets the slot index of a handle, or endOfFreeList if it names no slot.
+        uint32_t indexOf(PersistentHandle handle) const noexcept
+        {
+            if (handle.offset < header->slotsOffset)
+            {
+                return inner::endOfFreeList;
+            }
+            const uint64_t relative = handle.offset - header->slotsOffset;
+            if (relative % sizeof(Slot) != 0 || relative / sizeof(Slot) >= header->capacity)
+            {
+                return inner::endOfFreeList;
+            }
+            return static_cast<uint32_t>(relative / sizeof(Slot));
+        }
+
+        void initialise(uint32_t capacity) noexcept
+        {
+            header->magic = inner::persistentPoolMagic;
+            header->version = inner::persistentPoolVersion;
+            header->fileSize = file.size();
+            header->slotSize = sizeof(Slot);
+            header->slotAlignment = alignof(Slot);
+            header->slotsOffset = inner::persistentSlotsOffset(alignof(Slot));
+            header->capacity = capacity;
+            header->live = 0;
+            header->freeHead = inner::endOfFreeList;
+            header->bumpIndex = 0;
+        }
+
+        bool isCompatible() const noexcept
+        {
+            return header->magic == inner::persistentPoolMagic &&
+                   header->version == inner::persistentPoolVersion &&
+                   header->slotSize == sizeof(Slot) &&
+                   header->slotAlignment == alignof(Slot) &&
+                   header->slotsOffset == inner::persistentSlotsOffset(alignof(Slot)) &&
+                   header->capacity < inner::endOfFreeList &&
+                   header->fileSize == file.size() &&
+                   fileSizeFor(header->capacity) == file.size() &&
+                   header->bumpIndex <= header->capacity &&
+                   header->live <= header->bumpIndex &&
+                   (header->freeHead < header->bumpIndex || header->freeHead == inner::endOfFreeList);
+        }
+
+        template <class PoolT, class F>
+        static void visitLive(PoolT &pool, F &f)
+        {
+            const size_t words = inner::bitmapWordCount(pool.header->bumpIndex);
+            for (size_t w = 0; w < words; w++)
+            {
+                uint64_t bits = pool.liveBits[w];
+                while (bits != 0)
+                {
+                    const size_t index = w * 64 + inner::lowestSetBit(bits);
+                    bits &= bits - 1;
+                    f(*reinterpret_cast<T *>(&pool.slots[index]));
+                }
+            }
+        }
+
+    public:
+        using Handle = PersistentHandle;
+
+        /*
+            Opens the pool stored in the given file, or creates a new empty
+            pool there if the file does not exist. An existing file keeps the
+            capacity it was created with.
+
+            @param path path of the file holding the pool.
+            @param capacity maximum number of objects, used when creating the file.
+            @throws std::system_error if the file cannot be opened or mapped.
+            @throws std::runtime_error if an existing file was not written by a
+            PersistentPool with the same slot layout.
+        */
+        PersistentPool(const std::string &path, uint32_t capacity)
+            : file(path, fileSizeFor(capacity))
+        {
+            ASSERT(capacity < inner::endOfFreeList);
+            header = static_cast<inner::PersistentPoolHeader *>(file.data());
+            if (file.created())
+            {
+                initialise(capacity);
+            }
+            else if (file.size() < sizeof(inner::PersistentPoolHeader) || !isCompatible())
+            {
+                throw std::runtime_error(path + " is not a compatible PersistentPool file");
+            }
+
+            auto block = static_cast<unsigned char *>(file.data()) + header->slotsOffset;
+            slots = reinterpret_cast<Slot *>(block);
+            liveBits = reinterpret_cast<uint64_t *>(block + inner::slotBitmapOffset(header->capacity, sizeof(Slot)));
+        }
+
+        PersistentPool(const PersistentPool<T> &) = delete;
+        PersistentPool<T> &operator=(const PersistentPool<T> &) = delete;
+
+        /*
+            Constructs a new object in a free slot.
+
+            @param args arguments forwarded to the constructor of T.
+            @return handle to the new object, or an empty handle if the pool is full.
+        */
+        template <class... Args>
+        Handle acquire(Args &&... args)
+        {
+            uint32_t index;
+            const bool reused = header->freeHead != inner::endOfFreeList;
+            if (reused)
+            {
+                index = header->freeHead;
+                header->freeHead = nextFree(index);
+            }
+            else if (header->bumpIndex < header->capacity)
+            {
+                index = header->bumpIndex++;
+            }
+            else
+            {
+                return Handle();
+            }
+
+            try
+            {
+                new (&slots[index]) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                // Hand the slot back where it came from.
+                if (reused)
+                {
+                    nextFree(index) = header->freeHead;
+                    header->freeHead = index;
+                }
+                else
+                {
+                    header->bumpIndex--;
+                }
+                throw;
+            }
+            liveBits[index / 64] |= uint64_t(1) << (index % 64);
+            header->live++;
+            return Handle{offsetOf(index)};
+        }
+
+        /*
+            Returns an object's slot to the free list. Releasing an empty
+            handle does nothing.
+
+            @param handle handle to the object to release.
+        */
+        void release(Handle handle) noexcept
+        {
+            if (!handle)
+            {
+                return;
+            }
+
+            const uint32_t index = indexOf(handle);
+            ASSERT(index != inner::endOfFreeList);
+#ifdef BG_MEMORY_DEBUG
+            if (!isLive(index))
+            {
+                reportMemoryError(MemoryError::DoubleFree, &slots[index],
+                                  "object was already released to its PersistentPool");
+                return;
+            }
+#else
+            ASSERT(isLive(index));
+#endif // BG_MEMORY_DEBUG
+
+            liveBits[index / 64] &= ~(uint64_t(1) << (index % 64));
+            nextFree(index) = header->freeHead;
+            header->freeHead = index;
+            header->live--;
+        }
+
+        /*
+            Releases every object, returning the pool to its freshly created
+            state.
+        */
+        void clear() noexcept
+        {
+            for (size_t w = 0; w < inner::bitmapWordCount(header->bumpIndex); w++)
+            {
+                liveBits[w] = 0;
+            }
+            header->freeHead = inner::endOfFreeList;
+            header->bumpIndex = 0;
+            header->live = 0;
+        }
+
+        /*
+            Looks up the object a handle refers to.
+
+            @param handle handle to look up.
+            @return pointer to the object, or nullptr if the handle is empty,
+            does not belong to this pool or its object has been released.
+            Valid until the pool is destroyed or the object released.
+        */
+        T *get(Handle handle) noexcept
+        {
+            const uint32_t index = indexOf(handle);
+            return index != inner::endOfFreeList && isLive(index) ? reinterpret_cast<T *>(&slots[index]) : nullptr;
+        }
+
+        /*
+            Looks up the object a handle refers to.
+
+            @param handle handle to look up.
+            @return pointer to the object, or nullptr if the handle is empty,
+            does not belong to this pool or its object has been released.
+        */
+        const T *get(Handle handle) const noexcept
+        {
+            const uint32_t index = indexOf(handle);
+            return index != inner::endOfFreeList && isLive(index) ? reinterpret_cast<const T *>(&slots[index]) : nullptr;
+        }
+
+        /*
+            Gets the handle of an object in this pool.
+
+            @param object pointer to an object acquired from this pool.
+            @return handle to the object.
+        */
+        Handle handleOf(const T *object) const noexcept
+        {
+            ASSERT(owns(object));
+            const auto index = static_cast<uint32_t>(reinterpret_cast<const Slot *>(object) - slots);
+            return Handle{offsetOf(index)};
+        }
+
+        /*
+            Calls the given function object with a reference to every live
+            object, in the order the objects are laid out in the file.
+
+            The function must not acquire or release objects from this pool.
+
+            @param f function object callable with a T&.
+        */
+        template <class F>
+        void forEach(F &&f)
+        {
+            visitLive(*this, f);
+        }
+
+        /*
+            Calls the given function object with a constant reference to every
+            live object, in the order the objects are laid out in the file.
+
+            @param f function object callable with a const T&.
+        */
+        template <class F>
+        void forEach(F &&f) const
+        {
+            auto constF = [&f](T &object) { f(static_cast<const T &>(object)); };
+            visitLive(*this, constF);
+        }
+
+        /*
+            Writes the pool back to its file, returning once it is on disk.
+
+            @throws std::system_error if the file cannot be written.
+        */
+        void flush()
+        {
+            file.flush();
+        }
+
+        /*
+            Checks whether the given pointer refers to a slot inside this pool.
+
+            @param object the pointer to check.
+            @return whether the pointer lies inside the pool's slot storage.
+        */
+        bool owns(const T *object) const noexcept
+        {
+            auto slot = reinterpret_cast<const Slot *>(object);
+            return slot >= slots && slot < slots + header->capacity;
+        }
+
+        /*
+            Gets the maximum number of objects the pool can hold.
+
+            @return the capacity of the pool.
+        */
+        uint32_t capacity() const noexcept
+        {
+            return header->capacity;
+        }
+
+        /*
+            Gets the number of live objects in the pool.
+
+            @return count of acquired and not yet released objects.
+        */
+        uint32_t liveCount() const noexcept
+        {
+            return header->live;
+        }
+
+        /*
+            Gets whether every slot in the pool is in use.
+
+            @return whether the next acquire will fail.
+        */
+        bool full() const noexcept
+        {
+            return header->freeHead == inner::endOfFreeList && header->bumpIndex == header->capacity;
+        }
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POOLS_PERSISTENTPOOL_HXX_
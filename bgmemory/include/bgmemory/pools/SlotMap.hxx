@@ -0,0 +1,280 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_POOLS_SLOTMAP_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_POOLS_SLOTMAP_HXX_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "bgmemory/assert.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+#include "bgmemory/allocators/Allocator.hxx"
+#include "bgmemory/pools/inner/SlotIndex.hxx"
+
+namespace bg
+{
+    /*
+        Fixed capacity table of values addressed through generational handles,
+        for entity style data which is mostly iterated and sometimes looked up.
+
+        Values are kept densely packed at the start of one cache line aligned
+        block, so iterating is a linear scan. Handles go through a slot array
+        holding each value's dense index; erasing moves the last value into
+        the hole and patches its slot, so insert and erase are O(1) and values
+        never leave the dense range. Each slot carries a generation bumped on
+        erase, so a handle to an erased value is detected rather than finding
+        whatever moved in after it.
+
+        Erase moves values around, so raw pointers and references into the map
+        are only valid until the next erase; handles stay valid until their
+        own value is erased. T must be nothrow move constructible.
+
+        The map is not thread safe.
+    */
+    template <class T>
+    class SlotMap
+    {
+        static_assert(std::is_nothrow_move_constructible<T>::value,
+                      "SlotMap values are moved on erase and must not throw doing so");
+
+        using Value = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+        Allocator *allocator = nullptr;
+        Value *values = nullptr;
+        inner::SlotIndex index;
+
+        static constexpr size_t blockAlignment =
+            alignof(Value) > cacheLineSize ? alignof(Value) : cacheLineSize;
+
+        static size_t indexOffset(size_t capacity) noexcept
+        {
+            return alignUp(capacity * sizeof(Value), inner::SlotIndex::storageAlignment);
+        }
+
+        static size_t blockSize(size_t capacity) noexcept
+        {
+            return indexOffset(capacity) + inner::SlotIndex::storageSize(static_cast<uint32_t>(capacity));
+        }
+
+        T *valueAt(uint32_t denseIndex) noexcept
+        {
+            return reinterpret_cast<T *>(&values[denseIndex]);
+        }
+
+        const T *valueAt(uint32_t denseIndex) const noexcept
+        {
+            return reinterpret_cast<const T *>(&values[denseIndex]);
+        }
+
+    public:
+        using Handle = SlotMapHandle;
+
+        /*
+            Constructs a map with room for the given number of values. This is
+            the only point at which the map allocates memory.
+
+            @param capacity maximum number of values the map can hold.
+            @param a allocator providing the storage, must outlive the map.
+            @throws std::bad_alloc if the allocator cannot provide the storage.
+        */
+        explicit SlotMap(uint32_t capacity, Allocator &a = defaultAllocator())
+            : allocator(&a)
+        {
+            ASSERT(capacity < inner::endOfFreeList);
+            if (capacity == 0)
+            {
+                return;
+            }
+
+            auto block = static_cast<unsigned char *>(allocator->allocate(blockSize(capacity), blockAlignment));
+            if (block == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+
+            values = reinterpret_cast<Value *>(block);
+            index.attach(block + indexOffset(capacity), capacity);
+        }
+
+        SlotMap(const SlotMap<T> &) = delete;
+        SlotMap<T> &operator=(const SlotMap<T> &) = delete;
+
+        /*
+            Destructor. Destroys every value still in the map before releasing
+            the storage.
+        */
+        ~SlotMap()
+        {
+            if (values != nullptr)
+            {
+                clear();
+                allocator->deallocate(values, blockSize(index.capacity()), blockAlignment);
+            }
+        }
+
+        /*
+            Constructs a new value at the end of the dense range.
+
+            @param args arguments forwarded to the constructor of T.
+            @return handle to the new value, or an empty handle if the map is full.
+        */
+        template <class... Args>
+        Handle insert(Args &&... args)
+        {
+            if (index.full())
+            {
+                return Handle();
+            }
+
+            new (&values[index.size()]) T(std::forward<Args>(args)...);
+            return index.acquire();
+        }
+
+        /*
+            Destroys the value a handle refers to. The last value in the dense
+            range is moved into its place.
+
+            @param handle handle to the value to erase.
+            @return whether a value was erased, false for stale or empty handles.
+        */
+        bool erase(Handle handle) noexcept
+        {
+            if (!index.isCurrent(handle))
+            {
+                return false;
+            }
+
+            const uint32_t hole = index.denseIndex(handle);
+            const uint32_t last = index.size() - 1;
+            valueAt(hole)->~T();
+            if (hole != last)
+            {
+                new (&values[hole]) T(std::move(*valueAt(last)));
+                valueAt(last)->~T();
+            }
+            index.release(handle);
+            return true;
+        }
+
+        /*
+            Destroys every value. Every handle given out so far becomes stale.
+        */
+        void clear() noexcept
+        {
+            for (uint32_t i = 0; i < index.size(); i++)
+            {
+                valueAt(i)->~T();
+            }
+            index.clear();
+        }
+
+        /*
+            Looks up the value a handle refers to.
+
+            @param handle handle to look up.
+            @return pointer to the value, or nullptr for stale or empty handles.
+        */
+        T *get(Handle handle) noexcept
+        {
+            return index.isCurrent(handle) ? valueAt(index.denseIndex(handle)) : nullptr;
+        }
+
+        /*
+            Looks up the value a handle refers to.
+
+            @param handle handle to look up.
+            @return pointer to the value, or nullptr for stale or empty handles.
+        */
+        const T *get(Handle handle) const noexcept
+        {
+            return index.isCurrent(handle) ? valueAt(index.denseIndex(handle)) : nullptr;
+        }
+
+        /*
+            Checks whether a handle still refers to a value.
+
+            @param handle handle to check.
+            @return whether the handle's value has not been erased.
+        */
+        bool contains(Handle handle) const noexcept
+        {
+            return index.isCurrent(handle);
+        }
+
+        /*
+            Gets the handle of a value by its position in the dense range, for
+            iterating values along with their handles.
+
+            @param denseIndex position of the value, below size().
+            @return handle to the value.
+        */
+        Handle handleAt(uint32_t denseIndex) const noexcept
+        {
+            return index.handleAt(denseIndex);
+        }
+
+        /*
+            Gets the start of the dense range of values.
+
+            @return pointer to the first value.
+        */
+        T *begin() noexcept
+        {
+            return valueAt(0);
+        }
+
+        const T *begin() const noexcept
+        {
+            return valueAt(0);
+        }
+
+        /*
+            Gets the end of the dense range of values.
+
+            @return pointer past the last value.
+        */
+        T *end() noexcept
+        {
+            return valueAt(index.size());
+        }
+
+        const T *end() const noexcept
+        {
+            return valueAt(index.size());
+        }
+
+        /*
+            Gets the number of values in the map.
+
+            @return count of values.
+        */
+        uint32_t size() const noexcept
+        {
+            return index.size();
+        }
+
+        /*
+            Gets the maximum number of values the map can hold.
+
+            @return the capacity of the map.
+        */
+        uint32_t capacity() const noexcept
+        {
+            return index.capacity();
+        }
+
+        /*
+            Gets whether every slot in the map is in use.
+
+            @return whether the next insert will fail.
+        */
+        bool full() const noexcept
+        {
+            return index.full();
+        }
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POOLS_SLOTMAP_HXX_
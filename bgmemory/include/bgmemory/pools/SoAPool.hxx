@@ -0,0 +1,387 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_POOLS_SOAPOOL_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_POOLS_SOAPOOL_HXX_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <initializer_list>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "bgmemory/assert.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+#include "bgmemory/allocators/Allocator.hxx"
+#include "bgmemory/pools/inner/SlotIndex.hxx"
+
+namespace bg
+{
+    /*
+        Contiguous run of one field of an SoAPool, the pool's values in dense
+        order. Valid until the next insert, erase or clear on the pool.
+    */
+    template <class T>
+    class SoASpan
+    {
+        T *first;
+        uint32_t count;
+
+    public:
+        SoASpan(T *data, uint32_t size) noexcept
+            : first(data), count(size)
+        {
+        }
+
+        T *data() const noexcept
+        {
+            return first;
+        }
+
+        uint32_t size() const noexcept
+        {
+            return count;
+        }
+
+        T *begin() const noexcept
+        {
+            return first;
+        }
+
+        T *end() const noexcept
+        {
+            return first + count;
+        }
+
+        T &operator[](uint32_t index) const noexcept
+        {
+            ASSERT(index < count);
+            return first[index];
+        }
+    };
+
+    /*
+        Fixed capacity structure of arrays table addressed through
+        generational handles, for data which is updated field by field in
+        tight loops, such as particle positions and velocities.
+
+        Each field type gets its own contiguous array, so a loop over a single
+        field touches only that field's memory and the compiler can vectorise
+        it. Every array starts on a boundary of at least simd512Alignment, and
+        all of them share one allocation made when the pool is constructed.
+
+        Values are kept dense in the same way as SlotMap, through the same
+        form of handle: erasing moves the last value of every array into the
+        hole, and handles follow their value through a slot array. Pointers
+        and spans into the pool are only valid until the next insert or
+        erase; handles stay valid until their own value is erased. Every field
+        type must be nothrow move constructible.
+
+        The pool is not thread safe.
+    */
+    template <class... Fields>
+    class SoAPool
+    {
+        static_assert(sizeof...(Fields) > 0, "SoAPool needs at least one field");
+
+        using Sequence = std::index_sequence_for<Fields...>;
+
+        static constexpr size_t fieldCount = sizeof...(Fields);
+
+        static constexpr bool allOf(std::initializer_list<bool> conditions) noexcept
+        {
+            for (bool condition : conditions)
+            {
+                if (!condition)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template <size_t I>
+        static constexpr size_t arrayAlignment() noexcept
+        {
+            using Type = typename std::tuple_element<I, std::tuple<Fields...>>::type;
+            return alignof(Type) > simd512Alignment ? alignof(Type) : simd512Alignment;
+        }
+
+        static constexpr size_t blockAlignment = std::max({simd512Alignment, alignof(Fields)...});
+
+        Allocator *allocator = nullptr;
+        unsigned char *block = nullptr;
+        // Start of each field's array within the block.
+        void *arrays[fieldCount] = {};
+        inner::SlotIndex index;
+
+        // Offsets of each field's array and of the slot index within a block
+        // for the given capacity, with the block size last.
+        template <size_t... I>
+        static void layout(size_t capacity, size_t *offsets, std::index_sequence<I...>) noexcept
+        {
+            const size_t sizes[] = {capacity * sizeof(Fields)...};
+            const size_t alignments[] = {arrayAlignment<I>()...};
+            size_t offset = 0;
+            for (size_t i = 0; i < fieldCount; i++)
+            {
+                offset = alignUp(offset, alignments[i]);
+                offsets[i] = offset;
+                offset += sizes[i];
+            }
+            offset = alignUp(offset, inner::SlotIndex::storageAlignment);
+            offsets[fieldCount] = offset;
+            offsets[fieldCount + 1] = offset + inner::SlotIndex::storageSize(static_cast<uint32_t>(capacity));
+        }
+
+        static size_t blockSize(size_t capacity) noexcept
+        {
+            size_t offsets[fieldCount + 2];
+            layout(capacity, offsets, Sequence());
+            return offsets[fieldCount + 1];
+        }
+
+        template <size_t I>
+        typename std::tuple_element<I, std::tuple<Fields...>>::type *array() const noexcept
+        {
+            return static_cast<typename std::tuple_element<I, std::tuple<Fields...>>::type *>(arrays[I]);
+        }
+
+        template <size_t... I>
+        void construct(uint32_t denseIndex, std::index_sequence<I...>, Fields &... values) noexcept
+        {
+            int expand[] = {0, (new (array<I>() + denseIndex) Fields(std::move(values)), 0)...};
+            static_cast<void>(expand);
+        }
+
+        template <size_t... I>
+        void destroy(uint32_t denseIndex, std::index_sequence<I...>) noexcept
+        {
+            int expand[] = {0, (array<I>()[denseIndex].~Fields(), 0)...};
+            static_cast<void>(expand);
+        }
+
+        template <size_t... I>
+        void moveInto(uint32_t hole, uint32_t from, std::index_sequence<I...>) noexcept
+        {
+            int expand[] = {0, (new (array<I>() + hole) Fields(std::move(array<I>()[from])), 0)...};
+            static_cast<void>(expand);
+            destroy(from, Sequence());
+        }
+
+    public:
+        using Handle = SlotMapHandle;
+
+        template <size_t I>
+        using FieldType = typename std::tuple_element<I, std::tuple<Fields...>>::type;
+
+        /*
+            Constructs a pool with room for the given number of values. This is
+            the only point at which the pool allocates memory.
+
+            @param capacity maximum number of values the pool can hold.
+            @param a allocator providing the storage, must outlive the pool.
+            @throws std::bad_alloc if the allocator cannot provide the storage.
+        */
+        explicit SoAPool(uint32_t capacity, Allocator &a = defaultAllocator())
+            : allocator(&a)
+        {
+            static_assert(allOf({std::is_nothrow_move_constructible<Fields>::value...}),
+                          "SoAPool fields are moved on erase and must not throw doing so");
+            ASSERT(capacity < inner::endOfFreeList);
+            if (capacity == 0)
+            {
+                return;
+            }
+
+            size_t offsets[fieldCount + 2];
+            layout(capacity, offsets, Sequence());
+            block = static_cast<unsigned char *>(allocator->allocate(offsets[fieldCount + 1], blockAlignment));
+            if (block == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+
+            for (size_t i = 0; i < fieldCount; i++)
+            {
+                arrays[i] = block + offsets[i];
+            }
+            index.attach(block + offsets[fieldCount], capacity);
+        }
+
+        SoAPool(const SoAPool<Fields...> &) = delete;
+        SoAPool<Fields...> &operator=(const SoAPool<Fields...> &) = delete;
+
+        /*
+            Destructor. Destroys every value still in the pool before releasing
+            the storage.
+        */
+        ~SoAPool()
+        {
+            if (block != nullptr)
+            {
+                clear();
+                allocator->deallocate(block, blockSize(index.capacity()), blockAlignment);
+            }
+        }
+
+        /*
+            Adds a value at the end of the dense range, moving each field into
+            its array.
+
+            @param values the value's fields, in the order of the pool's field types.
+            @return handle to the new value, or an empty handle if the pool is full.
+        */
+        Handle insert(Fields... values) noexcept
+        {
+            if (index.full())
+            {
+                return Handle();
+            }
+
+            construct(index.size(), Sequence(), values...);
+            return index.acquire();
+        }
+
+        /*
+            Destroys the value a handle refers to. The last value in the dense
+            range is moved into its place in every array.
+
+            @param handle handle to the value to erase.
+            @return whether a value was erased, false for stale or empty handles.
+        */
+        bool erase(Handle handle) noexcept
+        {
+            if (!index.isCurrent(handle))
+            {
+                return false;
+            }
+
+            const uint32_t hole = index.denseIndex(handle);
+            const uint32_t last = index.size() - 1;
+            destroy(hole, Sequence());
+            if (hole != last)
+            {
+                moveInto(hole, last, Sequence());
+            }
+            index.release(handle);
+            return true;
+        }
+
+        /*
+            Destroys every value. Every handle given out so far becomes stale.
+        */
+        void clear() noexcept
+        {
+            for (uint32_t i = 0; i < index.size(); i++)
+            {
+                destroy(i, Sequence());
+            }
+            index.clear();
+        }
+
+        /*
+            Looks up one field of the value a handle refers to.
+
+            @param handle handle to look up.
+            @return pointer to the field, or nullptr for stale or empty handles.
+        */
+        template <size_t I>
+        FieldType<I> *get(Handle handle) noexcept
+        {
+            return index.isCurrent(handle) ? array<I>() + index.denseIndex(handle) : nullptr;
+        }
+
+        /*
+            Looks up one field of the value a handle refers to.
+
+            @param handle handle to look up.
+            @return pointer to the field, or nullptr for stale or empty handles.
+        */
+        template <size_t I>
+        const FieldType<I> *get(Handle handle) const noexcept
+        {
+            return index.isCurrent(handle) ? array<I>() + index.denseIndex(handle) : nullptr;
+        }
+
+        /*
+            Gets every value's copy of one field, in dense order. Position i in
+            each field's span belongs to the same value, the one handleAt(i)
+            refers to.
+
+            @return span over the field's array, aligned to at least simd512Alignment.
+        */
+        template <size_t I>
+        SoASpan<FieldType<I>> field() noexcept
+        {
+            return SoASpan<FieldType<I>>(array<I>(), index.size());
+        }
+
+        /*
+            Gets every value's copy of one field, in dense order.
+
+            @return span over the field's array, aligned to at least simd512Alignment.
+        */
+        template <size_t I>
+        SoASpan<const FieldType<I>> field() const noexcept
+        {
+            return SoASpan<const FieldType<I>>(array<I>(), index.size());
+        }
+
+        /*
+            Checks whether a handle still refers to a value.
+
+            @param handle handle to check.
+            @return whether the handle's value has not been erased.
+        */
+        bool contains(Handle handle) const noexcept
+        {
+            return index.isCurrent(handle);
+        }
+
+        /*
+            Gets the handle of a value by its position in the dense range, for
+            finding which value a position in the field spans belongs to.
+
+            @param denseIndex position of the value, below size().
+            @return handle to the value.
+        */
+        Handle handleAt(uint32_t denseIndex) const noexcept
+        {
+            return index.handleAt(denseIndex);
+        }
+
+        /*
+            Gets the number of values in the pool.
+
+            @return count of values.
+        */
+        uint32_t size() const noexcept
+        {
+            return index.size();
+        }
+
+        /*
+            Gets the maximum number of values the pool can hold.
+
+            @return the capacity of the pool.
+        */
+        uint32_t capacity() const noexcept
+        {
+            return index.capacity();
+        }
+
+        /*
+            Gets whether every slot in the pool is in use.
+
+            @return whether the next insert will fail.
+        */
+        bool full() const noexcept
+        {
+            return index.full();
+        }
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POOLS_SOAPOOL_HXX_
@@ -0,0 +1,265 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_POOLS_INNER_SLOTINDEX_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_POOLS_INNER_SLOTINDEX_HXX_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bgmemory/assert.hxx"
+#include "bgmemory/bulletpool.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+
+namespace bg
+{
+    /*
+        Handle to a value in a SlotMap or SoAPool: the index of the value's
+        slot and the generation the slot was on when the value was inserted.
+        A default constructed handle refers to nothing.
+    */
+    struct SlotMapHandle
+    {
+        uint32_t index = 0;
+        uint32_t generation = 0;
+
+        /*
+            Packs the handle into a single 64 bit value, for storing handles
+            in places which only take an integer.
+
+            @return the handle as an integer.
+        */
+        uint64_t toBits() const noexcept
+        {
+            return (uint64_t(generation) << 32) | index;
+        }
+
+        /*
+            Unpacks a handle packed with toBits.
+
+            @param bits the packed handle.
+            @return the handle.
+        */
+        static SlotMapHandle fromBits(uint64_t bits) noexcept
+        {
+            return SlotMapHandle{static_cast<uint32_t>(bits), static_cast<uint32_t>(bits >> 32)};
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return generation != 0;
+        }
+
+        bool operator==(const SlotMapHandle &other) const noexcept
+        {
+            return index == other.index && generation == other.generation;
+        }
+
+        bool operator!=(const SlotMapHandle &other) const noexcept
+        {
+            return !(*this == other);
+        }
+    };
+} // namespace bg
+
+namespace bg::inner
+{
+    /*
+        Maps generational handles onto the indices of a dense range of values
+        which move around on erase, for containers keeping their values packed.
+
+        Each slot holds the dense index of its value and a generation bumped
+        when the value is erased, so stale handles are detected. A back
+        reference from each dense index to its slot lets the slot of a moved
+        value be patched. The index only does the bookkeeping; the container
+        owns the values and the storage handed to attach.
+    */
+    class SlotIndex
+    {
+        // Dense index of a live slot's value, or the next free slot.
+        struct Slot
+        {
+            uint32_t indexOrNextFree;
+            uint32_t generation;
+        };
+
+        // Slot index of each dense value, to patch slots when values move.
+        uint32_t *valueSlots = nullptr;
+        Slot *slots = nullptr;
+        uint32_t slotCount = 0;
+        uint32_t live = 0;
+        uint32_t freeHead = endOfFreeList;
+
+        // Bumps a generation, skipping 0 which no live value may use.
+        static uint32_t nextGeneration(uint32_t generation) noexcept
+        {
+            return generation + 1 != 0 ? generation + 1 : 1;
+        }
+
+        void threadFreeSlots() noexcept
+        {
+            for (uint32_t i = 0; i < slotCount; i++)
+            {
+                slots[i].indexOrNextFree = i + 1 < slotCount ? i + 1 : endOfFreeList;
+            }
+            freeHead = slotCount > 0 ? 0 : endOfFreeList;
+        }
+
+    public:
+        // Alignment the storage handed to attach must have.
+        static constexpr size_t storageAlignment = alignof(Slot);
+
+        /*
+            Gets the size of the storage needed to index the given number of
+            values.
+
+            @param capacity maximum number of values.
+            @return size of the storage in bytes.
+        */
+        static size_t storageSize(uint32_t capacity) noexcept
+        {
+            return alignUp(capacity * sizeof(uint32_t), alignof(Slot)) + capacity * sizeof(Slot);
+        }
+
+        /*
+            Starts indexing values in the given storage, with every slot free.
+
+            @param storage storage of storageSize(capacity) bytes, aligned to storageAlignment.
+            @param capacity maximum number of values.
+        */
+        void attach(void *storage, uint32_t capacity) noexcept
+        {
+            ASSERT(capacity < endOfFreeList);
+            auto bytes = static_cast<unsigned char *>(storage);
+            slotCount = capacity;
+            valueSlots = reinterpret_cast<uint32_t *>(bytes);
+            slots = reinterpret_cast<Slot *>(bytes + alignUp(capacity * sizeof(uint32_t), alignof(Slot)));
+            for (uint32_t i = 0; i < slotCount; i++)
+            {
+                slots[i].generation = 1;
+            }
+            live = 0;
+            threadFreeSlots();
+        }
+
+        /*
+            Takes a free slot for a new value at the end of the dense range,
+            dense index size() before the call.
+
+            @return handle to the new value, or an empty handle if every slot is in use.
+        */
+        SlotMapHandle acquire() noexcept
+        {
+            if (freeHead == endOfFreeList)
+            {
+                return SlotMapHandle();
+            }
+
+            const uint32_t index = freeHead;
+            freeHead = slots[index].indexOrNextFree;
+            slots[index].indexOrNextFree = live;
+            valueSlots[live] = index;
+            live++;
+            return SlotMapHandle{index, slots[index].generation};
+        }
+
+        /*
+            Frees the slot of an erased value. The container must already have
+            moved the last dense value into the erased value's place, if the
+            erased value was not itself the last.
+
+            @param handle current handle to the erased value.
+        */
+        void release(SlotMapHandle handle) noexcept
+        {
+            ASSERT(isCurrent(handle));
+            Slot &slot = slots[handle.index];
+            const uint32_t hole = slot.indexOrNextFree;
+            const uint32_t last = live - 1;
+            if (hole != last)
+            {
+                valueSlots[hole] = valueSlots[last];
+                slots[valueSlots[hole]].indexOrNextFree = hole;
+            }
+            live--;
+
+            slot.generation = nextGeneration(slot.generation);
+            slot.indexOrNextFree = freeHead;
+            freeHead = handle.index;
+        }
+
+        /*
+            Frees every slot. The container must already have destroyed every
+            value; every handle given out so far becomes stale.
+        */
+        void clear() noexcept
+        {
+            for (uint32_t i = 0; i < live; i++)
+            {
+                Slot &slot = slots[valueSlots[i]];
+                slot.generation = nextGeneration(slot.generation);
+            }
+            live = 0;
+            threadFreeSlots();
+        }
+
+        /*
+            Checks whether a handle still refers to a value. Free slots keep
+            their generation, so a live slot is also required to be the one
+            its dense value points back at.
+
+            @param handle handle to check.
+            @return whether the handle's value has not been erased.
+        */
+        bool isCurrent(SlotMapHandle handle) const noexcept
+        {
+            if (handle.index >= slotCount || handle.generation == 0)
+            {
+                return false;
+            }
+            const Slot &slot = slots[handle.index];
+            return slot.generation == handle.generation && slot.indexOrNextFree < live &&
+                   valueSlots[slot.indexOrNextFree] == handle.index;
+        }
+
+        /*
+            Gets the dense index of a current handle's value.
+
+            @param handle current handle to look up.
+            @return position of the value in the dense range.
+        */
+        uint32_t denseIndex(SlotMapHandle handle) const noexcept
+        {
+            ASSERT(isCurrent(handle));
+            return slots[handle.index].indexOrNextFree;
+        }
+
+        /*
+            Gets the handle of a value by its position in the dense range.
+
+            @param index position of the value, below size().
+            @return handle to the value.
+        */
+        SlotMapHandle handleAt(uint32_t index) const noexcept
+        {
+            ASSERT(index < live);
+            const uint32_t slot = valueSlots[index];
+            return SlotMapHandle{slot, slots[slot].generation};
+        }
+
+        uint32_t size() const noexcept
+        {
+            return live;
+        }
+
+        uint32_t capacity() const noexcept
+        {
+            return slotCount;
+        }
+
+        bool full() const noexcept
+        {
+            return freeHead == endOfFreeList;
+        }
+    };
+} // namespace bg::inner
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_POOLS_INNER_SLOTINDEX_HXX_
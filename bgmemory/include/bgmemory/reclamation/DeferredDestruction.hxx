@@ -0,0 +1,128 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_RECLAMATION_DEFERREDDESTRUCTION_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_RECLAMATION_DEFERREDDESTRUCTION_HXX_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <chrono>
+
+#include "bgmemory/reclamation/EpochReclamation.hxx"
+
+namespace bg
+{
+    namespace inner
+    {
+        // Depth of DeferredDestructionScopes open on this thread. Exposed so
+        // the check stays inline on paths which run on every release.
+        extern thread_local unsigned deferDepth;
+    } // namespace inner
+
+    /*
+        RAII section in which the current thread defers destruction. While a
+        scope is alive, a MutableSharedPtr dropping the last reference to its
+        object queues the object instead of destroying it, and the object is
+        destroyed by a later collect, on whichever thread makes that call.
+
+        The object is released as soon as it is queued: weak pointers see it
+        expired and it can no longer be reached through any pointer. Only the
+        destructor call and the freeing of memory are deferred.
+
+        Scopes nest cheaply and only affect the thread they were opened on.
+    */
+    class DeferredDestructionScope
+    {
+    public:
+        DeferredDestructionScope() noexcept;
+        ~DeferredDestructionScope();
+
+        DeferredDestructionScope(const DeferredDestructionScope &) = delete;
+        DeferredDestructionScope &operator=(const DeferredDestructionScope &) = delete;
+    };
+
+    /*
+        Checks whether the current thread is inside a DeferredDestructionScope,
+        so callers can skip deferDestruction when it would not queue anything.
+
+        @return whether objects released on this thread are deferred.
+    */
+    inline bool deferringDestruction() noexcept
+    {
+        return inner::deferDepth != 0;
+    }
+
+    /*
+        Queues an object for destruction by a later collect, if the current
+        thread is inside a DeferredDestructionScope. Queueing is lock free and
+        may be done from any number of threads at once.
+
+        Objects with the same group are destroyed next to each other by
+        collect, so destructors of one type run back to back.
+
+        @param object the object to destroy.
+        @param destroy function which destroys the object.
+        @param context extra pointer handed to the destroy function.
+        @param group key of the object's group, such as its type.
+        @return whether the object was queued; if not the caller must destroy it itself.
+    */
+    bool deferDestruction(void *object, ReclaimFunction destroy, void *context, const void *group) noexcept;
+
+    /*
+        Destroys objects queued by deferDestruction, a group at a time. Objects
+        released by those destructors are destroyed in the same call rather
+        than queued again, even inside a DeferredDestructionScope.
+
+        Several threads may collect at once, each taking its own share of the
+        queue.
+
+        @param limit maximum number of objects to destroy, to spread the cost over several calls.
+        @return number of objects destroyed.
+    */
+    size_t collect(size_t limit = SIZE_MAX);
+
+    /*
+        Gets the number of objects queued and not yet destroyed.
+
+        @return count of pending objects.
+    */
+    size_t pendingDestructions() noexcept;
+
+    /*
+        Thread which calls collect at a fixed interval, moving deferred
+        destruction off the threads which queued the objects altogether. The
+        queue is collected one final time when the collector is destroyed.
+
+        Destructors then run on the collector thread, so objects queued while
+        it runs must be safe to destroy from another thread. Without
+        BG_MEMORY_MULTITHREAD the pointer counts are not atomic, so objects
+        must also not have weak pointers still in use on other threads.
+    */
+    class BackgroundCollector
+    {
+        // Thread and wake up state, kept out of the header.
+        struct State;
+        State *state;
+
+    public:
+        /*
+            Starts the collector thread.
+
+            @param interval time to wait between collections.
+        */
+        explicit BackgroundCollector(std::chrono::milliseconds interval = std::chrono::milliseconds(16));
+
+        /*
+            Stops the collector thread and collects whatever is still queued.
+        */
+        ~BackgroundCollector();
+
+        BackgroundCollector(const BackgroundCollector &) = delete;
+        BackgroundCollector &operator=(const BackgroundCollector &) = delete;
+
+        /*
+            Wakes the collector to collect now rather than at its next interval.
+        */
+        void notify();
+    };
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_RECLAMATION_DEFERREDDESTRUCTION_HXX_
@@ -0,0 +1,69 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef BGMEMORY_INCLUDE_BGMEMORY_RECLAMATION_EPOCHRECLAMATION_HXX_
+#define BGMEMORY_INCLUDE_BGMEMORY_RECLAMATION_EPOCHRECLAMATION_HXX_
+
+#include <stddef.h>
+
+namespace bg
+{
+    /*
+        Function called to clean up a retired object once it is safe to do so.
+
+        @param object the retired object.
+        @param context the context pointer passed to retire.
+    */
+    using ReclaimFunction = void (*)(void *object, void *context);
+
+    /*
+        RAII reader section for epoch based reclamation.
+
+        While a guard is alive on a thread, no object retired after the guard
+        was entered will be reclaimed, so raw pointers read inside the guard
+        stay valid until the guard ends. Entering and leaving never blocks, and
+        guards nest cheaply; only the outermost guard on a thread publishes
+        anything.
+
+        Keep guards short. A thread sitting in a guard holds back reclamation
+        for every thread in the process.
+    */
+    class EpochGuard
+    {
+    public:
+        EpochGuard() noexcept;
+        ~EpochGuard();
+
+        EpochGuard(const EpochGuard &) = delete;
+        EpochGuard &operator=(const EpochGuard &) = delete;
+    };
+
+    /*
+        Retires an object which has been unlinked from every shared location.
+        The reclaim function is called with the object and context once every
+        reader which could still have seen the object has left its guard.
+
+        Reclamation happens on a later call to retire, reclaimRetired or
+        synchronizeRetired, on whichever thread makes it.
+
+        @param object the object to retire.
+        @param reclaim function which cleans up the object.
+        @param context extra pointer handed to the reclaim function.
+    */
+    void retire(void *object, ReclaimFunction reclaim, void *context);
+
+    /*
+        Tries to advance the global epoch and reclaims whatever this thread (and
+        any exited thread) retired that is now safe to clean up. Never blocks.
+
+        @return number of objects reclaimed.
+    */
+    size_t reclaimRetired();
+
+    /*
+        Waits until everything retired so far by this thread and by exited
+        threads has been reclaimed. Spins while other threads are inside guards,
+        so it must not be called from inside an EpochGuard.
+    */
+    void synchronizeRetired();
+} // namespace bg
+
+#endif // BGMEMORY_INCLUDE_BGMEMORY_RECLAMATION_EPOCHRECLAMATION_HXX_
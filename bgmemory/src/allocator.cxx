@@ -0,0 +1,22 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/Allocator.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+
+namespace bg
+{
+    void *AlignedHeapAllocator::allocate(size_t sizeInBytes, size_t alignment)
+    {
+        return allocateAlligned(sizeInBytes, alignment);
+    }
+
+    void AlignedHeapAllocator::deallocate(void *pointer, size_t, size_t)
+    {
+        freeAlligned(pointer);
+    }
+
+    Allocator &defaultAllocator() noexcept
+    {
+        static AlignedHeapAllocator allocator;
+        return allocator;
+    }
+} // namespace bg
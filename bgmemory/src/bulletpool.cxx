@@ -1,7 +1,17 @@
-#include "bgmemory/bulletpool.hxx"  
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/bulletpool.hxx"
 
-namespace bg {
-    bool BulletPool::herp() {
-        return true;
+#include <string.h>
+
+namespace bg::inner
+{
+    void threadFreeList(void *slots, size_t slotSize, uint32_t capacity)
+    {
+        auto bytes = static_cast<unsigned char *>(slots);
+        for (uint32_t i = 0; i < capacity; i++)
+        {
+            const uint32_t next = i + 1 < capacity ? i + 1 : endOfFreeList;
+            memcpy(bytes + static_cast<size_t>(i) * slotSize, &next, sizeof(next));
+        }
     }
-}
\ No newline at end of file
+} // namespace bg::inner
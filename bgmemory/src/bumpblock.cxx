@@ -0,0 +1,62 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/inner/BumpBlock.hxx"
+
+#include <new>
+
+#include "bgmemory/assert.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+
+namespace bg::inner
+{
+    size_t bumpUp(const unsigned char *base, size_t top, size_t limit, size_t sizeInBytes, size_t alignment) noexcept
+    {
+        ASSERT(isPowerOfTwo(alignment));
+        const uintptr_t address = reinterpret_cast<uintptr_t>(base);
+        const size_t start = alignUp(address + top, alignment) - address;
+        if (start > limit || sizeInBytes > limit - start)
+        {
+            return noRoom;
+        }
+        return start;
+    }
+
+    size_t bumpDown(const unsigned char *base, size_t top, size_t limit, size_t sizeInBytes, size_t alignment) noexcept
+    {
+        ASSERT(isPowerOfTwo(alignment));
+        if (sizeInBytes > top)
+        {
+            return noRoom;
+        }
+        const uintptr_t address = reinterpret_cast<uintptr_t>(base);
+        const uintptr_t start = alignDown(address + top - sizeInBytes, alignment);
+        if (start < address + limit)
+        {
+            return noRoom;
+        }
+        return start - address;
+    }
+
+    BumpBlock::BumpBlock(size_t sizeInBytes, Allocator &a)
+        : backing(&a)
+    {
+        if (sizeInBytes == 0)
+        {
+            return;
+        }
+
+        memory = static_cast<unsigned char *>(backing->allocate(sizeInBytes, cacheLineSize));
+        if (memory == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        bytes = sizeInBytes;
+    }
+
+    BumpBlock::~BumpBlock()
+    {
+        if (memory != nullptr)
+        {
+            backing->deallocate(memory, bytes, cacheLineSize);
+        }
+    }
+} // namespace bg::inner
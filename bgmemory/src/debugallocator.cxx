@@ -0,0 +1,223 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/DebugAllocator.hxx"
+
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bgmemory/assert.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+
+namespace bg
+{
+    namespace
+    {
+        // Room before a block, enough for the guard band and the alignment.
+        size_t frontSize(size_t alignment) noexcept
+        {
+            return alignment > DebugAllocator::guardSize ? alignment : DebugAllocator::guardSize;
+        }
+
+        size_t totalSize(size_t sizeInBytes, size_t alignment) noexcept
+        {
+            return frontSize(alignment) + sizeInBytes + DebugAllocator::guardSize;
+        }
+
+        std::string describeSite(const char *file, int line, const void *returnAddress)
+        {
+            std::ostringstream out;
+            if (file != nullptr)
+            {
+                out << file << ':' << line;
+            }
+            else
+            {
+                out << "caller " << returnAddress;
+            }
+            return out.str();
+        }
+    } // namespace
+
+    DebugAllocator::DebugAllocator(Allocator &a, size_t quarantineBlocks)
+        : backing(&a), quarantineLimit(quarantineBlocks)
+    {
+    }
+
+    DebugAllocator::~DebugAllocator()
+    {
+        flushQuarantine();
+        std::unordered_map<const void *, Block> leaked;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            leaked.swap(live);
+        }
+        for (const auto &entry : leaked)
+        {
+            std::ostringstream detail;
+            detail << entry.second.size << " bytes allocated at "
+                   << describeSite(entry.second.file, entry.second.line, entry.second.returnAddress);
+            reportMemoryError(MemoryError::Leak, entry.first, detail.str().c_str());
+        }
+    }
+
+    void *DebugAllocator::allocate(size_t sizeInBytes, size_t alignment)
+    {
+        ASSERT(isPowerOfTwo(alignment));
+        const size_t front = frontSize(alignment);
+        auto base = static_cast<unsigned char *>(backing->allocate(totalSize(sizeInBytes, alignment), alignment));
+        if (base == nullptr)
+        {
+            return nullptr;
+        }
+
+        unsigned char *user = base + front;
+        poisonMemory(base, front, guardFill);
+        poisonMemory(user, sizeInBytes, allocatedFill);
+        poisonMemory(user + sizeInBytes, guardSize, guardFill);
+
+        auto site = AllocationSite::current();
+        Block block{sizeInBytes, alignment,
+                    site != nullptr ? site->file() : nullptr,
+                    site != nullptr ? site->line() : 0,
+                    __builtin_return_address(0)};
+
+        std::lock_guard<std::mutex> lock(mutex);
+        live[user] = block;
+        return user;
+    }
+
+    bool DebugAllocator::guardsIntact(const void *pointer, const Block &block) noexcept
+    {
+        auto user = static_cast<const unsigned char *>(pointer);
+        const size_t front = frontSize(block.alignment);
+        return isPoisoned(user - front, front, guardFill) && isPoisoned(user + block.size, guardSize, guardFill);
+    }
+
+    void DebugAllocator::reportCorruptGuards(const void *pointer, const Block &block)
+    {
+        std::ostringstream detail;
+        detail << block.size << " byte block allocated at "
+               << describeSite(block.file, block.line, block.returnAddress);
+        reportMemoryError(MemoryError::GuardCorrupted, pointer, detail.str().c_str());
+    }
+
+    void DebugAllocator::deallocate(void *pointer, size_t sizeInBytes, size_t alignment)
+    {
+        if (pointer == nullptr)
+        {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        auto found = live.find(pointer);
+        if (found == live.end())
+        {
+            bool quarantined = false;
+            for (const auto &block : quarantine)
+            {
+                quarantined = quarantined || block.user == pointer;
+            }
+            lock.unlock();
+            if (quarantined)
+            {
+                reportMemoryError(MemoryError::DoubleFree, pointer, "block was already freed");
+            }
+            else
+            {
+                reportMemoryError(MemoryError::InvalidFree, pointer, "block was not allocated here");
+            }
+            return;
+        }
+
+        const Block block = found->second;
+        const bool mismatched = block.size != sizeInBytes || block.alignment != alignment;
+        const bool intact = guardsIntact(pointer, block);
+        live.erase(found);
+
+        auto user = static_cast<unsigned char *>(pointer);
+        poisonMemory(user, block.size, freedFill);
+        quarantine.push_back({user, block.size, block.alignment});
+        const bool evict = quarantine.size() > quarantineLimit;
+        QuarantinedBlock oldest{};
+        if (evict)
+        {
+            oldest = quarantine.front();
+            quarantine.pop_front();
+        }
+        lock.unlock();
+
+        if (mismatched)
+        {
+            reportMemoryError(MemoryError::InvalidFree, pointer, "size or alignment differ from the allocation");
+        }
+        if (!intact)
+        {
+            reportCorruptGuards(pointer, block);
+        }
+        if (evict)
+        {
+            releaseQuarantined(oldest);
+        }
+    }
+
+    void DebugAllocator::releaseQuarantined(const QuarantinedBlock &block)
+    {
+        if (!isPoisoned(block.user, block.size, freedFill))
+        {
+            reportMemoryError(MemoryError::UseAfterFree, block.user, "freed block was written to");
+        }
+        backing->deallocate(block.user - frontSize(block.alignment),
+                            totalSize(block.size, block.alignment), block.alignment);
+    }
+
+    void DebugAllocator::flushQuarantine()
+    {
+        std::deque<QuarantinedBlock> blocks;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            blocks.swap(quarantine);
+        }
+        for (const auto &block : blocks)
+        {
+            releaseQuarantined(block);
+        }
+    }
+
+    size_t DebugAllocator::checkGuards() const
+    {
+        std::vector<std::pair<const void *, Block>> corrupted;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto &entry : live)
+            {
+                if (!guardsIntact(entry.first, entry.second))
+                {
+                    corrupted.push_back(entry);
+                }
+            }
+        }
+        for (const auto &entry : corrupted)
+        {
+            reportCorruptGuards(entry.first, entry.second);
+        }
+        return corrupted.size();
+    }
+
+    size_t DebugAllocator::reportLeaks(std::ostream &out) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto &entry : live)
+        {
+            out << entry.second.size << " bytes at " << entry.first << " allocated at "
+                << describeSite(entry.second.file, entry.second.line, entry.second.returnAddress) << '\n';
+        }
+        return live.size();
+    }
+
+    size_t DebugAllocator::liveCount() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return live.size();
+    }
+} // namespace bg
@@ -0,0 +1,219 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/reclamation/DeferredDestruction.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "bgmemory/pointers/inner/PayloadPool.hxx"
+
+namespace bg
+{
+    namespace inner
+    {
+        thread_local unsigned deferDepth = 0;
+    } // namespace inner
+
+    namespace
+    {
+        // A queued object, linked into the queue. Nodes are drawn from the
+        // payload pool, which may be returned to from any thread.
+        struct DeferredObject
+        {
+            DeferredObject *next;
+            void *object;
+            ReclaimFunction destroy;
+            void *context;
+            const void *group;
+        };
+
+        // Lock free stack of queued objects, newest first. Collecting takes
+        // the whole stack at once, so nodes are never popped individually.
+        std::atomic<DeferredObject *> queue{nullptr};
+        std::atomic<size_t> pending{0};
+
+        void pushNodes(DeferredObject *first, DeferredObject *last) noexcept
+        {
+            auto head = queue.load(std::memory_order_relaxed);
+            do
+            {
+                last->next = head;
+            } while (!queue.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        // Stops the current thread deferring while it collects, so objects
+        // released by the destructors it runs are destroyed along with them.
+        class SuspendDeferral
+        {
+            unsigned depth;
+
+        public:
+            SuspendDeferral() noexcept : depth(inner::deferDepth)
+            {
+                inner::deferDepth = 0;
+            }
+
+            ~SuspendDeferral()
+            {
+                inner::deferDepth = depth;
+            }
+        };
+    } // namespace
+
+    DeferredDestructionScope::DeferredDestructionScope() noexcept
+    {
+        inner::deferDepth++;
+    }
+
+    DeferredDestructionScope::~DeferredDestructionScope()
+    {
+        inner::deferDepth--;
+    }
+
+    bool deferDestruction(void *object, ReclaimFunction destroy, void *context, const void *group) noexcept
+    {
+        if (!deferringDestruction())
+        {
+            return false;
+        }
+
+        void *memory;
+        try
+        {
+            memory = inner::allocatePayload(sizeof(DeferredObject));
+        }
+        catch (...)
+        {
+            return false;
+        }
+
+        auto node = new (memory) DeferredObject{nullptr, object, destroy, context, group};
+        pending.fetch_add(1, std::memory_order_relaxed);
+        pushNodes(node, node);
+        return true;
+    }
+
+    size_t collect(size_t limit)
+    {
+        if (limit == 0 || queue.load(std::memory_order_relaxed) == nullptr)
+        {
+            return 0;
+        }
+
+        std::vector<DeferredObject *> batch;
+        DeferredObject *taken = queue.exchange(nullptr, std::memory_order_acquire);
+        try
+        {
+            for (auto node = taken; node != nullptr; node = node->next)
+            {
+                batch.push_back(node);
+            }
+        }
+        catch (...)
+        {
+            auto last = taken;
+            while (last != nullptr && last->next != nullptr)
+            {
+                last = last->next;
+            }
+            if (last != nullptr)
+            {
+                pushNodes(taken, last);
+            }
+            throw;
+        }
+        // Oldest first, so a limited collect destroys objects in the order
+        // they were queued and hands the newest back.
+        std::reverse(batch.begin(), batch.end());
+        if (batch.size() > limit)
+        {
+            // Relinked newest first, as the queue holds them.
+            for (size_t i = limit; i + 1 < batch.size(); i++)
+            {
+                batch[i + 1]->next = batch[i];
+            }
+            pushNodes(batch.back(), batch[limit]);
+            batch.resize(limit);
+        }
+
+        std::stable_sort(batch.begin(), batch.end(), [](const DeferredObject *a, const DeferredObject *b) {
+            return std::less<const void *>()(a->group, b->group);
+        });
+
+        SuspendDeferral suspend;
+        for (auto node : batch)
+        {
+            node->destroy(node->object, node->context);
+            inner::deallocatePayload(node, sizeof(DeferredObject));
+        }
+        pending.fetch_sub(batch.size(), std::memory_order_relaxed);
+        return batch.size();
+    }
+
+    size_t pendingDestructions() noexcept
+    {
+        return pending.load(std::memory_order_relaxed);
+    }
+
+    struct BackgroundCollector::State
+    {
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+        bool requested = false;
+        std::thread thread;
+
+        void run(std::chrono::milliseconds interval)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping)
+            {
+                wake.wait_for(lock, interval, [this] { return stopping || requested; });
+                requested = false;
+                lock.unlock();
+                collect();
+                lock.lock();
+            }
+        }
+    };
+
+    BackgroundCollector::BackgroundCollector(std::chrono::milliseconds interval)
+        : state(new State())
+    {
+        try
+        {
+            state->thread = std::thread(&State::run, state, interval);
+        }
+        catch (...)
+        {
+            delete state;
+            throw;
+        }
+    }
+
+    BackgroundCollector::~BackgroundCollector()
+    {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->stopping = true;
+        }
+        state->wake.notify_one();
+        state->thread.join();
+        delete state;
+        collect();
+    }
+
+    void BackgroundCollector::notify()
+    {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->requested = true;
+        }
+        state->wake.notify_one();
+    }
+} // namespace bg
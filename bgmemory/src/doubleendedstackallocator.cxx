@@ -0,0 +1,91 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/DoubleEndedStackAllocator.hxx"
+
+#include "bgmemory/assert.hxx"
+
+namespace bg
+{
+    DoubleEndedStackAllocator::DoubleEndedStackAllocator(size_t capacityInBytes, Allocator &a)
+        : block(capacityInBytes, a), upperTop(block.size()), lowerEnd(this, false), upperEnd(this, true)
+    {
+    }
+
+    void *DoubleEndedStackAllocator::End::allocate(size_t sizeInBytes, size_t alignment)
+    {
+        auto &stack = *owner;
+        unsigned char *base = stack.block.data();
+        const size_t start = growsDown ? inner::bumpDown(base, stack.upperTop, stack.lowerTop, sizeInBytes, alignment)
+                                       : inner::bumpUp(base, stack.lowerTop, stack.upperTop, sizeInBytes, alignment);
+        if (start == inner::noRoom)
+        {
+            return nullptr;
+        }
+
+        if (growsDown)
+        {
+            stack.upperTop = start;
+        }
+        else
+        {
+            stack.lowerTop = start + sizeInBytes;
+        }
+        BG_MEMORY_POISON(base + start, sizeInBytes, allocatedFill);
+        return base + start;
+    }
+
+    void DoubleEndedStackAllocator::End::deallocate(void *pointer, size_t sizeInBytes, size_t)
+    {
+        if (pointer == nullptr)
+        {
+            return;
+        }
+
+        auto &stack = *owner;
+        ASSERT(stack.owns(pointer));
+        const size_t start = static_cast<size_t>(static_cast<unsigned char *>(pointer) - stack.block.data());
+#ifdef BG_MEMORY_DEBUG
+        if (growsDown ? start < stack.upperTop : start + sizeInBytes > stack.lowerTop)
+        {
+            reportMemoryError(MemoryError::DoubleFree, pointer, "block was already popped off its end of the stack");
+            return;
+        }
+#else
+        ASSERT(growsDown ? start >= stack.upperTop : start + sizeInBytes <= stack.lowerTop);
+#endif // BG_MEMORY_DEBUG
+
+        // Popping a block moves the top to its far edge, as seen from the end.
+        rollback(growsDown ? start + sizeInBytes : start);
+    }
+
+    DoubleEndedStackAllocator::Marker DoubleEndedStackAllocator::End::getMarker() const noexcept
+    {
+        return growsDown ? owner->upperTop : owner->lowerTop;
+    }
+
+    void DoubleEndedStackAllocator::End::rollback(Marker marker) noexcept
+    {
+        auto &stack = *owner;
+        if (growsDown)
+        {
+            ASSERT(marker >= stack.upperTop && marker <= stack.block.size());
+            BG_MEMORY_POISON(stack.block.data() + stack.upperTop, marker - stack.upperTop, freedFill);
+            stack.upperTop = marker;
+        }
+        else
+        {
+            ASSERT(marker <= stack.lowerTop);
+            BG_MEMORY_POISON(stack.block.data() + marker, stack.lowerTop - marker, freedFill);
+            stack.lowerTop = marker;
+        }
+    }
+
+    void DoubleEndedStackAllocator::End::reset() noexcept
+    {
+        rollback(growsDown ? owner->block.size() : 0);
+    }
+
+    size_t DoubleEndedStackAllocator::End::used() const noexcept
+    {
+        return growsDown ? owner->block.size() - owner->upperTop : owner->lowerTop;
+    }
+} // namespace bg
@@ -0,0 +1,240 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/reclamation/EpochReclamation.hxx"
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "bgmemory/assert.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+
+namespace bg
+{
+    namespace
+    {
+        // An object waiting for every reader that could have seen it to leave.
+        struct RetiredObject
+        {
+            void *object;
+            ReclaimFunction reclaim;
+            void *context;
+            uint64_t epoch;
+        };
+
+        // Published per thread state, scanned when advancing the epoch. Records
+        // are never freed; a record released by an exiting thread is reused by
+        // the next thread to start reading.
+        struct alignas(cacheLineSize) ThreadRecord
+        {
+            // Epoch observed when the outermost guard was entered, 0 when idle.
+            std::atomic<uint64_t> localEpoch{0};
+            std::atomic<bool> inUse{false};
+            ThreadRecord *next = nullptr;
+        };
+
+        // Retired objects are only reclaimed in batches of this size.
+        constexpr size_t reclaimThreshold = 64;
+
+        std::atomic<uint64_t> globalEpoch{1};
+        std::atomic<ThreadRecord *> records{nullptr};
+
+        // Objects left behind by exited threads, reclaimed by whoever gets there first.
+        std::mutex &orphanMutex()
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::vector<RetiredObject> &orphans()
+        {
+            static std::vector<RetiredObject> retired;
+            return retired;
+        }
+
+        ThreadRecord *acquireRecord()
+        {
+            for (auto record = records.load(std::memory_order_acquire); record != nullptr; record = record->next)
+            {
+                bool expected = false;
+                if (!record->inUse.load(std::memory_order_relaxed) &&
+                    record->inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                {
+                    return record;
+                }
+            }
+
+            // Allocated aligned by hand, as new ignores over-alignment before C++17.
+            void *memory = allocateAlligned(sizeof(ThreadRecord), alignof(ThreadRecord));
+            if (memory == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            auto record = new (memory) ThreadRecord();
+            record->inUse.store(true, std::memory_order_relaxed);
+            auto head = records.load(std::memory_order_relaxed);
+            do
+            {
+                record->next = head;
+            } while (!records.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+            return record;
+        }
+
+        // Advances the global epoch if every reader has caught up with it.
+        bool tryAdvance()
+        {
+            uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+            for (auto record = records.load(std::memory_order_acquire); record != nullptr; record = record->next)
+            {
+                if (!record->inUse.load(std::memory_order_acquire))
+                {
+                    continue;
+                }
+                const uint64_t local = record->localEpoch.load(std::memory_order_seq_cst);
+                if (local != 0 && local != epoch)
+                {
+                    return false;
+                }
+            }
+            // Losing the race means another thread advanced it for us.
+            globalEpoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+            return true;
+        }
+
+        // Reclaims every object retired at least two epochs ago. The list is
+        // swapped out first, since reclaiming may retire further objects.
+        size_t reclaimList(std::vector<RetiredObject> &list)
+        {
+            const uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+            std::vector<RetiredObject> pending;
+            pending.swap(list);
+
+            size_t reclaimed = 0;
+            std::vector<RetiredObject> kept;
+            for (auto &retired : pending)
+            {
+                if (retired.epoch + 2 <= epoch)
+                {
+                    retired.reclaim(retired.object, retired.context);
+                    reclaimed++;
+                }
+                else
+                {
+                    kept.push_back(retired);
+                }
+            }
+
+            list.insert(list.end(), kept.begin(), kept.end());
+            return reclaimed;
+        }
+
+        size_t reclaimOrphans(bool wait)
+        {
+            std::unique_lock<std::mutex> lock(orphanMutex(), std::defer_lock);
+            if (wait)
+            {
+                lock.lock();
+            }
+            else if (!lock.try_lock())
+            {
+                return 0;
+            }
+
+            std::vector<RetiredObject> pending;
+            pending.swap(orphans());
+            lock.unlock();
+
+            const size_t reclaimed = reclaimList(pending);
+
+            lock.lock();
+            orphans().insert(orphans().end(), pending.begin(), pending.end());
+            return reclaimed;
+        }
+
+        struct ThreadState
+        {
+            ThreadRecord *record = nullptr;
+            unsigned nesting = 0;
+            std::vector<RetiredObject> retired;
+
+            ThreadRecord *getRecord()
+            {
+                if (record == nullptr)
+                {
+                    record = acquireRecord();
+                }
+                return record;
+            }
+
+            ~ThreadState()
+            {
+                tryAdvance();
+                reclaimList(retired);
+                if (!retired.empty())
+                {
+                    std::lock_guard<std::mutex> lock(orphanMutex());
+                    orphans().insert(orphans().end(), retired.begin(), retired.end());
+                }
+                if (record != nullptr)
+                {
+                    record->localEpoch.store(0, std::memory_order_release);
+                    record->inUse.store(false, std::memory_order_release);
+                }
+            }
+        };
+
+        thread_local ThreadState threadState;
+    } // namespace
+
+    EpochGuard::EpochGuard() noexcept
+    {
+        auto &state = threadState;
+        if (state.nesting++ == 0)
+        {
+            auto record = state.getRecord();
+            record->localEpoch.store(globalEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        }
+    }
+
+    EpochGuard::~EpochGuard()
+    {
+        auto &state = threadState;
+        if (--state.nesting == 0)
+        {
+            state.record->localEpoch.store(0, std::memory_order_release);
+        }
+    }
+
+    void retire(void *object, ReclaimFunction reclaim, void *context)
+    {
+        auto &state = threadState;
+        state.retired.push_back({object, reclaim, context, globalEpoch.load(std::memory_order_seq_cst)});
+        if (state.retired.size() >= reclaimThreshold)
+        {
+            reclaimRetired();
+        }
+    }
+
+    size_t reclaimRetired()
+    {
+        tryAdvance();
+        return reclaimList(threadState.retired) + reclaimOrphans(false);
+    }
+
+    void synchronizeRetired()
+    {
+        ASSERT(threadState.nesting == 0);
+        const uint64_t target = globalEpoch.load(std::memory_order_seq_cst) + 2;
+        while (globalEpoch.load(std::memory_order_seq_cst) < target)
+        {
+            if (!tryAdvance())
+            {
+                std::this_thread::yield();
+            }
+        }
+        reclaimList(threadState.retired);
+        reclaimOrphans(true);
+    }
+} // namespace bg
@@ -0,0 +1,36 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/LinearArena.hxx"
+
+#include "bgmemory/assert.hxx"
+
+namespace bg
+{
+    LinearArena::LinearArena(size_t capacityInBytes, Allocator &a)
+        : block(capacityInBytes, a)
+    {
+    }
+
+    void *LinearArena::allocate(size_t sizeInBytes, size_t alignment)
+    {
+        const size_t start = inner::bumpUp(block.data(), offset, block.size(), sizeInBytes, alignment);
+        if (start == inner::noRoom)
+        {
+            return nullptr;
+        }
+
+        offset = start + sizeInBytes;
+        BG_MEMORY_POISON(block.data() + start, sizeInBytes, allocatedFill);
+        return block.data() + start;
+    }
+
+    void LinearArena::deallocate(void *, size_t, size_t)
+    {
+    }
+
+    void LinearArena::rollback(Marker marker) noexcept
+    {
+        ASSERT(marker <= offset);
+        BG_MEMORY_POISON(block.data() + marker, offset - marker, freedFill);
+        offset = marker;
+    }
+} // namespace bg
@@ -0,0 +1,95 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/debug/MemoryDebug.hxx"
+
+#include <signal.h>
+#include <string.h>
+#include <atomic>
+#include <iostream>
+
+namespace bg
+{
+    namespace
+    {
+        void defaultMemoryErrorHandler(MemoryError error, const void *pointer, const char *detail)
+        {
+            std::cout << "MEMORY ERROR: " << memoryErrorName(error) << " at " << pointer << " : "
+                      << detail << std::endl;
+            if (error != MemoryError::Leak)
+            {
+                raise(SIGTRAP);
+            }
+        }
+
+        std::atomic<MemoryErrorHandler> errorHandler{&defaultMemoryErrorHandler};
+
+        thread_local const AllocationSite *currentSite = nullptr;
+    } // namespace
+
+    MemoryErrorHandler setMemoryErrorHandler(MemoryErrorHandler handler) noexcept
+    {
+        return errorHandler.exchange(handler != nullptr ? handler : &defaultMemoryErrorHandler);
+    }
+
+    void reportMemoryError(MemoryError error, const void *pointer, const char *detail)
+    {
+        errorHandler.load()(error, pointer, detail);
+    }
+
+    const char *memoryErrorName(MemoryError error) noexcept
+    {
+        switch (error)
+        {
+        case MemoryError::DoubleFree:
+            return "double free";
+        case MemoryError::InvalidFree:
+            return "invalid free";
+        case MemoryError::GuardCorrupted:
+            return "guard corrupted";
+        case MemoryError::UseAfterFree:
+            return "use after free";
+        case MemoryError::UseAfterMutate:
+            return "use after mutate";
+        case MemoryError::Leak:
+            return "leak";
+        }
+        return "unknown";
+    }
+
+    void poisonMemory(void *pointer, size_t sizeInBytes, unsigned char fill) noexcept
+    {
+        if (sizeInBytes == 0)
+        {
+            return;
+        }
+        memset(pointer, fill, sizeInBytes);
+    }
+
+    bool isPoisoned(const void *pointer, size_t sizeInBytes, unsigned char fill) noexcept
+    {
+        auto bytes = static_cast<const unsigned char *>(pointer);
+        for (size_t i = 0; i < sizeInBytes; i++)
+        {
+            if (bytes[i] != fill)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    AllocationSite::AllocationSite(const char *file, int line) noexcept
+        : siteFile(file), siteLine(line), outer(currentSite)
+    {
+        currentSite = this;
+    }
+
+    AllocationSite::~AllocationSite()
+    {
+        currentSite = outer;
+    }
+
+    const AllocationSite *AllocationSite::current() noexcept
+    {
+        return currentSite;
+    }
+} // namespace bg
@@ -1,10 +1,108 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/memoryfunctions.hxx"
+
 #include <stdlib.h>
+#if defined(_WIN32)
+#include <malloc.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #include "bgmemory/assert.hxx"
 
-namespace bg {
-    void* allocateAlligned(size_t sizeInBytes, size_t alignment) {
-        ASSERT(0>1);
-        return 0;
+namespace bg
+{
+    void *allocateAlligned(size_t sizeInBytes, size_t alignment)
+    {
+        ASSERT(isPowerOfTwo(alignment));
+        // posix_memalign requires at least pointer alignment
+        if (alignment < sizeof(void *))
+        {
+            alignment = sizeof(void *);
+        }
+
+#if defined(_WIN32)
+        return _aligned_malloc(sizeInBytes, alignment);
+#else
+        void *pointer = nullptr;
+        if (posix_memalign(&pointer, alignment, sizeInBytes) != 0)
+        {
+            return nullptr;
+        }
+        return pointer;
+#endif
+    }
+
+    void freeAlligned(void *pointer)
+    {
+#if defined(_WIN32)
+        _aligned_free(pointer);
+#else
+        free(pointer);
+#endif
+    }
+
+    size_t pageSize() noexcept
+    {
+#if defined(_WIN32)
+        static const size_t size = []() {
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return static_cast<size_t>(info.dwPageSize);
+        }();
+#else
+        static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+        return size;
+    }
+
+    void *reserveVirtual(size_t sizeInBytes) noexcept
+    {
+        sizeInBytes = alignUp(sizeInBytes, pageSize());
+#if defined(_WIN32)
+        return VirtualAlloc(nullptr, sizeInBytes, MEM_RESERVE, PAGE_NOACCESS);
+#else
+        void *pointer = mmap(nullptr, sizeInBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        return pointer != MAP_FAILED ? pointer : nullptr;
+#endif
+    }
+
+    bool commitVirtual(void *pointer, size_t sizeInBytes) noexcept
+    {
+        ASSERT(reinterpret_cast<size_t>(pointer) % pageSize() == 0 && sizeInBytes % pageSize() == 0);
+#if defined(_WIN32)
+        return VirtualAlloc(pointer, sizeInBytes, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+        return mprotect(pointer, sizeInBytes, PROT_READ | PROT_WRITE) == 0;
+#endif
+    }
+
+    void decommitVirtual(void *pointer, size_t sizeInBytes) noexcept
+    {
+        ASSERT(reinterpret_cast<size_t>(pointer) % pageSize() == 0 && sizeInBytes % pageSize() == 0);
+#if defined(_WIN32)
+        VirtualFree(pointer, sizeInBytes, MEM_DECOMMIT);
+#else
+        // Dropping private anonymous pages frees them at once; the pages read
+        // as zero if committed again.
+        madvise(pointer, sizeInBytes, MADV_DONTNEED);
+        mprotect(pointer, sizeInBytes, PROT_NONE);
+#endif
+    }
+
+    void releaseVirtual(void *pointer, size_t sizeInBytes) noexcept
+    {
+        if (pointer == nullptr)
+        {
+            return;
+        }
+#if defined(_WIN32)
+        static_cast<void>(sizeInBytes);
+        VirtualFree(pointer, 0, MEM_RELEASE);
+#else
+        munmap(pointer, alignUp(sizeInBytes, pageSize()));
+#endif
     }
-}
\ No newline at end of file
+} // namespace bg
@@ -0,0 +1,177 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/instrumentation/MemoryTracker.hxx"
+
+#include <iomanip>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace bg
+{
+    namespace
+    {
+        // Never destroyed, so trackers with static storage can unregister in
+        // any order at exit.
+        std::mutex &registryMutex()
+        {
+            static std::aligned_storage<sizeof(std::mutex), alignof(std::mutex)>::type storage;
+            static auto mutex = new (&storage) std::mutex();
+            return *mutex;
+        }
+
+        MemoryTracker *&registryHead()
+        {
+            static MemoryTracker *head = nullptr;
+            return head;
+        }
+
+        size_t bucketFor(size_t sizeInBytes) noexcept
+        {
+            size_t bucket = 0;
+            while (bucket + 1 < AllocationStats::histogramBuckets && (size_t(1) << bucket) < sizeInBytes)
+            {
+                bucket++;
+            }
+            return bucket;
+        }
+    } // namespace
+
+    MemoryTracker::MemoryTracker(std::string name)
+        : trackerName(std::move(name))
+    {
+        for (auto &bucket : histogram)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto &head = registryHead();
+        next = head;
+        if (head != nullptr)
+        {
+            head->prev = this;
+        }
+        head = this;
+    }
+
+    MemoryTracker::~MemoryTracker()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        if (prev != nullptr)
+        {
+            prev->next = next;
+        }
+        else
+        {
+            registryHead() = next;
+        }
+        if (next != nullptr)
+        {
+            next->prev = prev;
+        }
+    }
+
+    void MemoryTracker::recordAllocation(size_t sizeInBytes) noexcept
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        histogram[bucketFor(sizeInBytes)].fetch_add(1, std::memory_order_relaxed);
+
+        const size_t live = liveBytes.fetch_add(sizeInBytes, std::memory_order_relaxed) + sizeInBytes;
+        size_t peak = peakBytes.load(std::memory_order_relaxed);
+        while (peak < live && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void MemoryTracker::recordFree(size_t sizeInBytes) noexcept
+    {
+        freeCount.fetch_add(1, std::memory_order_relaxed);
+        liveBytes.fetch_sub(sizeInBytes, std::memory_order_relaxed);
+    }
+
+    AllocationStats MemoryTracker::getStats() const noexcept
+    {
+        AllocationStats stats;
+        stats.liveBytes = liveBytes.load(std::memory_order_relaxed);
+        stats.peakBytes = peakBytes.load(std::memory_order_relaxed);
+        stats.allocationCount = allocationCount.load(std::memory_order_relaxed);
+        stats.freeCount = freeCount.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < AllocationStats::histogramBuckets; i++)
+        {
+            stats.histogram[i] = histogram[i].load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    void MemoryTracker::reset() noexcept
+    {
+        peakBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        allocationCount.store(0, std::memory_order_relaxed);
+        freeCount.store(0, std::memory_order_relaxed);
+        for (auto &bucket : histogram)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    const std::string &MemoryTracker::name() const noexcept
+    {
+        return trackerName;
+    }
+
+    std::vector<TrackerSnapshot> snapshotMemory()
+    {
+        std::vector<TrackerSnapshot> snapshot;
+        std::lock_guard<std::mutex> lock(registryMutex());
+        for (auto tracker = registryHead(); tracker != nullptr; tracker = tracker->next)
+        {
+            snapshot.push_back({tracker->name(), tracker->getStats()});
+        }
+        return snapshot;
+    }
+
+    void dumpMemoryReport(std::ostream &out)
+    {
+        for (const auto &entry : snapshotMemory())
+        {
+            const auto &stats = entry.stats;
+            out << entry.name << '\n'
+                << "  live bytes  " << stats.liveBytes << '\n'
+                << "  peak bytes  " << stats.peakBytes << '\n'
+                << "  allocations " << stats.allocationCount << '\n'
+                << "  frees       " << stats.freeCount << '\n';
+            for (size_t i = 0; i < AllocationStats::histogramBuckets; i++)
+            {
+                if (stats.histogram[i] == 0)
+                {
+                    continue;
+                }
+                const bool last = i + 1 == AllocationStats::histogramBuckets;
+                out << "  " << (last ? ">" : "<=") << std::setw(8) << (size_t(1) << (last ? i - 1 : i))
+                    << " bytes  " << stats.histogram[i] << '\n';
+            }
+        }
+    }
+
+    namespace inner
+    {
+        // The built in trackers are never destroyed, as payloads may be
+        // released during static destruction. They are placed in static
+        // storage, and their names are short enough for the small string
+        // buffer, so tracking itself never calls global new.
+        MemoryTracker &payloadTracker()
+        {
+            static std::aligned_storage<sizeof(MemoryTracker), alignof(MemoryTracker)>::type storage;
+            static auto tracker = new (&storage) MemoryTracker("bg.payloads");
+            return *tracker;
+        }
+
+        MemoryTracker &inplaceTracker()
+        {
+            static std::aligned_storage<sizeof(MemoryTracker), alignof(MemoryTracker)>::type storage;
+            static auto tracker = new (&storage) MemoryTracker("bg.inplace");
+            return *tracker;
+        }
+    } // namespace inner
+} // namespace bg
@@ -0,0 +1,224 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pointers/inner/PayloadPool.hxx"
+
+#include <mutex>
+#include <new>
+
+#include "bgmemory/assert.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+
+namespace bg::inner
+{
+    namespace
+    {
+        constexpr size_t classCount = payloadMaxPooledSize / payloadGranularity;
+
+        // Size of each slab carved into payload blocks.
+        constexpr size_t slabSize = 64 * 1024;
+
+        // Blocks moved between a thread cache and the shared pool at a time.
+        constexpr size_t batchSize = 32;
+
+        // A thread cache holding more blocks than this drains a batch.
+        constexpr size_t cacheLimit = 2 * batchSize;
+
+        // A free block, linked through its own first bytes.
+        struct FreeBlock
+        {
+            FreeBlock *next;
+        };
+
+        size_t classIndex(size_t sizeInBytes) noexcept
+        {
+            return (sizeInBytes + payloadGranularity - 1) / payloadGranularity - 1;
+        }
+
+        size_t classSize(size_t index) noexcept
+        {
+            return (index + 1) * payloadGranularity;
+        }
+
+        // Shared state of one size class.
+        struct SharedClass
+        {
+            std::mutex mutex;
+            FreeBlock *freeList = nullptr;
+            // Unused tail of the newest slab.
+            unsigned char *bump = nullptr;
+            unsigned char *bumpEnd = nullptr;
+        };
+
+        // Never destroyed, payloads may be released during static destruction.
+        SharedClass *sharedClasses()
+        {
+            static SharedClass *classes = new SharedClass[classCount];
+            return classes;
+        }
+
+        /*
+            Takes up to count blocks from the shared pool, chained in ascending
+            address order when freshly carved. Returns nullptr when out of memory.
+        */
+        FreeBlock *takeBlocks(size_t index, size_t count, size_t &taken)
+        {
+            auto &shared = sharedClasses()[index];
+            const size_t size = classSize(index);
+            std::lock_guard<std::mutex> lock(shared.mutex);
+
+            FreeBlock *head = nullptr;
+            FreeBlock **tail = &head;
+            taken = 0;
+            while (taken < count && shared.freeList != nullptr)
+            {
+                *tail = shared.freeList;
+                shared.freeList = shared.freeList->next;
+                tail = &(*tail)->next;
+                taken++;
+            }
+            while (taken < count)
+            {
+                if (shared.bump == shared.bumpEnd)
+                {
+                    auto slab = static_cast<unsigned char *>(allocateAlligned(slabSize, cacheLineSize));
+                    if (slab == nullptr)
+                    {
+                        break;
+                    }
+                    shared.bump = slab;
+                    shared.bumpEnd = slab + slabSize / size * size;
+                }
+                *tail = reinterpret_cast<FreeBlock *>(shared.bump);
+                shared.bump += size;
+                tail = &(*tail)->next;
+                taken++;
+            }
+            *tail = nullptr;
+            return head;
+        }
+
+        // Returns a chain of blocks to the shared pool.
+        void giveBlocks(size_t index, FreeBlock *head, FreeBlock *last) noexcept
+        {
+            auto &shared = sharedClasses()[index];
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            last->next = shared.freeList;
+            shared.freeList = head;
+        }
+
+        struct ThreadCache
+        {
+            FreeBlock *heads[classCount] = {};
+            size_t counts[classCount] = {};
+
+            // Moves all but the first keep blocks of a class's cache, the
+            // least recently freed ones, to the shared pool.
+            void drain(size_t index, size_t keep) noexcept
+            {
+                FreeBlock **cut = &heads[index];
+                for (size_t i = 0; i < keep; i++)
+                {
+                    cut = &(*cut)->next;
+                }
+                FreeBlock *head = *cut;
+                FreeBlock *last = head;
+                while (last->next != nullptr)
+                {
+                    last = last->next;
+                }
+                *cut = nullptr;
+                counts[index] = keep;
+                giveBlocks(index, head, last);
+            }
+
+            ~ThreadCache();
+        };
+
+        // Set once this thread's cache is gone, payloads released later in the
+        // thread's shutdown go straight to the shared pool.
+        thread_local bool cacheRetired = false;
+        thread_local ThreadCache threadCache;
+
+        ThreadCache::~ThreadCache()
+        {
+            for (size_t index = 0; index < classCount; index++)
+            {
+                if (counts[index] > 0)
+                {
+                    drain(index, 0);
+                }
+            }
+            cacheRetired = true;
+        }
+    } // namespace
+
+    void *allocatePayload(size_t sizeInBytes)
+    {
+        ASSERT(sizeInBytes > 0);
+        if (sizeInBytes > payloadMaxPooledSize)
+        {
+            void *pointer = allocateAlligned(sizeInBytes, payloadGranularity);
+            if (pointer == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            return pointer;
+        }
+
+        const size_t index = classIndex(sizeInBytes);
+        size_t taken;
+        if (cacheRetired)
+        {
+            auto block = takeBlocks(index, 1, taken);
+            if (block == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            return block;
+        }
+
+        auto &cache = threadCache;
+        if (cache.heads[index] == nullptr)
+        {
+            cache.heads[index] = takeBlocks(index, batchSize, taken);
+            cache.counts[index] = taken;
+            if (taken == 0)
+            {
+                throw std::bad_alloc();
+            }
+        }
+
+        auto block = cache.heads[index];
+        cache.heads[index] = block->next;
+        cache.counts[index]--;
+        return block;
+    }
+
+    void deallocatePayload(void *pointer, size_t sizeInBytes) noexcept
+    {
+        if (pointer == nullptr)
+        {
+            return;
+        }
+        if (sizeInBytes > payloadMaxPooledSize)
+        {
+            freeAlligned(pointer);
+            return;
+        }
+
+        const size_t index = classIndex(sizeInBytes);
+        auto block = static_cast<FreeBlock *>(pointer);
+        if (cacheRetired)
+        {
+            giveBlocks(index, block, block);
+            return;
+        }
+
+        auto &cache = threadCache;
+        block->next = cache.heads[index];
+        cache.heads[index] = block;
+        if (++cache.counts[index] > cacheLimit)
+        {
+            cache.drain(index, cacheLimit - batchSize);
+        }
+    }
+} // namespace bg::inner
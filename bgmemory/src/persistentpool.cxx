@@ -0,0 +1,142 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pools/PersistentPool.hxx"
+
+#include <system_error>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bg::inner
+{
+#if defined(_WIN32)
+    namespace
+    {
+        [[noreturn]] void throwLastError(const char *what)
+        {
+            throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), what);
+        }
+    } // namespace
+
+    MappedFile::MappedFile(const std::string &path, size_t createSize)
+    {
+        HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS,
+                                    FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+        {
+            throwLastError("cannot open mapped file");
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(handle, &size))
+        {
+            CloseHandle(handle);
+            throwLastError("cannot read mapped file size");
+        }
+        if (size.QuadPart == 0)
+        {
+            size.QuadPart = static_cast<LONGLONG>(createSize);
+            if (!SetFilePointerEx(handle, size, nullptr, FILE_BEGIN) || !SetEndOfFile(handle))
+            {
+                CloseHandle(handle);
+                throwLastError("cannot size mapped file");
+            }
+            wasCreated = true;
+        }
+
+        HANDLE section = CreateFileMappingA(handle, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+        CloseHandle(handle);
+        if (section == nullptr)
+        {
+            throwLastError("cannot map file");
+        }
+        mapping = MapViewOfFile(section, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+        CloseHandle(section);
+        if (mapping == nullptr)
+        {
+            throwLastError("cannot map file");
+        }
+        mappedSize = static_cast<size_t>(size.QuadPart);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        UnmapViewOfFile(mapping);
+    }
+
+    void MappedFile::flush()
+    {
+        if (!FlushViewOfFile(mapping, 0))
+        {
+            throwLastError("cannot flush mapped file");
+        }
+    }
+#else
+    namespace
+    {
+        [[noreturn]] void throwErrno(const char *what)
+        {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+    } // namespace
+
+    MappedFile::MappedFile(const std::string &path, size_t createSize)
+    {
+        const int descriptor = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (descriptor < 0)
+        {
+            throwErrno("cannot open mapped file");
+        }
+
+        struct stat status;
+        if (fstat(descriptor, &status) != 0)
+        {
+            const int error = errno;
+            close(descriptor);
+            throw std::system_error(error, std::generic_category(), "cannot read mapped file size");
+        }
+        size_t size = static_cast<size_t>(status.st_size);
+        if (size == 0)
+        {
+            // Grows the file sparsely, blocks are only allocated once written.
+            if (ftruncate(descriptor, static_cast<off_t>(createSize)) != 0)
+            {
+                const int error = errno;
+                close(descriptor);
+                throw std::system_error(error, std::generic_category(), "cannot size mapped file");
+            }
+            size = createSize;
+            wasCreated = true;
+        }
+
+        void *pointer = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+        const int error = errno;
+        // The mapping keeps the file open on its own.
+        close(descriptor);
+        if (pointer == MAP_FAILED)
+        {
+            throw std::system_error(error, std::generic_category(), "cannot map file");
+        }
+        mapping = pointer;
+        mappedSize = size;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        munmap(mapping, mappedSize);
+    }
+
+    void MappedFile::flush()
+    {
+        if (msync(mapping, mappedSize, MS_SYNC) != 0)
+        {
+            throwErrno("cannot flush mapped file");
+        }
+    }
+#endif
+} // namespace bg::inner
@@ -0,0 +1,318 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/SmallObjectHeap.hxx"
+
+#include <stdint.h>
+
+#include "bgmemory/assert.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+
+namespace bg
+{
+    namespace inner
+    {
+        // Bookkeeping at the start of every slab.
+        struct SlabHeader
+        {
+            // Neighbours in the size class's partial list.
+            SlabHeader *prev = nullptr;
+            SlabHeader *next = nullptr;
+            // Neighbours in the heap's list of every slab.
+            SlabHeader *allPrev = nullptr;
+            SlabHeader *allNext = nullptr;
+            // Freed blocks, linked through their first bytes.
+            void *freeList = nullptr;
+            uint32_t blockSize = 0;
+            // Blocks past this index have never been handed out.
+            uint32_t bumpIndex = 0;
+            uint32_t used = 0;
+            uint32_t capacity = 0;
+            uint32_t classIndex = 0;
+            bool linked = false;
+        };
+    } // namespace inner
+
+    namespace
+    {
+        using inner::SlabHeader;
+
+        constexpr size_t classSizes[SmallObjectHeap::classCount] = {
+            8, 16, 32, 48, 64, 80, 96, 112, 128, 160, 192,
+            224, 256, 320, 384, 448, 512, 640, 768, 896, 1024};
+
+        // Blocks start after the header, on a cache line.
+        constexpr size_t headerSize = alignUp(sizeof(SlabHeader), cacheLineSize);
+
+        // Strictest alignment served from the size classes.
+        constexpr size_t maxSmallAlignment = 16;
+
+        constexpr size_t lookupCount = SmallObjectHeap::maxSmallSize / 8 + 1;
+
+        // Maps a size, in 8 byte steps, to the smallest class holding it.
+        struct ClassLookup
+        {
+            uint8_t classes[lookupCount] = {};
+
+            constexpr ClassLookup()
+            {
+                size_t index = 0;
+                for (size_t step = 0; step < lookupCount; step++)
+                {
+                    while (classSizes[index] < step * 8)
+                    {
+                        index++;
+                    }
+                    classes[step] = static_cast<uint8_t>(index);
+                }
+            }
+        };
+
+        constexpr ClassLookup lookup{};
+
+        // Gets the class serving a request, classCount if it is not served by one.
+        size_t classIndexFor(size_t sizeInBytes, size_t alignment) noexcept
+        {
+            if (alignment > maxSmallAlignment || sizeInBytes > SmallObjectHeap::maxSmallSize)
+            {
+                return SmallObjectHeap::classCount;
+            }
+            // Every class above 8 bytes is a multiple of 16.
+            if (alignment > 8 && sizeInBytes <= 8)
+            {
+                sizeInBytes = 16;
+            }
+            return lookup.classes[(sizeInBytes + 7) / 8];
+        }
+
+        SlabHeader *slabOf(void *pointer) noexcept
+        {
+            return reinterpret_cast<SlabHeader *>(
+                alignDown(reinterpret_cast<uintptr_t>(pointer), SmallObjectHeap::slabSize));
+        }
+
+        void linkPartial(SlabHeader *&head, SlabHeader *slab) noexcept
+        {
+            slab->prev = nullptr;
+            slab->next = head;
+            if (head != nullptr)
+            {
+                head->prev = slab;
+            }
+            head = slab;
+            slab->linked = true;
+        }
+
+        void unlinkPartial(SlabHeader *&head, SlabHeader *slab) noexcept
+        {
+            if (slab->prev != nullptr)
+            {
+                slab->prev->next = slab->next;
+            }
+            else
+            {
+                head = slab->next;
+            }
+            if (slab->next != nullptr)
+            {
+                slab->next->prev = slab->prev;
+            }
+            slab->prev = nullptr;
+            slab->next = nullptr;
+            slab->linked = false;
+        }
+
+        void resetSlab(SlabHeader *slab) noexcept
+        {
+            slab->freeList = nullptr;
+            slab->bumpIndex = 0;
+            slab->used = 0;
+        }
+    } // namespace
+
+    SmallObjectHeap::SmallObjectHeap(bool isThreadSafe) noexcept
+        : threadSafe(isThreadSafe)
+    {
+    }
+
+    SmallObjectHeap::~SmallObjectHeap()
+    {
+        while (slabs != nullptr)
+        {
+            auto slab = slabs;
+            slabs = slab->allNext;
+            freeAlligned(slab);
+        }
+    }
+
+    SlabHeader *SmallObjectHeap::createSlab(size_t classIndex)
+    {
+        void *memory = allocateAlligned(slabSize, slabSize);
+        if (memory == nullptr)
+        {
+            return nullptr;
+        }
+
+        auto slab = new (memory) SlabHeader();
+        slab->blockSize = static_cast<uint32_t>(classSizes[classIndex]);
+        slab->capacity = static_cast<uint32_t>((slabSize - headerSize) / classSizes[classIndex]);
+        slab->classIndex = static_cast<uint32_t>(classIndex);
+
+        std::unique_lock<std::mutex> lock(slabsMutex, std::defer_lock);
+        if (threadSafe)
+        {
+            lock.lock();
+        }
+        slab->allNext = slabs;
+        if (slabs != nullptr)
+        {
+            slabs->allPrev = slab;
+        }
+        slabs = slab;
+        slabTotal++;
+        return slab;
+    }
+
+    void SmallObjectHeap::destroySlab(SlabHeader *slab) noexcept
+    {
+        {
+            std::unique_lock<std::mutex> lock(slabsMutex, std::defer_lock);
+            if (threadSafe)
+            {
+                lock.lock();
+            }
+            if (slab->allPrev != nullptr)
+            {
+                slab->allPrev->allNext = slab->allNext;
+            }
+            else
+            {
+                slabs = slab->allNext;
+            }
+            if (slab->allNext != nullptr)
+            {
+                slab->allNext->allPrev = slab->allPrev;
+            }
+            slabTotal--;
+        }
+        freeAlligned(slab);
+    }
+
+    void *SmallObjectHeap::allocate(size_t sizeInBytes, size_t alignment)
+    {
+        ASSERT(isPowerOfTwo(alignment));
+        const size_t index = classIndexFor(sizeInBytes, alignment);
+        if (index == classCount)
+        {
+            return allocateAlligned(sizeInBytes, alignment);
+        }
+
+        auto &sizeClass = classes[index];
+        std::unique_lock<std::mutex> lock(sizeClass.mutex, std::defer_lock);
+        if (threadSafe)
+        {
+            lock.lock();
+        }
+
+        auto slab = sizeClass.partial;
+        if (slab == nullptr)
+        {
+            if (sizeClass.spare != nullptr)
+            {
+                slab = sizeClass.spare;
+                sizeClass.spare = nullptr;
+            }
+            else
+            {
+                slab = createSlab(index);
+                if (slab == nullptr)
+                {
+                    return nullptr;
+                }
+            }
+            linkPartial(sizeClass.partial, slab);
+        }
+
+        void *block;
+        if (slab->freeList != nullptr)
+        {
+            block = slab->freeList;
+            slab->freeList = *static_cast<void **>(block);
+        }
+        else
+        {
+            block = reinterpret_cast<unsigned char *>(slab) + headerSize +
+                    static_cast<size_t>(slab->bumpIndex) * slab->blockSize;
+            slab->bumpIndex++;
+        }
+
+        if (++slab->used == slab->capacity)
+        {
+            unlinkPartial(sizeClass.partial, slab);
+        }
+        return block;
+    }
+
+    void SmallObjectHeap::deallocate(void *pointer, size_t sizeInBytes, size_t alignment)
+    {
+        if (pointer == nullptr)
+        {
+            return;
+        }
+
+        const size_t index = classIndexFor(sizeInBytes, alignment);
+        if (index == classCount)
+        {
+            freeAlligned(pointer);
+            return;
+        }
+
+        auto slab = slabOf(pointer);
+        ASSERT(slab->classIndex == index);
+        auto &sizeClass = classes[index];
+        std::unique_lock<std::mutex> lock(sizeClass.mutex, std::defer_lock);
+        if (threadSafe)
+        {
+            lock.lock();
+        }
+
+        *static_cast<void **>(pointer) = slab->freeList;
+        slab->freeList = pointer;
+        if (!slab->linked)
+        {
+            linkPartial(sizeClass.partial, slab);
+        }
+
+        if (--slab->used > 0)
+        {
+            return;
+        }
+
+        unlinkPartial(sizeClass.partial, slab);
+        resetSlab(slab);
+        if (sizeClass.spare == nullptr)
+        {
+            sizeClass.spare = slab;
+            return;
+        }
+        if (lock.owns_lock())
+        {
+            lock.unlock();
+        }
+        destroySlab(slab);
+    }
+
+    size_t SmallObjectHeap::classSizeFor(size_t sizeInBytes, size_t alignment) noexcept
+    {
+        const size_t index = classIndexFor(sizeInBytes, alignment);
+        return index == classCount ? 0 : classSizes[index];
+    }
+
+    size_t SmallObjectHeap::slabCount() noexcept
+    {
+        std::unique_lock<std::mutex> lock(slabsMutex, std::defer_lock);
+        if (threadSafe)
+        {
+            lock.lock();
+        }
+        return slabTotal;
+    }
+} // namespace bg
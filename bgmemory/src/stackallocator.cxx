@@ -0,0 +1,30 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/StackAllocator.hxx"
+
+#include "bgmemory/assert.hxx"
+
+namespace bg
+{
+    void StackAllocator::deallocate(void *pointer, size_t sizeInBytes, size_t)
+    {
+        if (pointer == nullptr)
+        {
+            return;
+        }
+
+        ASSERT(owns(pointer));
+        auto bytes = static_cast<unsigned char *>(pointer);
+        const Marker start = static_cast<Marker>(bytes - static_cast<unsigned char *>(data()));
+#ifdef BG_MEMORY_DEBUG
+        if (start + sizeInBytes > getMarker())
+        {
+            reportMemoryError(MemoryError::DoubleFree, pointer, "block lies above the top of the StackAllocator");
+            return;
+        }
+#else
+        ASSERT(start + sizeInBytes <= getMarker());
+        static_cast<void>(sizeInBytes);
+#endif // BG_MEMORY_DEBUG
+        rollback(start);
+    }
+} // namespace bg
@@ -0,0 +1,35 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/TrackingAllocator.hxx"
+
+namespace bg
+{
+    TrackingAllocator::TrackingAllocator(Allocator &a, MemoryTracker &t) noexcept
+        : backing(&a), tracker(&t)
+    {
+    }
+
+    void *TrackingAllocator::allocate(size_t sizeInBytes, size_t alignment)
+    {
+        void *pointer = backing->allocate(sizeInBytes, alignment);
+        if (pointer != nullptr)
+        {
+            tracker->recordAllocation(sizeInBytes);
+        }
+        return pointer;
+    }
+
+    void TrackingAllocator::deallocate(void *pointer, size_t sizeInBytes, size_t alignment)
+    {
+        if (pointer == nullptr)
+        {
+            return;
+        }
+        tracker->recordFree(sizeInBytes);
+        backing->deallocate(pointer, sizeInBytes, alignment);
+    }
+
+    MemoryTracker &TrackingAllocator::getTracker() const noexcept
+    {
+        return *tracker;
+    }
+} // namespace bg
@@ -0,0 +1,87 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/VirtualArena.hxx"
+
+#include <new>
+
+#include "bgmemory/assert.hxx"
+#include "bgmemory/allocators/inner/BumpBlock.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+
+namespace bg
+{
+    VirtualArena::VirtualArena(size_t reserveBytes, size_t commitGranularity)
+        : granularity(alignUp(commitGranularity > 0 ? commitGranularity : 1, pageSize()))
+    {
+        if (reserveBytes == 0)
+        {
+            return;
+        }
+
+        reserved = alignUp(reserveBytes, granularity);
+        base = static_cast<unsigned char *>(reserveVirtual(reserved));
+        if (base == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+    }
+
+    VirtualArena::~VirtualArena()
+    {
+        releaseVirtual(base, reserved);
+    }
+
+    bool VirtualArena::commitTo(size_t end) noexcept
+    {
+        const size_t target = alignUp(end, granularity);
+        if (!commitVirtual(base + committedBytes, target - committedBytes))
+        {
+            return false;
+        }
+        committedBytes = target;
+        return true;
+    }
+
+    void *VirtualArena::allocate(size_t sizeInBytes, size_t alignment)
+    {
+        const size_t start = inner::bumpUp(base, offset, reserved, sizeInBytes, alignment);
+        if (start == inner::noRoom)
+        {
+            return nullptr;
+        }
+        if (start + sizeInBytes > committedBytes && !commitTo(start + sizeInBytes))
+        {
+            return nullptr;
+        }
+
+        offset = start + sizeInBytes;
+        BG_MEMORY_POISON(base + start, sizeInBytes, allocatedFill);
+        return base + start;
+    }
+
+    void VirtualArena::deallocate(void *, size_t, size_t)
+    {
+    }
+
+    void VirtualArena::rollback(Marker marker) noexcept
+    {
+        ASSERT(marker <= offset);
+        BG_MEMORY_POISON(base + marker, offset - marker, freedFill);
+        offset = marker;
+    }
+
+    void VirtualArena::trim() noexcept
+    {
+        const size_t keep = alignUp(offset, granularity);
+        if (keep < committedBytes)
+        {
+            decommitVirtual(base + keep, committedBytes - keep);
+            committedBytes = keep;
+        }
+    }
+
+    bool VirtualArena::owns(const void *pointer) const noexcept
+    {
+        auto bytes = static_cast<const unsigned char *>(pointer);
+        return bytes >= base && bytes < base + reserved;
+    }
+} // namespace bg
@@ -0,0 +1,254 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/bulletpool.hxx"
+#include "./pointers/TestHelpers.hxx"
+#include "./TestAllocators.hxx"
+#include "./debug/MemoryErrorRecorder.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <stdexcept>
+#include <vector>
+
+//---------------------
+//  Acquire
+//---------------------
+
+TEST(bullet_pool,
+     Acquire_Called_ConstructsObjectWithArguments)
+{
+  const int expected = 42;
+  bg::BulletPool<SimpleTestObject> pool(4);
+
+  auto object = pool.acquire(expected);
+
+  ASSERT_EQ(expected, object->GetValue());
+}
+
+TEST(bullet_pool,
+     Acquire_CalledUntilFull_ReturnsNullPtr)
+{
+  bg::BulletPool<int> pool(2);
+
+  pool.acquire(1);
+  pool.acquire(2);
+
+  ASSERT_TRUE(pool.full());
+  ASSERT_EQ(nullptr, pool.acquire(3));
+}
+
+TEST(bullet_pool,
+     Acquire_CalledOnFreshPool_HandsOutContiguousSlots)
+{
+  bg::BulletPool<double> pool(3);
+
+  auto first = pool.acquire(1.0);
+  auto second = pool.acquire(2.0);
+  auto third = pool.acquire(3.0);
+
+  ASSERT_EQ(first + 1, second);
+  ASSERT_EQ(second + 1, third);
+}
+
+TEST(bullet_pool,
+     Acquire_Called_IncrementsLiveCount)
+{
+  bg::BulletPool<int> pool(4);
+
+  pool.acquire(1);
+  pool.acquire(2);
+
+  ASSERT_EQ(2u, pool.liveCount());
+}
+
+TEST(bullet_pool,
+     Acquire_CalledOnZeroCapacityPool_ReturnsNullPtr)
+{
+  bg::BulletPool<int> pool(0);
+
+  ASSERT_EQ(nullptr, pool.acquire(1));
+}
+
+TEST(bullet_pool,
+     Acquire_ConstructorThrows_KeepsSlotFree)
+{
+  MemoryErrorRecorder recorder;
+  bg::BulletPool<ThrowingTestObject> pool(2);
+  auto first = pool.acquire(false);
+  pool.release(first);
+
+  ASSERT_THROW(pool.acquire(true), std::runtime_error);
+
+  ASSERT_EQ(0u, pool.liveCount());
+  ASSERT_EQ(first, pool.acquire(false));
+  ASSERT_NE(nullptr, pool.acquire(false));
+  ASSERT_TRUE(pool.full());
+  ASSERT_TRUE(recorder.errors().empty());
+}
+
+//---------------------
+//  Release
+//---------------------
+
+TEST(bullet_pool,
+     Release_Called_DestructsTheObject)
+{
+  TrackedDeletableTestObject::reset();
+  bg::BulletPool<TrackedDeletableTestObject> pool(4);
+
+  auto object = pool.acquire();
+  pool.release(object);
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+  ASSERT_EQ(0u, pool.liveCount());
+}
+
+TEST(bullet_pool,
+     Release_CalledThenAcquired_ReusesReleasedSlot)
+{
+  bg::BulletPool<int> pool(4);
+
+  pool.acquire(1);
+  auto released = pool.acquire(2);
+  pool.acquire(3);
+  pool.release(released);
+  auto reacquired = pool.acquire(4);
+
+  ASSERT_EQ(released, reacquired);
+}
+
+TEST(bullet_pool,
+     Release_CalledOnFullPool_AllowsAnotherAcquire)
+{
+  bg::BulletPool<int> pool(1);
+
+  auto object = pool.acquire(1);
+  pool.release(object);
+
+  ASSERT_NE(nullptr, pool.acquire(2));
+}
+
+TEST(bullet_pool,
+     Release_CalledWithNullPtr_DoesNothing)
+{
+  bg::BulletPool<int> pool(1);
+  pool.acquire(1);
+
+  pool.release(nullptr);
+
+  ASSERT_EQ(1u, pool.liveCount());
+}
+
+//---------------------
+//  ForEach
+//---------------------
+
+TEST(bullet_pool,
+     ForEach_Called_VisitsLiveObjectsInMemoryOrder)
+{
+  bg::BulletPool<int> pool(130);
+  std::vector<int *> objects;
+  for (int i = 0; i < 130; i++)
+  {
+    objects.push_back(pool.acquire(i));
+  }
+  for (int i = 0; i < 130; i += 3)
+  {
+    pool.release(objects[i]);
+  }
+
+  std::vector<int> visited;
+  pool.forEach([&visited](int &value) { visited.push_back(value); });
+
+  std::vector<int> expected;
+  for (int i = 0; i < 130; i++)
+  {
+    if (i % 3 != 0)
+    {
+      expected.push_back(i);
+    }
+  }
+  ASSERT_EQ(expected, visited);
+}
+
+TEST(bullet_pool,
+     ForEach_CalledOnConstPool_VisitsLiveObjects)
+{
+  bg::BulletPool<int> pool(4);
+  pool.acquire(1);
+  pool.acquire(2);
+  const auto &constPool = pool;
+
+  int sum = 0;
+  constPool.forEach([&sum](const int &value) { sum += value; });
+
+  ASSERT_EQ(3, sum);
+}
+
+//---------------------
+//  Clear / Destructor
+//---------------------
+
+TEST(bullet_pool,
+     Clear_CalledWithLiveObjects_DestructsAllObjects)
+{
+  TrackedDeletableTestObject::reset();
+  bg::BulletPool<TrackedDeletableTestObject> pool(4);
+  pool.acquire();
+  pool.acquire();
+
+  pool.clear();
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+  ASSERT_EQ(0u, pool.liveCount());
+  ASSERT_FALSE(pool.full());
+}
+
+TEST(bullet_pool,
+     Destructor_CalledWithLiveObjects_DestructsAllObjects)
+{
+  TrackedDeletableTestObject::reset();
+
+  {
+    bg::BulletPool<TrackedDeletableTestObject> pool(4);
+    pool.acquire();
+    pool.acquire();
+  }
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+//---------------------
+//  Owns
+//---------------------
+
+TEST(bullet_pool,
+     Owns_CalledWithForeignPointer_ReturnsFalse)
+{
+  bg::BulletPool<int> pool(4);
+  int local = 0;
+
+  ASSERT_FALSE(pool.owns(&local));
+  ASSERT_TRUE(pool.owns(pool.acquire(1)));
+}
+
+//---------------------
+//  Allocator
+//---------------------
+
+TEST(bullet_pool,
+     Constructor_CalledWithAllocator_AllocatesStorageOnceFromIt)
+{
+  CountingTestAllocator allocator;
+
+  {
+    bg::BulletPool<int> pool(64, allocator);
+    for (int i = 0; i < 64; i++)
+    {
+      pool.release(pool.acquire(i));
+    }
+
+    ASSERT_EQ(1, allocator.getAllocateCount());
+  }
+
+  ASSERT_EQ(1, allocator.getDeallocateCount());
+}
@@ -0,0 +1,123 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/memoryfunctions.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <stdint.h>
+#include <string.h>
+
+//---------------------
+//  AllocateAlligned
+//---------------------
+
+TEST(memory_functions,
+     AllocateAlligned_CalledWithSimdAlignments_ReturnsAlignedPointers)
+{
+  const size_t alignments[] = {bg::simd128Alignment, bg::simd256Alignment, bg::simd512Alignment, bg::cacheLineSize, 4096};
+
+  for (auto alignment : alignments)
+  {
+    void *pointer = bg::allocateAlligned(100, alignment);
+
+    ASSERT_NE(nullptr, pointer);
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(pointer) % alignment);
+    bg::freeAlligned(pointer);
+  }
+}
+
+TEST(memory_functions,
+     AllocateAlligned_CalledWithSmallAlignment_ReturnsUsableMemory)
+{
+  auto pointer = static_cast<unsigned char *>(bg::allocateAlligned(64, 1));
+
+  ASSERT_NE(nullptr, pointer);
+  memset(pointer, 0xAB, 64);
+  ASSERT_EQ(0xAB, pointer[63]);
+  bg::freeAlligned(pointer);
+}
+
+TEST(memory_functions,
+     FreeAlligned_CalledWithNullPtr_DoesNothing)
+{
+  bg::freeAlligned(nullptr);
+}
+
+//---------------------
+//  Virtual Memory
+//---------------------
+
+TEST(memory_functions,
+     PageSize_Called_ReturnsPowerOfTwo)
+{
+  ASSERT_TRUE(bg::isPowerOfTwo(bg::pageSize()));
+}
+
+TEST(memory_functions,
+     ReserveVirtual_Called_ReturnsPageAlignedRange)
+{
+  const size_t size = 1024 * bg::pageSize();
+  void *range = bg::reserveVirtual(size);
+
+  ASSERT_NE(nullptr, range);
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(range) % bg::pageSize());
+  bg::releaseVirtual(range, size);
+}
+
+TEST(memory_functions,
+     CommitVirtual_Called_PagesAreZeroAndWritable)
+{
+  const size_t page = bg::pageSize();
+  auto range = static_cast<unsigned char *>(bg::reserveVirtual(16 * page));
+
+  ASSERT_TRUE(bg::commitVirtual(range + page, 2 * page));
+
+  ASSERT_EQ(0, range[page]);
+  memset(range + page, 0xAB, 2 * page);
+  ASSERT_EQ(0xAB, range[3 * page - 1]);
+  bg::releaseVirtual(range, 16 * page);
+}
+
+TEST(memory_functions,
+     DecommitVirtual_ThenCommitted_PagesReadZero)
+{
+  const size_t page = bg::pageSize();
+  auto range = static_cast<unsigned char *>(bg::reserveVirtual(4 * page));
+  bg::commitVirtual(range, 4 * page);
+  memset(range, 0xAB, 4 * page);
+
+  bg::decommitVirtual(range, 2 * page);
+  ASSERT_TRUE(bg::commitVirtual(range, 2 * page));
+
+  ASSERT_EQ(0, range[0]);
+  ASSERT_EQ(0, range[2 * page - 1]);
+  ASSERT_EQ(0xAB, range[2 * page]);
+  bg::releaseVirtual(range, 4 * page);
+}
+
+TEST(memory_functions,
+     ReleaseVirtual_CalledWithNullPtr_DoesNothing)
+{
+  bg::releaseVirtual(nullptr, 0);
+}
+
+//---------------------
+//  AlignUp
+//---------------------
+
+TEST(memory_functions,
+     AlignUp_Called_RoundsToNextMultiple)
+{
+  ASSERT_EQ(0u, bg::alignUp(0, 16));
+  ASSERT_EQ(16u, bg::alignUp(1, 16));
+  ASSERT_EQ(16u, bg::alignUp(16, 16));
+  ASSERT_EQ(64u, bg::alignUp(33, 64));
+}
+
+TEST(memory_functions,
+     IsPowerOfTwo_Called_ReturnsExpected)
+{
+  ASSERT_TRUE(bg::isPowerOfTwo(1));
+  ASSERT_TRUE(bg::isPowerOfTwo(64));
+  ASSERT_FALSE(bg::isPowerOfTwo(0));
+  ASSERT_FALSE(bg::isPowerOfTwo(48));
+}
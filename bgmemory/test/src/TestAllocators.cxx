@@ -0,0 +1,48 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "./TestAllocators.hxx"
+
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+
+namespace
+{
+  std::atomic<long> globalNewCount(0);
+}
+
+long getGlobalNewCount()
+{
+  return globalNewCount.load();
+}
+
+void *operator new(size_t size)
+{
+  globalNewCount++;
+  void *pointer = malloc(size == 0 ? 1 : size);
+  if (pointer == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+  globalNewCount++;
+  return malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+  free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+  free(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept
+{
+  free(pointer);
+}
@@ -0,0 +1,44 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef TEST_TESTALLOCATORS_HXX_
+#define TEST_TESTALLOCATORS_HXX_
+
+#include "bgmemory/memoryfunctions.hxx"
+#include "bgmemory/allocators/Allocator.hxx"
+
+/*
+  Allocator forwarding to the aligned heap while counting calls and
+  outstanding bytes, for checking who allocates what.
+*/
+class CountingTestAllocator : public bg::Allocator
+{
+  int allocateCount = 0;
+  int deallocateCount = 0;
+  size_t liveBytes = 0;
+
+public:
+  void *allocate(size_t sizeInBytes, size_t alignment) override
+  {
+    allocateCount++;
+    liveBytes += sizeInBytes;
+    return bg::allocateAlligned(sizeInBytes, alignment);
+  }
+
+  void deallocate(void *pointer, size_t sizeInBytes, size_t) override
+  {
+    deallocateCount++;
+    liveBytes -= sizeInBytes;
+    bg::freeAlligned(pointer);
+  }
+
+  int getAllocateCount() const { return allocateCount; }
+  int getDeallocateCount() const { return deallocateCount; }
+  size_t getLiveBytes() const { return liveBytes; }
+};
+
+/*
+  Gets the number of calls made to the global operator new so far by any
+  thread. The test binary replaces the global operator new to count calls.
+*/
+long getGlobalNewCount();
+
+#endif // TEST_TESTALLOCATORS_HXX_
@@ -0,0 +1,254 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/DebugAllocator.hxx"
+#include "bgmemory/bulletpool.hxx"
+#include "../TestAllocators.hxx"
+#include "../debug/MemoryErrorRecorder.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <stdint.h>
+#include <sstream>
+#include <string>
+
+using bg::MemoryError;
+using ::testing::ElementsAre;
+
+namespace
+{
+  // Handler which calls back into the allocator under test.
+  bg::DebugAllocator *reenteredAllocator = nullptr;
+  size_t reenteredLiveCount = 0;
+
+  void reenteringHandler(MemoryError, const void *, const char *)
+  {
+    reenteredLiveCount = reenteredAllocator->liveCount();
+  }
+} // namespace
+
+//---------------------
+//  Allocate
+//---------------------
+
+TEST(debug_allocator,
+     Allocate_Called_ReturnsAlignedFilledMemory)
+{
+  bg::DebugAllocator allocator;
+
+  auto pointer = allocator.allocate(40, 64);
+
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(pointer) % 64);
+  ASSERT_TRUE(bg::isPoisoned(pointer, 40, bg::allocatedFill));
+  allocator.deallocate(pointer, 40, 64);
+}
+
+TEST(debug_allocator,
+     Allocate_Called_SurroundsBlockWithGuards)
+{
+  bg::DebugAllocator allocator;
+
+  auto pointer = static_cast<unsigned char *>(allocator.allocate(10, 8));
+
+  ASSERT_TRUE(bg::isPoisoned(pointer - bg::DebugAllocator::guardSize, bg::DebugAllocator::guardSize, bg::guardFill));
+  ASSERT_TRUE(bg::isPoisoned(pointer + 10, bg::DebugAllocator::guardSize, bg::guardFill));
+  allocator.deallocate(pointer, 10, 8);
+}
+
+//---------------------
+//  Deallocate
+//---------------------
+
+TEST(debug_allocator,
+     Deallocate_OverrunPastBlock_ReportsGuardCorrupted)
+{
+  MemoryErrorRecorder recorder;
+  bg::DebugAllocator allocator;
+  auto pointer = static_cast<unsigned char *>(allocator.allocate(10, 8));
+
+  pointer[10] = 0;
+  allocator.deallocate(pointer, 10, 8);
+
+  ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::GuardCorrupted));
+}
+
+TEST(debug_allocator,
+     Deallocate_UnderrunBeforeBlock_ReportsGuardCorrupted)
+{
+  MemoryErrorRecorder recorder;
+  bg::DebugAllocator allocator;
+  auto pointer = static_cast<unsigned char *>(allocator.allocate(10, 8));
+
+  pointer[-1] = 0;
+
+  ASSERT_EQ(1u, allocator.checkGuards());
+  ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::GuardCorrupted));
+  pointer[-1] = bg::guardFill;
+  allocator.deallocate(pointer, 10, 8);
+}
+
+TEST(debug_allocator,
+     Deallocate_HandlerCallsBackIntoAllocator_DoesNotDeadlock)
+{
+  MemoryErrorRecorder recorder;
+  bg::DebugAllocator allocator;
+  auto pointer = static_cast<unsigned char *>(allocator.allocate(10, 8));
+  auto other = allocator.allocate(8, 8);
+  reenteredAllocator = &allocator;
+  reenteredLiveCount = 0;
+  bg::setMemoryErrorHandler(&reenteringHandler);
+
+  pointer[10] = 0;
+  allocator.deallocate(pointer, 12, 8);
+
+  ASSERT_EQ(1u, reenteredLiveCount);
+  allocator.deallocate(other, 8, 8);
+}
+
+TEST(debug_allocator,
+     CheckGuards_HandlerCallsBackIntoAllocator_DoesNotDeadlock)
+{
+  MemoryErrorRecorder recorder;
+  bg::DebugAllocator allocator;
+  auto pointer = static_cast<unsigned char *>(allocator.allocate(10, 8));
+  reenteredAllocator = &allocator;
+  reenteredLiveCount = 0;
+  bg::setMemoryErrorHandler(&reenteringHandler);
+
+  pointer[10] = 0;
+
+  ASSERT_EQ(1u, allocator.checkGuards());
+  ASSERT_EQ(1u, reenteredLiveCount);
+  pointer[10] = bg::guardFill;
+  allocator.deallocate(pointer, 10, 8);
+}
+
+TEST(debug_allocator,
+     Deallocate_CalledTwice_ReportsDoubleFree)
+{
+  MemoryErrorRecorder recorder;
+  bg::DebugAllocator allocator;
+  auto pointer = allocator.allocate(32, 8);
+
+  allocator.deallocate(pointer, 32, 8);
+  allocator.deallocate(pointer, 32, 8);
+
+  ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::DoubleFree));
+}
+
+TEST(debug_allocator,
+     Deallocate_ForeignPointer_ReportsInvalidFree)
+{
+  MemoryErrorRecorder recorder;
+  bg::DebugAllocator allocator;
+  int local = 0;
+
+  allocator.deallocate(&local, sizeof(local), alignof(int));
+
+  ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::InvalidFree));
+}
+
+TEST(debug_allocator,
+     Deallocate_Called_PoisonsBlock)
+{
+  bg::DebugAllocator allocator;
+  auto pointer = allocator.allocate(32, 8);
+
+  allocator.deallocate(pointer, 32, 8);
+
+  ASSERT_TRUE(bg::isPoisoned(pointer, 32, bg::freedFill));
+}
+
+//---------------------
+//  Quarantine
+//---------------------
+
+TEST(debug_allocator,
+     FlushQuarantine_FreedBlockWrittenTo_ReportsUseAfterFree)
+{
+  MemoryErrorRecorder recorder;
+  bg::DebugAllocator allocator;
+  auto pointer = static_cast<int *>(allocator.allocate(sizeof(int), alignof(int)));
+  allocator.deallocate(pointer, sizeof(int), alignof(int));
+
+  *pointer = 7;
+  allocator.flushQuarantine();
+
+  ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::UseAfterFree));
+}
+
+TEST(debug_allocator,
+     Deallocate_QuarantineFull_ReturnsOldestBlock)
+{
+  CountingTestAllocator backing;
+  bg::DebugAllocator allocator(backing, 2);
+
+  for (int i = 0; i < 3; i++)
+  {
+    allocator.deallocate(allocator.allocate(16, 8), 16, 8);
+  }
+
+  ASSERT_EQ(1, backing.getDeallocateCount());
+}
+
+//---------------------
+//  Leaks
+//---------------------
+
+TEST(debug_allocator,
+     ReportLeaks_LiveBlocks_ListsAllocationSites)
+{
+  bg::DebugAllocator allocator;
+  void *pointer;
+  int siteLine;
+  {
+    BG_MEMORY_ALLOCATION_SITE(); siteLine = __LINE__;
+    pointer = allocator.allocate(24, 8);
+  }
+  std::ostringstream out;
+
+  ASSERT_EQ(1u, allocator.reportLeaks(out));
+
+  auto report = out.str();
+  ASSERT_NE(std::string::npos, report.find("24 bytes"));
+#ifdef BG_MEMORY_DEBUG
+  ASSERT_NE(std::string::npos, report.find("DebugAllocator.cxx:" + std::to_string(siteLine)));
+#else
+  static_cast<void>(siteLine);
+#endif // BG_MEMORY_DEBUG
+  allocator.deallocate(pointer, 24, 8);
+  ASSERT_EQ(0u, allocator.liveCount());
+}
+
+TEST(debug_allocator,
+     Destructor_LiveBlocks_ReportsLeaks)
+{
+  MemoryErrorRecorder recorder;
+  CountingTestAllocator backing;
+  void *leaked;
+
+  {
+    bg::DebugAllocator allocator(backing);
+    leaked = allocator.allocate(8, 8);
+  }
+
+  ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::Leak));
+  bg::freeAlligned(static_cast<unsigned char *>(leaked) - bg::DebugAllocator::guardSize);
+}
+
+//---------------------
+//  Integration
+//---------------------
+
+TEST(debug_allocator,
+     BulletPool_BackedByDebugAllocator_ReportsNoErrors)
+{
+  MemoryErrorRecorder recorder;
+  bg::DebugAllocator allocator;
+
+  {
+    bg::BulletPool<double> pool(16, allocator);
+    pool.release(pool.acquire(1.0));
+  }
+
+  ASSERT_TRUE(recorder.errors().empty());
+  ASSERT_EQ(0u, allocator.liveCount());
+}
@@ -0,0 +1,117 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/DoubleEndedStackAllocator.hxx"
+#include "../TestAllocators.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <stdint.h>
+
+//---------------------
+//  Allocate
+//---------------------
+
+TEST(double_ended_stack_allocator,
+     Allocate_CalledOnBothEnds_GrowsFromOppositeEnds)
+{
+  bg::DoubleEndedStackAllocator stack(1024);
+
+  auto low = static_cast<unsigned char *>(stack.lower().allocate(16, 8));
+  auto high = static_cast<unsigned char *>(stack.upper().allocate(16, 8));
+
+  ASSERT_EQ(1024 - 16, high - low);
+  ASSERT_EQ(1024u - 32u, stack.remaining());
+}
+
+TEST(double_ended_stack_allocator,
+     Allocate_CalledOnUpperEnd_ReturnsAlignedMemory)
+{
+  bg::DoubleEndedStackAllocator stack(1024);
+
+  stack.upper().allocate(3, 1);
+  auto pointer = stack.upper().allocate(8, 64);
+
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(pointer) % 64);
+  ASSERT_TRUE(stack.owns(pointer));
+}
+
+TEST(double_ended_stack_allocator,
+     Allocate_CalledUntilEndsMeet_ReturnsNullPtr)
+{
+  bg::DoubleEndedStackAllocator stack(128);
+
+  ASSERT_NE(nullptr, stack.lower().allocate(64, 8));
+  ASSERT_NE(nullptr, stack.upper().allocate(64, 8));
+  ASSERT_EQ(nullptr, stack.lower().allocate(1, 1));
+  ASSERT_EQ(nullptr, stack.upper().allocate(1, 1));
+}
+
+TEST(double_ended_stack_allocator,
+     Allocate_CalledAfterOtherEndShrinks_UsesFreedSpace)
+{
+  bg::DoubleEndedStackAllocator stack(128);
+  auto transient = stack.upper().allocate(100, 8);
+
+  ASSERT_EQ(nullptr, stack.lower().allocate(64, 8));
+  stack.upper().deallocate(transient, 100, 8);
+
+  ASSERT_NE(nullptr, stack.lower().allocate(64, 8));
+}
+
+//---------------------
+//  Deallocate / Markers
+//---------------------
+
+TEST(double_ended_stack_allocator,
+     Deallocate_CalledInReverseOrderOnUpperEnd_ReclaimsEverything)
+{
+  bg::DoubleEndedStackAllocator stack(1024);
+  auto first = stack.upper().allocate(3, 1);
+  auto second = stack.upper().allocate(8, 64);
+
+  stack.upper().deallocate(second, 8, 64);
+  stack.upper().deallocate(first, 3, 1);
+
+  ASSERT_EQ(0u, stack.upper().used());
+}
+
+TEST(double_ended_stack_allocator,
+     Rollback_CalledOnOneEnd_LeavesOtherEndAlone)
+{
+  bg::DoubleEndedStackAllocator stack(1024);
+  stack.lower().allocate(100, 8);
+  auto marker = stack.upper().getMarker();
+  stack.upper().allocate(200, 8);
+
+  stack.upper().rollback(marker);
+
+  ASSERT_EQ(0u, stack.upper().used());
+  ASSERT_EQ(100u, stack.lower().used());
+}
+
+TEST(double_ended_stack_allocator,
+     Reset_Called_EmptiesBothEnds)
+{
+  bg::DoubleEndedStackAllocator stack(1024);
+  stack.lower().allocate(100, 8);
+  stack.upper().allocate(100, 8);
+
+  stack.reset();
+
+  ASSERT_EQ(1024u, stack.remaining());
+}
+
+TEST(double_ended_stack_allocator,
+     Constructor_CalledWithAllocator_AllocatesBlockOnceFromIt)
+{
+  CountingTestAllocator allocator;
+
+  {
+    bg::DoubleEndedStackAllocator stack(4096, allocator);
+    stack.lower().allocate(16, 16);
+    stack.upper().allocate(16, 16);
+
+    ASSERT_EQ(1, allocator.getAllocateCount());
+  }
+
+  ASSERT_EQ(1, allocator.getDeallocateCount());
+}
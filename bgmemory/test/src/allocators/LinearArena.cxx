@@ -0,0 +1,197 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/LinearArena.hxx"
+#include "bgmemory/allocators/StdAllocator.hxx"
+#include "../TestAllocators.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <stdint.h>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+//---------------------
+//  Allocate
+//---------------------
+
+TEST(linear_arena,
+     Allocate_Called_ReturnsAlignedMemory)
+{
+  bg::LinearArena arena(1024);
+
+  arena.allocate(1, 1);
+  auto pointer = arena.allocate(16, 64);
+
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(pointer) % 64);
+  ASSERT_TRUE(arena.owns(pointer));
+}
+
+TEST(linear_arena,
+     Allocate_CalledRepeatedly_ReturnsContiguousMemory)
+{
+  bg::LinearArena arena(1024);
+
+  auto first = static_cast<unsigned char *>(arena.allocate(8, 8));
+  auto second = static_cast<unsigned char *>(arena.allocate(8, 8));
+
+  ASSERT_EQ(first + 8, second);
+  ASSERT_EQ(16u, arena.used());
+}
+
+TEST(linear_arena,
+     Allocate_CalledPastCapacity_ReturnsNullPtr)
+{
+  bg::LinearArena arena(64);
+
+  ASSERT_NE(nullptr, arena.allocate(60, 1));
+  ASSERT_EQ(nullptr, arena.allocate(8, 1));
+  ASSERT_EQ(60u, arena.used());
+}
+
+TEST(linear_arena,
+     Allocate_CalledOnZeroCapacityArena_ReturnsNullPtr)
+{
+  bg::LinearArena arena(0);
+
+  ASSERT_EQ(nullptr, arena.allocate(1, 1));
+}
+
+//---------------------
+//  Markers / Reset
+//---------------------
+
+TEST(linear_arena,
+     Rollback_CalledWithMarker_FreesLaterAllocations)
+{
+  bg::LinearArena arena(1024);
+  arena.allocate(32, 8);
+  auto marker = arena.getMarker();
+  auto first = arena.allocate(100, 8);
+  arena.allocate(100, 8);
+
+  arena.rollback(marker);
+
+  ASSERT_EQ(32u, arena.used());
+  ASSERT_EQ(first, arena.allocate(100, 8));
+}
+
+TEST(linear_arena,
+     Reset_Called_FreesEverything)
+{
+  bg::LinearArena arena(1024);
+  auto first = arena.allocate(100, 8);
+  arena.allocate(100, 8);
+
+  arena.reset();
+
+  ASSERT_EQ(0u, arena.used());
+  ASSERT_EQ(1024u, arena.remaining());
+  ASSERT_EQ(first, arena.allocate(100, 8));
+}
+
+TEST(linear_arena,
+     ArenaScope_Exited_RollsArenaBack)
+{
+  bg::LinearArena arena(1024);
+  arena.allocate(16, 8);
+
+  {
+    bg::ArenaScope scope(arena);
+    arena.allocate(200, 8);
+    ASSERT_EQ(216u, arena.used());
+  }
+
+  ASSERT_EQ(16u, arena.used());
+}
+
+//---------------------
+//  Backing allocator
+//---------------------
+
+TEST(linear_arena,
+     Constructor_CalledWithAllocator_AllocatesBlockOnceFromIt)
+{
+  CountingTestAllocator allocator;
+
+  {
+    bg::LinearArena arena(4096, allocator);
+    for (int i = 0; i < 100; i++)
+    {
+      arena.allocate(16, 16);
+    }
+    arena.reset();
+
+    ASSERT_EQ(1, allocator.getAllocateCount());
+  }
+
+  ASSERT_EQ(1, allocator.getDeallocateCount());
+}
+
+//---------------------
+//  Std containers
+//---------------------
+
+TEST(linear_arena,
+     Vector_PushedBack_DrawsFromArena)
+{
+  bg::LinearArena arena(64 * 1024);
+
+  std::vector<int, bg::StdAllocator<int>> values{bg::StdAllocator<int>(arena)};
+  for (int i = 0; i < 100; i++)
+  {
+    values.push_back(i);
+  }
+
+  ASSERT_TRUE(arena.owns(values.data()));
+  ASSERT_EQ(99, values.back());
+}
+
+TEST(linear_arena,
+     UnorderedMap_Inserted_DrawsFromArena)
+{
+  bg::LinearArena arena(64 * 1024);
+  using MapAllocator = bg::StdAllocator<std::pair<const int, int>>;
+
+  std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, MapAllocator> values{
+      16, std::hash<int>(), std::equal_to<int>(), MapAllocator(arena)};
+  for (int i = 0; i < 50; i++)
+  {
+    values[i] = i * 2;
+  }
+
+  ASSERT_LT(0u, arena.used());
+  ASSERT_TRUE(arena.owns(&values.at(10)));
+  ASSERT_EQ(20, values.at(10));
+}
+
+//---------------------
+//  DoubleBufferedArena
+//---------------------
+
+TEST(double_buffered_arena,
+     SwapBuffers_Called_KeepsLastFrameReadable)
+{
+  bg::DoubleBufferedArena arenas(1024);
+  auto value = static_cast<int *>(arenas.current().allocate(sizeof(int), alignof(int)));
+  *value = 42;
+
+  arenas.swapBuffers();
+  arenas.current().allocate(512, 8);
+
+  ASSERT_TRUE(arenas.previous().owns(value));
+  ASSERT_EQ(42, *value);
+}
+
+TEST(double_buffered_arena,
+     SwapBuffers_CalledTwice_FreesDataFromTwoFramesAgo)
+{
+  bg::DoubleBufferedArena arenas(1024);
+  auto &first = arenas.current();
+  first.allocate(100, 8);
+
+  arenas.swapBuffers();
+  arenas.swapBuffers();
+
+  ASSERT_EQ(&first, &arenas.current());
+  ASSERT_EQ(0u, arenas.current().used());
+}
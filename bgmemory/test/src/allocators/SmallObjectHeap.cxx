@@ -0,0 +1,259 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/SmallObjectHeap.hxx"
+#include "bgmemory/allocators/StdAllocator.hxx"
+#include "bgmemory/pointers/MutableSharedPtr.hxx"
+#include "../TestAllocators.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+//---------------------
+//  ClassSizeFor
+//---------------------
+
+TEST(small_object_heap,
+     ClassSizeFor_SmallRequest_RoundsUpToClass)
+{
+  ASSERT_EQ(8u, bg::SmallObjectHeap::classSizeFor(1, 1));
+  ASSERT_EQ(16u, bg::SmallObjectHeap::classSizeFor(9, 8));
+  ASSERT_EQ(48u, bg::SmallObjectHeap::classSizeFor(33, 8));
+  ASSERT_EQ(1024u, bg::SmallObjectHeap::classSizeFor(1024, 8));
+}
+
+TEST(small_object_heap,
+     ClassSizeFor_SixteenByteAlignment_SkipsEightByteClass)
+{
+  ASSERT_EQ(16u, bg::SmallObjectHeap::classSizeFor(4, 16));
+}
+
+TEST(small_object_heap,
+     ClassSizeFor_LargeOrOveraligned_ReturnsZero)
+{
+  ASSERT_EQ(0u, bg::SmallObjectHeap::classSizeFor(1025, 8));
+  ASSERT_EQ(0u, bg::SmallObjectHeap::classSizeFor(16, 32));
+}
+
+//---------------------
+//  Allocate
+//---------------------
+
+TEST(small_object_heap,
+     Allocate_SameClass_StoresNoHeader)
+{
+  bg::SmallObjectHeap heap;
+
+  auto first = static_cast<unsigned char *>(heap.allocate(24, 8));
+  auto second = static_cast<unsigned char *>(heap.allocate(32, 8));
+
+  ASSERT_EQ(first + 32, second);
+  heap.deallocate(first, 24, 8);
+  heap.deallocate(second, 32, 8);
+}
+
+TEST(small_object_heap,
+     Allocate_Called_ReturnsAlignedMemory)
+{
+  bg::SmallObjectHeap heap;
+  std::vector<void *> blocks;
+
+  for (size_t size = 1; size <= bg::SmallObjectHeap::maxSmallSize; size += 7)
+  {
+    auto pointer = heap.allocate(size, 16);
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(pointer) % 16);
+    blocks.push_back(pointer);
+  }
+
+  size_t size = 1;
+  for (auto pointer : blocks)
+  {
+    heap.deallocate(pointer, size, 16);
+    size += 7;
+  }
+}
+
+TEST(small_object_heap,
+     Allocate_LargeRequest_FallsBackToAlignedHeap)
+{
+  bg::SmallObjectHeap heap;
+
+  auto pointer = heap.allocate(4096, 64);
+
+  ASSERT_NE(nullptr, pointer);
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(pointer) % 64);
+  ASSERT_EQ(0u, heap.slabCount());
+  heap.deallocate(pointer, 4096, 64);
+}
+
+TEST(small_object_heap,
+     Allocate_ManyBlocks_KeepsContentsApart)
+{
+  bg::SmallObjectHeap heap;
+  std::vector<unsigned char *> blocks;
+
+  for (int i = 0; i < 4000; i++)
+  {
+    auto pointer = static_cast<unsigned char *>(heap.allocate(40, 8));
+    memset(pointer, i & 0xff, 40);
+    blocks.push_back(pointer);
+  }
+
+  for (int i = 0; i < 4000; i++)
+  {
+    ASSERT_EQ(static_cast<unsigned char>(i & 0xff), blocks[i][0]);
+    ASSERT_EQ(static_cast<unsigned char>(i & 0xff), blocks[i][39]);
+    heap.deallocate(blocks[i], 40, 8);
+  }
+}
+
+//---------------------
+//  Deallocate
+//---------------------
+
+TEST(small_object_heap,
+     Deallocate_Called_ReusesBlock)
+{
+  bg::SmallObjectHeap heap;
+  auto first = heap.allocate(64, 8);
+  heap.allocate(64, 8);
+
+  heap.deallocate(first, 64, 8);
+
+  ASSERT_EQ(first, heap.allocate(64, 8));
+}
+
+TEST(small_object_heap,
+     Deallocate_FullSlab_MakesItAvailableAgain)
+{
+  bg::SmallObjectHeap heap;
+  std::vector<void *> blocks;
+  while (heap.slabCount() < 2)
+  {
+    blocks.push_back(heap.allocate(1024, 8));
+  }
+  auto lastOfFirstSlab = blocks[blocks.size() - 2];
+
+  heap.deallocate(lastOfFirstSlab, 1024, 8);
+
+  ASSERT_EQ(lastOfFirstSlab, heap.allocate(1024, 8));
+}
+
+TEST(small_object_heap,
+     Deallocate_EmptySlabs_ReturnsAllButOneToSystem)
+{
+  bg::SmallObjectHeap heap;
+  std::vector<void *> blocks;
+  for (int i = 0; i < 64; i++)
+  {
+    blocks.push_back(heap.allocate(1024, 8));
+  }
+  ASSERT_GT(heap.slabCount(), 2u);
+
+  for (auto pointer : blocks)
+  {
+    heap.deallocate(pointer, 1024, 8);
+  }
+
+  ASSERT_EQ(1u, heap.slabCount());
+}
+
+TEST(small_object_heap,
+     Deallocate_NullPtr_DoesNothing)
+{
+  bg::SmallObjectHeap heap;
+
+  heap.deallocate(nullptr, 16, 8);
+
+  ASSERT_EQ(0u, heap.slabCount());
+}
+
+//---------------------
+//  Destructor
+//---------------------
+
+TEST(small_object_heap,
+     Destructor_BlocksStillAllocated_DoesNotLeakSlabs)
+{
+  bg::SmallObjectHeap heap;
+
+  for (int i = 0; i < 100; i++)
+  {
+    heap.allocate(512, 8);
+  }
+
+  ASSERT_GT(heap.slabCount(), 1u);
+}
+
+//---------------------
+//  Integration
+//---------------------
+
+TEST(small_object_heap,
+     AllocateMutableShared_Called_PlacesPayloadInHeap)
+{
+  bg::SmallObjectHeap heap;
+
+  {
+    auto pointer = bg::allocateMutableShared<int>(heap, 42);
+    ASSERT_EQ(42, *pointer);
+    ASSERT_EQ(1u, heap.slabCount());
+  }
+
+  ASSERT_EQ(1u, heap.slabCount());
+}
+
+TEST(small_object_heap,
+     StdAllocator_Vector_GrowsThroughHeap)
+{
+  bg::SmallObjectHeap heap;
+  std::vector<int, bg::StdAllocator<int>> values{bg::StdAllocator<int>(heap)};
+
+  for (int i = 0; i < 200; i++)
+  {
+    values.push_back(i);
+  }
+
+  ASSERT_EQ(199, values.back());
+}
+
+TEST(small_object_heap,
+     Allocate_ThreadSafeHeapSharedByThreads_KeepsContentsApart)
+{
+  bg::SmallObjectHeap heap(true);
+  std::vector<std::thread> threads;
+  std::vector<int> intact(4, 1);
+
+  for (int t = 0; t < 4; t++)
+  {
+    threads.emplace_back([&heap, &intact, t]() {
+      std::vector<unsigned char *> blocks;
+      for (int round = 0; round < 50; round++)
+      {
+        for (int i = 0; i < 100; i++)
+        {
+          auto pointer = static_cast<unsigned char *>(heap.allocate(48, 8));
+          memset(pointer, t, 48);
+          blocks.push_back(pointer);
+        }
+        for (auto pointer : blocks)
+        {
+          intact[t] = intact[t] && pointer[0] == t && pointer[47] == t;
+          heap.deallocate(pointer, 48, 8);
+        }
+        blocks.clear();
+      }
+    });
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+
+  for (int t = 0; t < 4; t++)
+  {
+    ASSERT_TRUE(intact[t]);
+  }
+}
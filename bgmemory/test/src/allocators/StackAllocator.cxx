@@ -0,0 +1,130 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/StackAllocator.hxx"
+#include "../TestAllocators.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <stdint.h>
+
+//---------------------
+//  Allocate
+//---------------------
+
+TEST(stack_allocator,
+     Allocate_Called_ReturnsAlignedMemory)
+{
+  bg::StackAllocator stack(1024);
+
+  stack.allocate(3, 1);
+  auto pointer = stack.allocate(8, 32);
+
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(pointer) % 32);
+  ASSERT_TRUE(stack.owns(pointer));
+}
+
+TEST(stack_allocator,
+     Allocate_CalledWithNaturalAlignment_StoresNoHeader)
+{
+  bg::StackAllocator stack(1024);
+
+  auto first = static_cast<unsigned char *>(stack.allocate(16, 8));
+  auto second = static_cast<unsigned char *>(stack.allocate(16, 8));
+
+  ASSERT_EQ(first + 16, second);
+  ASSERT_EQ(32u, stack.used());
+}
+
+TEST(stack_allocator,
+     Allocate_CalledPastCapacity_ReturnsNullPtr)
+{
+  bg::StackAllocator stack(64);
+
+  ASSERT_NE(nullptr, stack.allocate(64, 1));
+  ASSERT_EQ(nullptr, stack.allocate(1, 1));
+}
+
+//---------------------
+//  Deallocate
+//---------------------
+
+TEST(stack_allocator,
+     Deallocate_CalledInReverseOrder_ReclaimsPaddingToo)
+{
+  bg::StackAllocator stack(1024);
+  auto first = stack.allocate(3, 1);
+  auto second = stack.allocate(8, 64);
+
+  stack.deallocate(second, 8, 64);
+  stack.deallocate(first, 3, 1);
+
+  ASSERT_EQ(0u, stack.used());
+}
+
+TEST(stack_allocator,
+     Deallocate_CalledOnTop_ReusesTheMemory)
+{
+  bg::StackAllocator stack(1024);
+  stack.allocate(16, 8);
+  auto top = stack.allocate(16, 8);
+
+  stack.deallocate(top, 16, 8);
+
+  ASSERT_EQ(top, stack.allocate(16, 8));
+}
+
+TEST(stack_allocator,
+     Deallocate_CalledWithNullPtr_DoesNothing)
+{
+  bg::StackAllocator stack(1024);
+  stack.allocate(16, 8);
+
+  stack.deallocate(nullptr, 16, 8);
+
+  ASSERT_EQ(16u, stack.used());
+}
+
+//---------------------
+//  Markers / Reset
+//---------------------
+
+TEST(stack_allocator,
+     Rollback_CalledWithNestedMarkers_PopsEachScope)
+{
+  bg::StackAllocator stack(1024);
+  auto outer = stack.getMarker();
+  stack.allocate(100, 8);
+  auto inner = stack.getMarker();
+  stack.allocate(100, 8);
+
+  stack.rollback(inner);
+  ASSERT_EQ(inner, stack.used());
+
+  stack.rollback(outer);
+  ASSERT_EQ(0u, stack.used());
+}
+
+TEST(stack_allocator,
+     Reset_Called_PopsEverything)
+{
+  bg::StackAllocator stack(1024);
+  stack.allocate(100, 8);
+
+  stack.reset();
+
+  ASSERT_EQ(0u, stack.used());
+}
+
+TEST(stack_allocator,
+     Constructor_CalledWithAllocator_AllocatesBlockOnceFromIt)
+{
+  CountingTestAllocator allocator;
+
+  {
+    bg::StackAllocator stack(4096, allocator);
+    stack.deallocate(stack.allocate(16, 16), 16, 16);
+
+    ASSERT_EQ(1, allocator.getAllocateCount());
+  }
+
+  ASSERT_EQ(1, allocator.getDeallocateCount());
+}
@@ -0,0 +1,62 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/StdAllocator.hxx"
+#include "../TestAllocators.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <map>
+#include <vector>
+
+TEST(std_allocator,
+     Vector_PushedBack_AllocatesFromUnderlyingAllocator)
+{
+  CountingTestAllocator allocator;
+
+  {
+    std::vector<int, bg::StdAllocator<int>> values{bg::StdAllocator<int>(allocator)};
+    for (int i = 0; i < 100; i++)
+    {
+      values.push_back(i);
+    }
+
+    ASSERT_LT(0, allocator.getAllocateCount());
+  }
+
+  ASSERT_EQ(allocator.getAllocateCount(), allocator.getDeallocateCount());
+  ASSERT_EQ(0u, allocator.getLiveBytes());
+}
+
+TEST(std_allocator,
+     Map_Inserted_ReboundAllocatorDrawsFromUnderlyingAllocator)
+{
+  CountingTestAllocator allocator;
+  using MapAllocator = bg::StdAllocator<std::pair<const int, int>>;
+
+  std::map<int, int, std::less<int>, MapAllocator> values{MapAllocator(allocator)};
+  values[1] = 2;
+  values[3] = 4;
+
+  ASSERT_LE(2, allocator.getAllocateCount());
+}
+
+TEST(std_allocator,
+     Equality_ComparedWithSameAllocator_ReturnsTrue)
+{
+  CountingTestAllocator allocator;
+  CountingTestAllocator otherAllocator;
+
+  bg::StdAllocator<int> first(allocator);
+  bg::StdAllocator<double> second(allocator);
+  bg::StdAllocator<int> third(otherAllocator);
+
+  ASSERT_TRUE(first == second);
+  ASSERT_TRUE(first != third);
+}
+
+TEST(std_allocator,
+     DefaultConstructor_Called_UsesDefaultAllocator)
+{
+  bg::StdAllocator<int> allocator;
+
+  ASSERT_EQ(&bg::defaultAllocator(), &allocator.getAllocator());
+}
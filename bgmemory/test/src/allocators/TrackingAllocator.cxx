@@ -0,0 +1,79 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/TrackingAllocator.hxx"
+#include "bgmemory/allocators/LinearArena.hxx"
+#include "bgmemory/allocators/StdAllocator.hxx"
+#include "../TestAllocators.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <vector>
+
+//---------------------
+//  Allocate
+//---------------------
+
+TEST(tracking_allocator,
+     Allocate_Called_RecordsInTracker)
+{
+  bg::MemoryTracker tracker("tracking");
+  bg::TrackingAllocator allocator(bg::defaultAllocator(), tracker);
+
+  auto pointer = allocator.allocate(64, 16);
+
+  ASSERT_NE(nullptr, pointer);
+  ASSERT_EQ(64u, tracker.getStats().liveBytes);
+  allocator.deallocate(pointer, 64, 16);
+  ASSERT_EQ(0u, tracker.getStats().liveBytes);
+  ASSERT_EQ(1u, tracker.getStats().freeCount);
+}
+
+TEST(tracking_allocator,
+     Allocate_BackingFails_RecordsNothing)
+{
+  bg::MemoryTracker tracker("tracking");
+  bg::LinearArena arena(32);
+  bg::TrackingAllocator allocator(arena, tracker);
+
+  ASSERT_EQ(nullptr, allocator.allocate(64, 8));
+
+  ASSERT_EQ(0u, tracker.getStats().allocationCount);
+}
+
+TEST(tracking_allocator,
+     Allocate_TwoAllocatorsShareTracker_ReportsCombinedUsage)
+{
+  bg::MemoryTracker subsystem("subsystem");
+  bg::LinearArena arena(1024);
+  bg::TrackingAllocator first(arena, subsystem);
+  bg::TrackingAllocator second(bg::defaultAllocator(), subsystem);
+
+  first.allocate(100, 8);
+  auto pointer = second.allocate(200, 8);
+
+  ASSERT_EQ(300u, subsystem.getStats().liveBytes);
+  second.deallocate(pointer, 200, 8);
+}
+
+//---------------------
+//  Integration
+//---------------------
+
+TEST(tracking_allocator,
+     StdAllocator_Vector_PeakCoversGrowth)
+{
+  bg::MemoryTracker tracker("vector");
+  bg::TrackingAllocator allocator(bg::defaultAllocator(), tracker);
+
+  {
+    std::vector<int, bg::StdAllocator<int>> values{bg::StdAllocator<int>(allocator)};
+    for (int i = 0; i < 100; i++)
+    {
+      values.push_back(i);
+    }
+  }
+
+  auto stats = tracker.getStats();
+  ASSERT_EQ(0u, stats.liveBytes);
+  ASSERT_GE(stats.peakBytes, 100 * sizeof(int));
+  ASSERT_EQ(stats.allocationCount, stats.freeCount);
+}
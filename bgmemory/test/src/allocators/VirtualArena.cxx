@@ -0,0 +1,164 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/allocators/VirtualArena.hxx"
+#include "bgmemory/memoryfunctions.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+  const size_t reserveSize = 64 * 1024 * 1024;
+  const size_t granule = 64 * 1024;
+} // namespace
+
+//---------------------
+//  Constructor
+//---------------------
+
+TEST(virtual_arena,
+     Constructor_Called_CommitsNothing)
+{
+  bg::VirtualArena arena(reserveSize, granule);
+
+  ASSERT_EQ(reserveSize, arena.capacity());
+  ASSERT_EQ(0u, arena.committed());
+  ASSERT_EQ(0u, arena.used());
+}
+
+TEST(virtual_arena,
+     Constructor_ZeroReserve_AllocateReturnsNullPtr)
+{
+  bg::VirtualArena arena(0);
+
+  ASSERT_EQ(nullptr, arena.allocate(1, 1));
+}
+
+//---------------------
+//  Allocate
+//---------------------
+
+TEST(virtual_arena,
+     Allocate_Called_ReturnsAlignedWritableMemory)
+{
+  bg::VirtualArena arena(reserveSize, granule);
+
+  arena.allocate(1, 1);
+  auto pointer = static_cast<unsigned char *>(arena.allocate(256, 64));
+
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(pointer) % 64);
+  ASSERT_TRUE(arena.owns(pointer));
+  memset(pointer, 0xAB, 256);
+  ASSERT_EQ(0xAB, pointer[255]);
+}
+
+TEST(virtual_arena,
+     Allocate_Called_CommitsWholeGranules)
+{
+  bg::VirtualArena arena(reserveSize, granule);
+
+  arena.allocate(granule + 1, 1);
+
+  ASSERT_EQ(2 * granule, arena.committed());
+}
+
+TEST(virtual_arena,
+     Allocate_PastCommittedMemory_GrowsInPlace)
+{
+  bg::VirtualArena arena(reserveSize, granule);
+  std::vector<unsigned char *> blocks;
+
+  for (int i = 0; i < 100; i++)
+  {
+    auto block = static_cast<unsigned char *>(arena.allocate(10000, 8));
+    ASSERT_NE(nullptr, block);
+    memset(block, i, 10000);
+    blocks.push_back(block);
+  }
+
+  for (int i = 0; i < 100; i++)
+  {
+    ASSERT_EQ(static_cast<unsigned char *>(arena.data()) + i * 10000, blocks[i]);
+    ASSERT_EQ(i, blocks[i][9999]);
+  }
+}
+
+TEST(virtual_arena,
+     Allocate_PastReservation_ReturnsNullPtr)
+{
+  bg::VirtualArena arena(granule, granule);
+
+  ASSERT_NE(nullptr, arena.allocate(granule - 8, 1));
+  ASSERT_EQ(nullptr, arena.allocate(16, 1));
+  ASSERT_EQ(granule - 8, arena.used());
+}
+
+//---------------------
+//  Markers / Reset
+//---------------------
+
+TEST(virtual_arena,
+     Rollback_CalledWithMarker_KeepsMemoryCommitted)
+{
+  bg::VirtualArena arena(reserveSize, granule);
+  arena.allocate(32, 8);
+  auto marker = arena.getMarker();
+  auto first = arena.allocate(4 * granule, 8);
+
+  arena.rollback(marker);
+
+  ASSERT_EQ(32u, arena.used());
+  ASSERT_EQ(5 * granule, arena.committed());
+  ASSERT_EQ(first, arena.allocate(100, 8));
+}
+
+TEST(virtual_arena,
+     Reset_Called_FreesEverything)
+{
+  bg::VirtualArena arena(reserveSize, granule);
+  auto first = arena.allocate(100, 8);
+  arena.allocate(100, 8);
+
+  arena.reset();
+
+  ASSERT_EQ(0u, arena.used());
+  ASSERT_EQ(first, arena.allocate(100, 8));
+}
+
+//---------------------
+//  Trim
+//---------------------
+
+TEST(virtual_arena,
+     Trim_AfterRollback_DecommitsUnusedGranules)
+{
+  bg::VirtualArena arena(reserveSize, granule);
+  arena.allocate(100, 8);
+  auto marker = arena.getMarker();
+  arena.allocate(8 * granule, 8);
+  arena.rollback(marker);
+
+  arena.trim();
+
+  ASSERT_EQ(granule, arena.committed());
+}
+
+TEST(virtual_arena,
+     Trim_ThenAllocate_RecommitsZeroedMemory)
+{
+  bg::VirtualArena arena(reserveSize, granule);
+  auto block = static_cast<unsigned char *>(arena.allocate(4 * granule, 8));
+  memset(block, 0xAB, 4 * granule);
+  arena.reset();
+  arena.trim();
+
+  auto again = static_cast<unsigned char *>(arena.allocate(4 * granule, 8));
+
+  ASSERT_EQ(block, again);
+  ASSERT_EQ(4 * granule, arena.committed());
+#ifndef BG_MEMORY_DEBUG
+  ASSERT_EQ(0, again[3 * granule]);
+#endif // BG_MEMORY_DEBUG
+}
@@ -0,0 +1,256 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/debug/MemoryDebug.hxx"
+#include "bgmemory/bulletpool.hxx"
+#include "bgmemory/allocators/LinearArena.hxx"
+#include "bgmemory/allocators/StackAllocator.hxx"
+#include "bgmemory/allocators/DoubleEndedStackAllocator.hxx"
+#include "bgmemory/pointers/MutableSharedPtr.hxx"
+#include "bgmemory/pointers/SharedPtrMutator.hxx"
+#include "bgmemory/pools/CompactingHeap.hxx"
+#include "bgmemory/pools/GrowablePool.hxx"
+#include "bgmemory/pools/PersistentPool.hxx"
+#include "../TestAllocators.hxx"
+#include "../pointers/TestHelpers.hxx"
+#include "./MemoryErrorRecorder.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+using bg::MemoryError;
+using ::testing::ElementsAre;
+
+//---------------------
+//  Poison
+//---------------------
+
+TEST(memory_debug,
+     IsPoisoned_AfterPoisonMemory_ReturnsTrue)
+{
+  unsigned char bytes[16];
+
+  bg::poisonMemory(bytes, sizeof(bytes), bg::freedFill);
+
+  ASSERT_TRUE(bg::isPoisoned(bytes, sizeof(bytes), bg::freedFill));
+  bytes[15] = 0;
+  ASSERT_FALSE(bg::isPoisoned(bytes, sizeof(bytes), bg::freedFill));
+}
+
+//---------------------
+//  Reporting
+//---------------------
+
+TEST(memory_debug,
+     ReportMemoryError_HandlerInstalled_CallsHandler)
+{
+  MemoryErrorRecorder recorder;
+
+  bg::reportMemoryError(MemoryError::Leak, nullptr, "test");
+
+  ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::Leak));
+}
+
+TEST(memory_debug,
+     MemoryErrorName_Called_ReturnsReadableName)
+{
+  ASSERT_STREQ("use after mutate", bg::memoryErrorName(MemoryError::UseAfterMutate));
+}
+
+//---------------------
+//  AllocationSite
+//---------------------
+
+TEST(memory_debug,
+     AllocationSite_Nested_InnermostIsCurrent)
+{
+  ASSERT_EQ(nullptr, bg::AllocationSite::current());
+  {
+    bg::AllocationSite outer("outer", 1);
+    {
+      bg::AllocationSite inner("inner", 2);
+      ASSERT_EQ(2, bg::AllocationSite::current()->line());
+    }
+    ASSERT_STREQ("outer", bg::AllocationSite::current()->file());
+  }
+  ASSERT_EQ(nullptr, bg::AllocationSite::current());
+}
+
+#ifdef BG_MEMORY_DEBUG
+
+//---------------------
+//  BulletPool
+//---------------------
+
+TEST(memory_debug,
+     BulletPool_ReleasedTwice_ReportsDoubleFree)
+{
+  MemoryErrorRecorder recorder;
+  bg::BulletPool<double> pool(4);
+  auto object = pool.acquire(1.0);
+
+  pool.release(object);
+  pool.release(object);
+
+  ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::DoubleFree));
+  ASSERT_EQ(0u, pool.liveCount());
+}
+
+TEST(memory_debug,
+     BulletPool_ReleasedSlotWrittenTo_ReportsUseAfterFreeOnReuse)
+{
+  MemoryErrorRecorder recorder;
+  bg::BulletPool<double> pool(4);
+  auto object = pool.acquire(1.0);
+  pool.release(object);
+
+  reinterpret_cast<unsigned char *>(object)[7] = 0;
+  pool.acquire(2.0);
+
+  ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::UseAfterFree));
+}
+
+//---------------------
+//  Arenas
+//---------------------
+
+TEST(memory_debug,
+     LinearArena_Reset_PoisonsUsedMemory)
+{
+  bg::LinearArena arena(64);
+  auto pointer = arena.allocate(32, 8);
+  ASSERT_TRUE(bg::isPoisoned(pointer, 32, bg::allocatedFill));
+
+  arena.reset();
+
+  ASSERT_TRUE(bg::isPoisoned(pointer, 32, bg::freedFill));
+}
+
+TEST(memory_debug,
+     StackAllocator_PoppedBlockDeallocated_ReportsDoubleFree)
+{
+  MemoryErrorRecorder recorder;
+  bg::StackAllocator stack(128);
+  auto first = stack.allocate(16, 8);
+  auto second = stack.allocate(16, 8);
+
+  stack.deallocate(first, 16, 8);
+  stack.deallocate(second, 16, 8);
+
+  ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::DoubleFree));
+  ASSERT_TRUE(bg::isPoisoned(second, 16, bg::freedFill));
+  ASSERT_EQ(0u, stack.used());
+}
+
+TEST(memory_debug,
+     DoubleEndedStackAllocator_UpperBlockDeallocatedTwice_ReportsDoubleFree)
+{
+  MemoryErrorRecorder recorder;
+  bg::DoubleEndedStackAllocator stack(128);
+  auto pointer = stack.upper().allocate(16, 8);
+
+  stack.upper().deallocate(pointer, 16, 8);
+  stack.upper().deallocate(pointer, 16, 8);
+
+  ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::DoubleFree));
+  ASSERT_EQ(0u, stack.upper().used());
+}
+
+//---------------------
+//  Pointers
+//---------------------
+
+TEST(memory_debug,
+     InplaceObject_WrittenAfterMutate_ReportsUseAfterMutate)
+{
+  MemoryErrorRecorder recorder;
+  {
+    auto pointer = bg::makeMutableShared<long>(1);
+    long *stale = pointer.get();
+    bg::SharedPtrMutator<long> mutator(pointer);
+    mutator.mutate(new long(2));
+    settleRetiredObjects();
+
+    ASSERT_TRUE(bg::isPoisoned(stale, sizeof(long), bg::freedFill));
+    *stale = 3;
+  }
+
+  ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::UseAfterMutate));
+}
+
+TEST(memory_debug,
+     InplaceObject_Released_ReportsNothing)
+{
+  MemoryErrorRecorder recorder;
+
+  {
+    auto pointer = bg::makeMutableShared<long>(1);
+  }
+
+  ASSERT_TRUE(recorder.errors().empty());
+}
+
+//---------------------
+//  CompactingHeap
+//---------------------
+
+TEST(memory_debug,
+     CompactingHeap_ReleasedSlotWrittenTo_ReportsUseAfterFreeOnReuse)
+{
+  MemoryErrorRecorder recorder;
+  bg::CompactingHeap<long> heap(4);
+  long *stale;
+  {
+    auto handle = heap.make(1);
+    stale = handle.get();
+  }
+
+  *stale = 5;
+  auto handle = heap.make(2);
+
+  ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::UseAfterFree));
+}
+
+//---------------------
+//  PersistentPool
+//---------------------
+
+TEST(memory_debug,
+     PersistentPool_ReleasedTwice_ReportsDoubleFree)
+{
+  const std::string path = testing::TempDir() + "memory_debug_persistent_pool.bin";
+  remove(path.c_str());
+  {
+    MemoryErrorRecorder recorder;
+    bg::PersistentPool<double> pool(path, 4);
+    auto handle = pool.acquire(1.0);
+
+    pool.release(handle);
+    pool.release(handle);
+
+    ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::DoubleFree));
+    ASSERT_EQ(0u, pool.liveCount());
+  }
+  remove(path.c_str());
+}
+
+//---------------------
+//  GrowablePool
+//---------------------
+
+TEST(memory_debug,
+     GrowablePool_ReleasedTwice_ReportsDoubleFree)
+{
+  MemoryErrorRecorder recorder;
+  bg::GrowablePool<double> pool(1000);
+  auto object = pool.acquire(1.0);
+
+  pool.release(object);
+  pool.release(object);
+
+  ASSERT_THAT(recorder.errors(), ElementsAre(MemoryError::DoubleFree));
+  ASSERT_EQ(0u, pool.liveCount());
+}
+
+#endif // BG_MEMORY_DEBUG
@@ -0,0 +1,46 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#ifndef TEST_DEBUG_MEMORYERRORRECORDER_HXX_
+#define TEST_DEBUG_MEMORYERRORRECORDER_HXX_
+
+#include <vector>
+
+#include "bgmemory/debug/MemoryDebug.hxx"
+
+/*
+  Replaces the memory error handler for its lifetime, recording errors
+  instead of breaking into the debugger.
+*/
+class MemoryErrorRecorder
+{
+  bg::MemoryErrorHandler previous;
+
+  static std::vector<bg::MemoryError> &recorded()
+  {
+    static std::vector<bg::MemoryError> errors;
+    return errors;
+  }
+
+  static void record(bg::MemoryError error, const void *, const char *)
+  {
+    recorded().push_back(error);
+  }
+
+public:
+  MemoryErrorRecorder()
+  {
+    recorded().clear();
+    previous = bg::setMemoryErrorHandler(&MemoryErrorRecorder::record);
+  }
+
+  ~MemoryErrorRecorder()
+  {
+    bg::setMemoryErrorHandler(previous);
+  }
+
+  const std::vector<bg::MemoryError> &errors() const
+  {
+    return recorded();
+  }
+};
+
+#endif // TEST_DEBUG_MEMORYERRORRECORDER_HXX_
@@ -0,0 +1,150 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/instrumentation/MemoryTracker.hxx"
+#include "bgmemory/pointers/MutableSharedPtr.hxx"
+#include "../TestAllocators.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+namespace
+{
+  bool isRegistered(const std::string &name)
+  {
+    auto snapshot = bg::snapshotMemory();
+    return std::any_of(snapshot.begin(), snapshot.end(),
+                       [&name](const bg::TrackerSnapshot &entry) { return entry.name == name; });
+  }
+} // namespace
+
+//---------------------
+//  RecordAllocation
+//---------------------
+
+TEST(memory_tracker,
+     RecordAllocation_Called_CountsLiveAndPeakBytes)
+{
+  bg::MemoryTracker tracker("test");
+
+  tracker.recordAllocation(100);
+  tracker.recordAllocation(50);
+  tracker.recordFree(100);
+
+  auto stats = tracker.getStats();
+  ASSERT_EQ(50u, stats.liveBytes);
+  ASSERT_EQ(150u, stats.peakBytes);
+  ASSERT_EQ(2u, stats.allocationCount);
+  ASSERT_EQ(1u, stats.freeCount);
+}
+
+TEST(memory_tracker,
+     RecordAllocation_Called_FillsPowerOfTwoHistogram)
+{
+  bg::MemoryTracker tracker("test");
+
+  tracker.recordAllocation(1);
+  tracker.recordAllocation(16);
+  tracker.recordAllocation(17);
+  tracker.recordAllocation(1 << 20);
+
+  auto stats = tracker.getStats();
+  ASSERT_EQ(1u, stats.histogram[0]);
+  ASSERT_EQ(1u, stats.histogram[4]);
+  ASSERT_EQ(1u, stats.histogram[5]);
+  ASSERT_EQ(1u, stats.histogram[bg::AllocationStats::histogramBuckets - 1]);
+}
+
+//---------------------
+//  Reset
+//---------------------
+
+TEST(memory_tracker,
+     Reset_Called_KeepsLiveBytesAndRestartsPeak)
+{
+  bg::MemoryTracker tracker("test");
+  tracker.recordAllocation(100);
+  tracker.recordAllocation(50);
+  tracker.recordFree(100);
+
+  tracker.reset();
+
+  auto stats = tracker.getStats();
+  ASSERT_EQ(50u, stats.liveBytes);
+  ASSERT_EQ(50u, stats.peakBytes);
+  ASSERT_EQ(0u, stats.allocationCount);
+  ASSERT_EQ(0u, stats.histogram[7]);
+}
+
+//---------------------
+//  Snapshot
+//---------------------
+
+TEST(memory_tracker,
+     SnapshotMemory_TrackerAlive_ListsIt)
+{
+  {
+    bg::MemoryTracker tracker("snapshot.alive");
+    tracker.recordAllocation(8);
+
+    auto snapshot = bg::snapshotMemory();
+    auto entry = std::find_if(snapshot.begin(), snapshot.end(),
+                              [](const bg::TrackerSnapshot &e) { return e.name == "snapshot.alive"; });
+    ASSERT_NE(snapshot.end(), entry);
+    ASSERT_EQ(8u, entry->stats.liveBytes);
+  }
+
+  ASSERT_FALSE(isRegistered("snapshot.alive"));
+}
+
+TEST(memory_tracker,
+     DumpMemoryReport_Called_WritesCountersAndHistogram)
+{
+  bg::MemoryTracker tracker("dump.test");
+  tracker.recordAllocation(24);
+  std::ostringstream out;
+
+  bg::dumpMemoryReport(out);
+
+  auto report = out.str();
+  ASSERT_NE(std::string::npos, report.find("dump.test"));
+  ASSERT_NE(std::string::npos, report.find("live bytes  24"));
+  ASSERT_NE(std::string::npos, report.find("<=      32 bytes  1"));
+}
+
+//---------------------
+//  Library hooks
+//---------------------
+
+TEST(memory_tracker,
+     PayloadTracker_SharedPtrCreatedAndReleased_RecordsPayload)
+{
+  auto before = bg::inner::payloadTracker().getStats();
+
+  {
+    bg::MutableSharedPtr<int> pointer(new int(1));
+    auto during = bg::inner::payloadTracker().getStats();
+    ASSERT_EQ(before.allocationCount + 1, during.allocationCount);
+    ASSERT_GT(during.liveBytes, before.liveBytes);
+  }
+
+  auto after = bg::inner::payloadTracker().getStats();
+  ASSERT_EQ(before.liveBytes, after.liveBytes);
+  ASSERT_EQ(before.freeCount + 1, after.freeCount);
+}
+
+TEST(memory_tracker,
+     InplaceTracker_MakeMutableShared_RecordsPayloadAndObject)
+{
+  auto before = bg::inner::inplaceTracker().getStats();
+
+  {
+    auto pointer = bg::makeMutableShared<double>(1.0);
+    auto during = bg::inner::inplaceTracker().getStats();
+    ASSERT_GE(during.liveBytes - before.liveBytes, sizeof(double));
+  }
+
+  ASSERT_EQ(before.liveBytes, bg::inner::inplaceTracker().getStats().liveBytes);
+  ASSERT_TRUE(isRegistered("bg.inplace"));
+}
@@ -0,0 +1,206 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pointers/IntrusiveMutablePtr.hxx"
+#include "./TestHelpers.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <utility>
+
+//---------------------
+//  Constructor
+//---------------------
+
+TEST(intrusive_mutable_ptr,
+     DefaultConstructor_Called_IsEmpty)
+{
+  bg::IntrusiveMutablePtr<IntrusiveTestObject> p;
+
+  ASSERT_FALSE(static_cast<bool>(p));
+  ASSERT_EQ(nullptr, p.get());
+  ASSERT_EQ(0, p.useCount());
+}
+
+TEST(intrusive_mutable_ptr,
+     Constructor_CalledWithObject_TakesOneReference)
+{
+  auto object = new IntrusiveTestObject(1);
+  bg::IntrusiveMutablePtr<IntrusiveTestObject> p(object);
+
+  ASSERT_EQ(object, p.get());
+  ASSERT_EQ(1, p.useCount());
+}
+
+TEST(intrusive_mutable_ptr,
+     Size_Always_IsOnePointer)
+{
+  ASSERT_EQ(sizeof(void *), sizeof(bg::IntrusiveMutablePtr<IntrusiveTestObject>));
+}
+
+TEST(intrusive_mutable_ptr,
+     Constructor_SameObjectTwice_SharesTheCount)
+{
+  IntrusiveTestObject::reset();
+  auto object = new IntrusiveTestObject(1);
+  {
+    bg::IntrusiveMutablePtr<IntrusiveTestObject> first(object);
+    {
+      bg::IntrusiveMutablePtr<IntrusiveTestObject> second(object);
+      ASSERT_EQ(2, first.useCount());
+    }
+    ASSERT_EQ(1, IntrusiveTestObject::getLiveObjectCount());
+  }
+
+  ASSERT_EQ(0, IntrusiveTestObject::getLiveObjectCount());
+}
+
+TEST(intrusive_mutable_ptr,
+     MakeIntrusiveMutable_Called_ConstructsObject)
+{
+  auto p = bg::makeIntrusiveMutable<IntrusiveTestObject>(5);
+
+  ASSERT_EQ(5, p->GetValue());
+  ASSERT_EQ(1, p.useCount());
+}
+
+//---------------------
+//  Copy / Move
+//---------------------
+
+TEST(intrusive_mutable_ptr,
+     CopyConstructor_Called_IncrementsCount)
+{
+  auto p = bg::makeIntrusiveMutable<IntrusiveTestObject>(1);
+  auto copy = p;
+
+  ASSERT_EQ(p.get(), copy.get());
+  ASSERT_EQ(2, p.useCount());
+}
+
+TEST(intrusive_mutable_ptr,
+     MoveConstructor_Called_PerformsNoReferenceOperations)
+{
+  auto p = bg::makeIntrusiveMutable<IntrusiveTestObject>(1);
+  const long before = bg::inner::referenceOperationCount();
+
+  bg::IntrusiveMutablePtr<IntrusiveTestObject> moved(std::move(p));
+
+  ASSERT_EQ(before, bg::inner::referenceOperationCount());
+  ASSERT_FALSE(static_cast<bool>(p));
+  ASSERT_EQ(1, moved.useCount());
+}
+
+TEST(intrusive_mutable_ptr,
+     CopyAssignment_Called_ReleasesPreviousObject)
+{
+  IntrusiveTestObject::reset();
+  auto first = bg::makeIntrusiveMutable<IntrusiveTestObject>(1);
+  auto second = bg::makeIntrusiveMutable<IntrusiveTestObject>(2);
+
+  first = second;
+
+  ASSERT_EQ(1, IntrusiveTestObject::getLiveObjectCount());
+  ASSERT_EQ(2, first->GetValue());
+  ASSERT_EQ(2, second.useCount());
+}
+
+TEST(intrusive_mutable_ptr,
+     Destructor_LastPointer_DeletesObject)
+{
+  IntrusiveTestObject::reset();
+  {
+    auto p = bg::makeIntrusiveMutable<IntrusiveTestObject>(1);
+    auto copy = p;
+  }
+
+  ASSERT_EQ(0, IntrusiveTestObject::getLiveObjectCount());
+}
+
+TEST(intrusive_mutable_ptr,
+     ObjectCopy_Called_StartsUnreferenced)
+{
+  IntrusiveTestObject::reset();
+  auto p = bg::makeIntrusiveMutable<IntrusiveTestObject>(3);
+
+  bg::IntrusiveMutablePtr<IntrusiveTestObject> copy(new IntrusiveTestObject(*p));
+
+  ASSERT_EQ(1, p.useCount());
+  ASSERT_EQ(1, copy.useCount());
+  ASSERT_EQ(3, copy->GetValue());
+}
+
+//---------------------
+//  Reset
+//---------------------
+
+TEST(intrusive_mutable_ptr,
+     Reset_CalledOnEmptyPointer_TakesObject)
+{
+  bg::IntrusiveMutablePtr<IntrusiveTestObject> p;
+
+  p.reset(new IntrusiveTestObject(4));
+
+  ASSERT_EQ(4, p->GetValue());
+  ASSERT_EQ(1, p.useCount());
+}
+
+TEST(intrusive_mutable_ptr,
+     Reset_Called_ChangesEveryCopy)
+{
+  auto p = bg::makeIntrusiveMutable<IntrusiveTestObject>(1);
+  auto copy = p;
+
+  p.reset(new IntrusiveTestObject(2));
+
+  ASSERT_EQ(2, p->GetValue());
+  ASSERT_EQ(2, copy->GetValue());
+}
+
+TEST(intrusive_mutable_ptr,
+     Reset_CopiesNotYetMoved_KeepsReplacedObjectAlive)
+{
+  IntrusiveTestObject::reset();
+  auto p = bg::makeIntrusiveMutable<IntrusiveTestObject>(1);
+  auto copy = p;
+
+  p.reset(new IntrusiveTestObject(2));
+  ASSERT_EQ(2, IntrusiveTestObject::getLiveObjectCount());
+
+  ASSERT_EQ(2, (*copy).GetValue());
+  ASSERT_EQ(1, IntrusiveTestObject::getLiveObjectCount());
+  ASSERT_EQ(2, p.useCount());
+}
+
+TEST(intrusive_mutable_ptr,
+     Reset_ChainOfMutations_StalePointerFollowsToTheEnd)
+{
+  IntrusiveTestObject::reset();
+  auto p = bg::makeIntrusiveMutable<IntrusiveTestObject>(0);
+  auto stale = p;
+
+  for (int i = 1; i <= 10; i++)
+  {
+    p.reset(new IntrusiveTestObject(i));
+  }
+  // The stale pointer keeps the whole chain alive.
+  ASSERT_EQ(11, IntrusiveTestObject::getLiveObjectCount());
+
+  ASSERT_EQ(10, stale->GetValue());
+  ASSERT_EQ(1, IntrusiveTestObject::getLiveObjectCount());
+  ASSERT_EQ(stale.get(), p.get());
+}
+
+TEST(intrusive_mutable_ptr,
+     Destructor_StalePointersDropped_CleansUpWholeChain)
+{
+  IntrusiveTestObject::reset();
+  {
+    auto p = bg::makeIntrusiveMutable<IntrusiveTestObject>(0);
+    auto stale = p;
+    p.reset(new IntrusiveTestObject(1));
+    auto middle = p;
+    p.reset(new IntrusiveTestObject(2));
+    ASSERT_EQ(3, IntrusiveTestObject::getLiveObjectCount());
+  }
+
+  ASSERT_EQ(0, IntrusiveTestObject::getLiveObjectCount());
+}
@@ -0,0 +1,77 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pointers/IntrusiveMutablePtr.hxx"
+#include "bgmemory/pointers/IntrusivePtrMutator.hxx"
+#include "./TestHelpers.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+//---------------------
+//  Mutate
+//---------------------
+
+TEST(intrusive_ptr_mutator,
+     Mutate_Called_ChangesEveryPointer)
+{
+  auto p = bg::makeIntrusiveMutable<IntrusiveTestObject>(1);
+  auto copy = p;
+  bg::IntrusivePtrMutator<IntrusiveTestObject> mutator(p);
+
+  mutator.mutate(new IntrusiveTestObject(2));
+
+  ASSERT_EQ(2, p->GetValue());
+  ASSERT_EQ(2, copy->GetValue());
+}
+
+TEST(intrusive_ptr_mutator,
+     Mutate_EveryPointerMoved_DeletesReplacedObject)
+{
+  IntrusiveTestObject::reset();
+  auto p = bg::makeIntrusiveMutable<IntrusiveTestObject>(1);
+  bg::IntrusivePtrMutator<IntrusiveTestObject> mutator(p);
+
+  mutator.mutate(new IntrusiveTestObject(2));
+  p.get();
+
+  ASSERT_EQ(1, IntrusiveTestObject::getLiveObjectCount());
+}
+
+TEST(intrusive_ptr_mutator,
+     Mutate_CalledTwice_AppliesLatest)
+{
+  auto p = bg::makeIntrusiveMutable<IntrusiveTestObject>(1);
+  bg::IntrusivePtrMutator<IntrusiveTestObject> first(p);
+  bg::IntrusivePtrMutator<IntrusiveTestObject> second(p);
+
+  first.mutate(new IntrusiveTestObject(2));
+  second.mutate(new IntrusiveTestObject(3));
+
+  ASSERT_EQ(3, p->GetValue());
+}
+
+TEST(intrusive_ptr_mutator,
+     Mutate_CalledOnEmptyPointer_DeletesNewObject)
+{
+  IntrusiveTestObject::reset();
+  bg::IntrusiveMutablePtr<IntrusiveTestObject> p;
+  bg::IntrusivePtrMutator<IntrusiveTestObject> mutator(p);
+
+  mutator.mutate(new IntrusiveTestObject(1));
+
+  ASSERT_EQ(nullptr, p.get());
+  ASSERT_EQ(0, IntrusiveTestObject::getLiveObjectCount());
+}
+
+TEST(intrusive_ptr_mutator,
+     Constructor_Called_KeepsObjectAlive)
+{
+  IntrusiveTestObject::reset();
+  auto p = bg::makeIntrusiveMutable<IntrusiveTestObject>(1);
+  {
+    bg::IntrusivePtrMutator<IntrusiveTestObject> mutator(p);
+    p = nullptr;
+    ASSERT_EQ(1, IntrusiveTestObject::getLiveObjectCount());
+  }
+
+  ASSERT_EQ(0, IntrusiveTestObject::getLiveObjectCount());
+}
@@ -0,0 +1,401 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pointers/MutableSharedPtr.hxx"
+#include "bgmemory/pointers/MutableWeakPtr.hxx"
+#include "bgmemory/pointers/SharedPtrMutator.hxx"
+#include "bgmemory/pointers/IntrusiveMutablePtr.hxx"
+#include "bgmemory/pointers/IntrusivePtrMutator.hxx"
+#include "bgmemory/reclamation/EpochReclamation.hxx"
+#include "bgmemory/pools/CompactingHeap.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef BG_MEMORY_MULTITHREAD
+#error "MultithreadStress.cxx must be built with BG_MEMORY_MULTITHREAD"
+#endif // BG_MEMORY_MULTITHREAD
+
+namespace
+{
+  const int threadCount = 8;
+
+  // Object whose construction and destruction counts may be touched from any thread.
+  class AtomicTrackedObject
+  {
+  public:
+    static std::atomic<int> liveCount;
+    static std::atomic<int> destructCount;
+
+    int value = 42;
+
+    AtomicTrackedObject() { liveCount++; }
+    AtomicTrackedObject(const AtomicTrackedObject &other) : value(other.value) { liveCount++; }
+    ~AtomicTrackedObject()
+    {
+      value = 0;
+      liveCount--;
+      destructCount++;
+    }
+
+    static void reset()
+    {
+      liveCount = 0;
+      destructCount = 0;
+    }
+  };
+
+  std::atomic<int> AtomicTrackedObject::liveCount;
+  std::atomic<int> AtomicTrackedObject::destructCount;
+
+  class AtomicTrackedIntrusiveObject : public AtomicTrackedObject,
+                                       public bg::IntrusiveMutable<AtomicTrackedIntrusiveObject>
+  {
+  };
+
+  template <class F>
+  void runOnThreads(F f)
+  {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++)
+    {
+      threads.emplace_back(f, t);
+    }
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
+  }
+} // namespace
+
+TEST(multithread_stress,
+     SharedPtr_CopiedAndDestructedConcurrently_DeletesObjectOnce)
+{
+  AtomicTrackedObject::reset();
+
+  for (int round = 0; round < 50; round++)
+  {
+    auto source = bg::makeMutableShared<AtomicTrackedObject>();
+    runOnThreads([&source](int) {
+      for (int i = 0; i < 2000; i++)
+      {
+        auto copy = source;
+        ASSERT_EQ(42, copy->value);
+      }
+    });
+
+    ASSERT_EQ(1, source.useCount());
+  }
+
+  ASSERT_EQ(0, AtomicTrackedObject::liveCount.load());
+  ASSERT_EQ(50, AtomicTrackedObject::destructCount.load());
+}
+
+TEST(multithread_stress,
+     WeakPtr_LockRacingLastRelease_NeverResurrectsObject)
+{
+  AtomicTrackedObject::reset();
+  const int rounds = 2000;
+  std::atomic<int> lockedAlive(0);
+
+  for (int round = 0; round < rounds; round++)
+  {
+    auto owner = new bg::MutableSharedPtr<AtomicTrackedObject>(bg::makeMutableShared<AtomicTrackedObject>());
+    bg::MutableWeakPtr<AtomicTrackedObject> weak = *owner;
+    std::atomic<bool> go(false);
+
+    std::thread releaser([owner, &go]() {
+      while (!go.load())
+      {
+      }
+      delete owner;
+    });
+    std::thread locker([&weak, &go, &lockedAlive]() {
+      while (!go.load())
+      {
+      }
+      auto locked = weak.lock();
+      if (locked)
+      {
+        // A successful lock must always see a live object.
+        ASSERT_EQ(42, locked->value);
+        lockedAlive++;
+      }
+    });
+
+    go = true;
+    releaser.join();
+    locker.join();
+
+    ASSERT_TRUE(weak.expired());
+  }
+
+  ASSERT_EQ(0, AtomicTrackedObject::liveCount.load());
+  ASSERT_EQ(rounds, AtomicTrackedObject::destructCount.load());
+}
+
+TEST(multithread_stress,
+     WeakPtr_CopiedAndLockedConcurrently_KeepsCountsConsistent)
+{
+  AtomicTrackedObject::reset();
+
+  {
+    auto owner = bg::makeMutableShared<AtomicTrackedObject>();
+    bg::MutableWeakPtr<AtomicTrackedObject> weak = owner;
+
+    runOnThreads([&weak](int) {
+      for (int i = 0; i < 2000; i++)
+      {
+        bg::MutableWeakPtr<AtomicTrackedObject> copy = weak;
+        auto locked = copy.lock();
+        ASSERT_TRUE(locked);
+        bg::SharedPtrMutator<AtomicTrackedObject> mutator(locked);
+      }
+    });
+
+    ASSERT_EQ(1, owner.useCount());
+    ASSERT_EQ(1, AtomicTrackedObject::liveCount.load());
+  }
+
+  ASSERT_EQ(0, AtomicTrackedObject::liveCount.load());
+}
+
+TEST(multithread_stress,
+     SharedAndWeakPtr_DroppedFromDifferentThreads_FreesPayloadOnce)
+{
+  AtomicTrackedObject::reset();
+
+  for (int round = 0; round < 500; round++)
+  {
+    std::vector<std::unique_ptr<bg::MutableSharedPtr<AtomicTrackedObject>>> shared;
+    std::vector<bg::MutableWeakPtr<AtomicTrackedObject>> weak;
+    {
+      auto owner = bg::makeMutableShared<AtomicTrackedObject>();
+      for (int t = 0; t < threadCount; t++)
+      {
+        shared.emplace_back(new bg::MutableSharedPtr<AtomicTrackedObject>(owner));
+        weak.push_back(owner);
+      }
+    }
+
+    runOnThreads([&shared, &weak](int t) {
+      if (t % 2 == 0)
+      {
+        weak[t].reset();
+        shared[t].reset();
+      }
+      else
+      {
+        shared[t].reset();
+        weak[t].reset();
+      }
+    });
+  }
+
+  ASSERT_EQ(0, AtomicTrackedObject::liveCount.load());
+  ASSERT_EQ(500, AtomicTrackedObject::destructCount.load());
+}
+
+TEST(multithread_stress,
+     Mutate_RacingReaders_NeverExposesReclaimedObject)
+{
+  AtomicTrackedObject::reset();
+  const int mutations = 5000;
+
+  {
+    auto owner = bg::makeMutableShared<AtomicTrackedObject>();
+    std::atomic<bool> done(false);
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < threadCount - 1; t++)
+    {
+      readers.emplace_back([&owner, &done]() {
+        auto local = owner;
+        while (!done.load())
+        {
+          // The destructor zeroes value, so a reclaimed object reads as 0.
+          ASSERT_EQ(42, local->value);
+          {
+            bg::EpochGuard guard;
+            ASSERT_EQ(42, (*local).value);
+          }
+        }
+      });
+    }
+
+    std::thread writer([&owner, &done, mutations]() {
+      bg::SharedPtrMutator<AtomicTrackedObject> mutator(owner);
+      for (int i = 0; i < mutations; i++)
+      {
+        mutator.mutate(new AtomicTrackedObject());
+      }
+      done = true;
+    });
+
+    writer.join();
+    for (auto &reader : readers)
+    {
+      reader.join();
+    }
+    bg::synchronizeRetired();
+
+    ASSERT_EQ(1, AtomicTrackedObject::liveCount.load());
+  }
+
+  ASSERT_EQ(0, AtomicTrackedObject::liveCount.load());
+  ASSERT_EQ(mutations + 1, AtomicTrackedObject::destructCount.load());
+}
+
+TEST(multithread_stress,
+     Mutate_FromSeveralMutatorsConcurrently_CleansUpEveryObject)
+{
+  AtomicTrackedObject::reset();
+
+  {
+    auto owner = bg::makeMutableShared<AtomicTrackedObject>();
+    runOnThreads([&owner](int) {
+      bg::SharedPtrMutator<AtomicTrackedObject> mutator(owner);
+      for (int i = 0; i < 500; i++)
+      {
+        mutator.mutate(new AtomicTrackedObject());
+      }
+    });
+    bg::synchronizeRetired();
+
+    ASSERT_EQ(1, AtomicTrackedObject::liveCount.load());
+  }
+
+  ASSERT_EQ(0, AtomicTrackedObject::liveCount.load());
+}
+
+TEST(multithread_stress,
+     Defragment_RacingHandleTraffic_KeepsMovedValuesIntact)
+{
+  using Handle = bg::MutableSharedPtr<std::string>;
+  const int workers = threadCount - 1;
+
+  for (int round = 0; round < 20; round++)
+  {
+    bg::CompactingHeap<std::string> heap(256);
+    // Long strings, so moving one leaves the source empty.
+    std::vector<std::vector<std::pair<char, Handle>>> owned(workers);
+    {
+      std::vector<Handle> dropped;
+      for (int i = 0; i < 256; i++)
+      {
+        const char c = static_cast<char>('a' + i % 26);
+        auto handle = heap.make(64, c);
+        if (i % 2 == 0)
+        {
+          dropped.push_back(handle);
+        }
+        else
+        {
+          owned[i % workers].emplace_back(c, handle);
+        }
+      }
+    }
+
+    // Handles are copied and released while the heap is compacted, but
+    // the objects are only read once it is done.
+    std::atomic<bool> done(false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < workers; t++)
+    {
+      threads.emplace_back([&owned, &done, t]() {
+        auto &mine = owned[t];
+        size_t released = 0;
+        while (!done.load())
+        {
+          for (auto &entry : mine)
+          {
+            Handle copy = entry.second;
+            bg::MutableWeakPtr<std::string> weak(copy);
+          }
+          if (released < mine.size() / 2)
+          {
+            mine[released++].second = nullptr;
+          }
+        }
+      });
+    }
+
+    heap.defragment();
+    done = true;
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
+
+    for (auto &mine : owned)
+    {
+      for (auto &entry : mine)
+      {
+        if (entry.second.get() != nullptr)
+        {
+          ASSERT_EQ(std::string(64, entry.first), *entry.second);
+        }
+      }
+    }
+  }
+}
+
+TEST(multithread_stress,
+     IntrusiveMutate_RacingReaders_NeverExposesDeletedObject)
+{
+  AtomicTrackedObject::reset();
+  const int mutations = 5000;
+
+  {
+    auto owner = bg::makeIntrusiveMutable<AtomicTrackedIntrusiveObject>();
+    std::atomic<bool> done(false);
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < threadCount - 2; t++)
+    {
+      readers.emplace_back([&owner, &done]() {
+        while (!done.load())
+        {
+          auto local = owner;
+          for (int i = 0; i < 100; i++)
+          {
+            ASSERT_EQ(42, local->value);
+          }
+        }
+      });
+    }
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 2; t++)
+    {
+      writers.emplace_back([&owner, mutations]() {
+        auto local = owner;
+        bg::IntrusivePtrMutator<AtomicTrackedIntrusiveObject> mutator(local);
+        for (int i = 0; i < mutations / 2; i++)
+        {
+          mutator.mutate(new AtomicTrackedIntrusiveObject());
+        }
+      });
+    }
+
+    for (auto &writer : writers)
+    {
+      writer.join();
+    }
+    done = true;
+    for (auto &reader : readers)
+    {
+      reader.join();
+    }
+    owner.get();
+
+    ASSERT_EQ(1, AtomicTrackedObject::liveCount.load());
+  }
+
+  ASSERT_EQ(0, AtomicTrackedObject::liveCount.load());
+  ASSERT_EQ(mutations + 1, AtomicTrackedObject::destructCount.load());
+}
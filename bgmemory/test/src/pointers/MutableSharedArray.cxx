@@ -0,0 +1,330 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pointers/MutableSharedPtr.hxx"
+#include "bgmemory/pointers/SharedPtrMutator.hxx"
+#include "../TestAllocators.hxx"
+#include "./TestHelpers.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <stdint.h>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+  class ThrowingTestElement
+  {
+  public:
+    static int constructed;
+    static int liveCount;
+
+    ThrowingTestElement()
+    {
+      if (constructed == 3)
+      {
+        throw std::runtime_error("element failed");
+      }
+      constructed++;
+      liveCount++;
+    }
+
+    ~ThrowingTestElement()
+    {
+      liveCount--;
+    }
+  };
+
+  int ThrowingTestElement::constructed = 0;
+  int ThrowingTestElement::liveCount = 0;
+} // namespace
+
+//---------------------
+//  DefaultDeleter
+//---------------------
+
+TEST(mutable_shared_array,
+     DefaultDeleter_CalledWithArray_DestroysEveryElement)
+{
+  TrackedDeletableTestObject::reset();
+  bg::DefaultDeleter<TrackedDeletableTestObject[]> deleter;
+
+  deleter(new TrackedDeletableTestObject[4]);
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+//---------------------
+//  Constructor
+//---------------------
+
+TEST(mutable_shared_array,
+     DefaultConstructor_Called_IsEmpty)
+{
+  bg::MutableSharedPtr<int[]> p;
+
+  ASSERT_FALSE(static_cast<bool>(p));
+  ASSERT_EQ(nullptr, p.get());
+  ASSERT_EQ(0u, p.size());
+  ASSERT_EQ(0, p.useCount());
+}
+
+TEST(mutable_shared_array,
+     PointerConstructor_Called_DeletesWithDeleteArray)
+{
+  TrackedDeletableTestObject::reset();
+  {
+    bg::MutableSharedPtr<TrackedDeletableTestObject[]> p(new TrackedDeletableTestObject[5], 5);
+    ASSERT_EQ(5u, p.size());
+    ASSERT_EQ(5, TrackedDeletableTestObject::getLiveObjectCount());
+  }
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+TEST(mutable_shared_array,
+     DeleterConstructor_CalledWithLambda_UsesDeleter)
+{
+  int deletes = 0;
+  {
+    bg::MutableSharedPtr<int[]> p(new int[3], 3, [&deletes](int *pointer) {
+      deletes++;
+      delete[] pointer;
+    });
+  }
+
+  ASSERT_EQ(1, deletes);
+}
+
+TEST(mutable_shared_array,
+     Subscript_Called_AccessesElements)
+{
+  bg::MutableSharedPtr<int[]> p(new int[4]{1, 2, 3, 4}, 4);
+
+  p[2] = 30;
+
+  ASSERT_EQ(1, p[0]);
+  ASSERT_EQ(30, p[2]);
+  ASSERT_EQ(30, p.get()[2]);
+}
+
+//---------------------
+//  makeMutableShared
+//---------------------
+
+TEST(mutable_shared_array,
+     MakeMutableShared_Called_ValueInitialisesElements)
+{
+  auto p = bg::makeMutableShared<int[]>(64);
+
+  ASSERT_EQ(64u, p.size());
+  for (size_t i = 0; i < p.size(); i++)
+  {
+    ASSERT_EQ(0, p[i]);
+  }
+}
+
+TEST(mutable_shared_array,
+     AllocateMutableShared_Called_AllocatesOnceAndFreesEverything)
+{
+  TrackedDeletableTestObject::reset();
+  CountingTestAllocator allocator;
+  {
+    auto p = bg::allocateMutableShared<TrackedDeletableTestObject[]>(allocator, 8);
+    ASSERT_EQ(1, allocator.getAllocateCount());
+    ASSERT_EQ(8, TrackedDeletableTestObject::getLiveObjectCount());
+  }
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+  ASSERT_EQ(1, allocator.getDeallocateCount());
+  ASSERT_EQ(0u, allocator.getLiveBytes());
+}
+
+TEST(mutable_shared_array,
+     AllocateMutableShared_OverAlignedElements_AlignsFirstElement)
+{
+  struct alignas(64) Wide
+  {
+    char bytes[64];
+  };
+  auto p = bg::makeMutableShared<Wide[]>(3);
+
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(p.get()) % 64);
+}
+
+TEST(mutable_shared_array,
+     AllocateMutableShared_ElementThrows_DestroysConstructedElementsAndFreesMemory)
+{
+  ThrowingTestElement::constructed = 0;
+  ThrowingTestElement::liveCount = 0;
+  CountingTestAllocator allocator;
+
+  ASSERT_THROW(bg::allocateMutableShared<ThrowingTestElement[]>(allocator, 5), std::runtime_error);
+
+  ASSERT_EQ(0, ThrowingTestElement::liveCount);
+  ASSERT_EQ(1, allocator.getDeallocateCount());
+}
+
+TEST(mutable_shared_array,
+     MakeMutableShared_SingleObject_StillCreatesObject)
+{
+  auto p = bg::makeMutableShared<SimpleTestObject>(3);
+
+  ASSERT_EQ(3, p->GetValue());
+}
+
+//---------------------
+//  Aliasing
+//---------------------
+
+TEST(mutable_shared_array,
+     AliasingConstructor_Called_ViewsRangeOfBuffer)
+{
+  bg::MutableSharedPtr<int[]> p(new int[6]{0, 1, 2, 3, 4, 5}, 6);
+
+  bg::MutableSharedPtr<int[]> view(p, 2, 3);
+
+  ASSERT_EQ(3u, view.size());
+  ASSERT_EQ(2, view[0]);
+  ASSERT_EQ(4, view[2]);
+  ASSERT_EQ(p.get() + 2, view.get());
+}
+
+TEST(mutable_shared_array,
+     AliasingConstructor_Called_SharesMetadataWithoutAllocating)
+{
+  auto p = bg::makeMutableShared<int[]>(16);
+  const long before = getGlobalNewCount();
+
+  bg::MutableSharedPtr<int[]> first(p, 0, 8);
+  bg::MutableSharedPtr<int[]> second(p, 8, 8);
+
+  ASSERT_EQ(before, getGlobalNewCount());
+  ASSERT_EQ(3, p.useCount());
+}
+
+TEST(mutable_shared_array,
+     AliasingConstructor_ViewOfView_CombinesOffsets)
+{
+  bg::MutableSharedPtr<int[]> p(new int[6]{0, 1, 2, 3, 4, 5}, 6);
+  bg::MutableSharedPtr<int[]> view(p, 1, 4);
+
+  bg::MutableSharedPtr<int[]> inner(view, 2, 2);
+
+  ASSERT_EQ(3, inner[0]);
+  ASSERT_EQ(4, inner[1]);
+}
+
+TEST(mutable_shared_array,
+     AliasingConstructor_OwnerDropped_ViewKeepsBufferAlive)
+{
+  TrackedDeletableTestObject::reset();
+  bg::MutableSharedPtr<TrackedDeletableTestObject[]> view;
+  {
+    auto p = bg::makeMutableShared<TrackedDeletableTestObject[]>(4);
+    view = bg::MutableSharedPtr<TrackedDeletableTestObject[]>(p, 1, 1);
+  }
+  ASSERT_EQ(4, TrackedDeletableTestObject::getLiveObjectCount());
+
+  view = nullptr;
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+TEST(mutable_shared_array,
+     MoveConstructor_Called_PerformsNoReferenceOperations)
+{
+  bg::MutableSharedPtr<int[]> p(new int[4](), 4);
+  bg::MutableSharedPtr<int[]> view(p, 1, 2);
+  const long before = bg::inner::referenceOperationCount();
+
+  bg::MutableSharedPtr<int[]> moved(std::move(view));
+
+  ASSERT_EQ(before, bg::inner::referenceOperationCount());
+  ASSERT_EQ(2u, moved.size());
+  ASSERT_EQ(0u, view.size());
+  ASSERT_FALSE(static_cast<bool>(view));
+}
+
+//---------------------
+//  Mutate
+//---------------------
+
+TEST(mutable_shared_array,
+     Mutate_Called_ViewsFollowIntoNewBuffer)
+{
+  bg::MutableSharedPtr<int[]> p(new int[4]{1, 2, 3, 4}, 4);
+  bg::MutableSharedPtr<int[]> view(p, 2, 2);
+
+  bg::SharedPtrMutator<int[]>(p).mutate(new int[4]{10, 20, 30, 40});
+
+  ASSERT_EQ(10, p[0]);
+  ASSERT_EQ(30, view[0]);
+  ASSERT_EQ(40, view[1]);
+  ASSERT_EQ(p.get() + 2, view.get());
+}
+
+TEST(mutable_shared_array,
+     Mutate_WithLength_ViewsFollowIntoNewBuffer)
+{
+  bg::MutableSharedPtr<int[]> p(new int[4]{1, 2, 3, 4}, 4);
+  bg::MutableSharedPtr<int[]> view(p, 1, 2);
+  bg::SharedPtrMutator<int[]> mutator(view);
+
+  mutator.mutate(new int[3]{10, 20, 30}, 3);
+
+  ASSERT_EQ(3u, mutator.requiredLength());
+  ASSERT_EQ(20, view[0]);
+  ASSERT_EQ(30, view[1]);
+}
+
+TEST(mutable_shared_array,
+     RequiredLength_MutatorFromWholeBuffer_IsBufferLength)
+{
+  auto p = bg::makeMutableShared<int[]>(5);
+
+  bg::SharedPtrMutator<int[]> mutator(p);
+  bg::SharedPtrMutator<int[]> copy(mutator);
+
+  ASSERT_EQ(5u, mutator.requiredLength());
+  ASSERT_EQ(5u, copy.requiredLength());
+}
+
+TEST(mutable_shared_array,
+     Mutate_InplaceArray_DestroysElementsThenDeletesReplacementWithDeleteArray)
+{
+  TrackedDeletableTestObject::reset();
+  {
+    auto p = bg::makeMutableShared<TrackedDeletableTestObject[]>(3);
+    bg::SharedPtrMutator<TrackedDeletableTestObject[]> mutator(p);
+
+    mutator.mutate(new TrackedDeletableTestObject[3]);
+    settleRetiredObjects();
+
+    ASSERT_EQ(3, TrackedDeletableTestObject::getLiveObjectCount());
+  }
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+TEST(mutable_shared_array,
+     Mutate_CalledOnEmptyPointer_DeletesNewArray)
+{
+  TrackedDeletableTestObject::reset();
+  bg::MutableSharedPtr<TrackedDeletableTestObject[]> p;
+
+  bg::SharedPtrMutator<TrackedDeletableTestObject[]>(p).mutate(new TrackedDeletableTestObject[2]);
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+TEST(mutable_shared_array,
+     Mutate_CalledWithNull_ViewsBecomeEmpty)
+{
+  bg::MutableSharedPtr<int[]> p(new int[4](), 4);
+  bg::MutableSharedPtr<int[]> view(p, 1, 2);
+
+  bg::SharedPtrMutator<int[]>(p).mutate(nullptr);
+
+  ASSERT_FALSE(static_cast<bool>(view));
+  ASSERT_EQ(nullptr, view.get());
+}
@@ -2,10 +2,14 @@
 #include "bgmemory/pointers/MutableSharedPtr.hxx"
 #include "bgmemory/pointers/SharedPtrMutator.hxx"
 #include "./TestHelpers.hxx"
+#include "../TestAllocators.hxx"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include <iostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 TEST(mutable_shared_ptr,
      NullPtrConstructor_Called_DoesntConstructAdditionalDeleters)
@@ -29,6 +33,70 @@ TEST(mutable_shared_ptr,
   ASSERT_EQ(1, CountableTestDeleter<int>::getDeleteCount());
 }
 
+//---------------------
+//  Empty constructors
+//---------------------
+
+TEST(mutable_shared_ptr,
+     DefaultConstructor_Called_DoesNotAllocate)
+{
+  const long before = getGlobalNewCount();
+
+  bg::MutableSharedPtr<int> p;
+  bg::MutableSharedPtr<int> p2(nullptr);
+
+  ASSERT_EQ(before, getGlobalNewCount());
+}
+
+TEST(mutable_shared_ptr,
+     DefaultConstructor_Called_IsEmpty)
+{
+  bg::MutableSharedPtr<int> p;
+
+  ASSERT_FALSE(p);
+  ASSERT_EQ(nullptr, p.get());
+  ASSERT_EQ(0, p.useCount());
+}
+
+TEST(mutable_shared_ptr,
+     DefaultConstructor_CopiedAndDestructed_DoesNotAllocate)
+{
+  const long before = getGlobalNewCount();
+
+  {
+    bg::MutableSharedPtr<int> p;
+    auto p2 = p;
+    p.swap(p2);
+  }
+
+  ASSERT_EQ(before, getGlobalNewCount());
+}
+
+TEST(mutable_shared_ptr,
+     DefaultConstructor_Called_IsNoexcept)
+{
+  static_assert(std::is_nothrow_default_constructible<bg::MutableSharedPtr<int>>::value, "");
+  static_assert(noexcept(bg::MutableSharedPtr<int>(nullptr)), "");
+  static_assert(std::is_nothrow_default_constructible<bg::MutableWeakPtr<int>>::value, "");
+}
+
+TEST(mutable_shared_ptr,
+     Reset_CalledOnEmptyPointer_TakesOwnership)
+{
+  TrackedDeletableTestObject::reset();
+  auto raw = new TrackedDeletableTestObject();
+
+  {
+    bg::MutableSharedPtr<TrackedDeletableTestObject> p;
+    p.reset(raw);
+
+    ASSERT_EQ(raw, p.get());
+    ASSERT_EQ(1, p.useCount());
+  }
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
 //---------------------
 //  Pointer constructor
 //---------------------
@@ -183,6 +251,82 @@ TEST(mutable_shared_ptr,
   ASSERT_EQ(expected, ((const IdTestDeleter<int> &)p.getDeleter()).getId());
 }
 
+//---------------------
+//  Pointer Inline Deleter constructor
+//---------------------
+
+TEST(mutable_shared_ptr,
+     PointerConstructor_Called_DoesNotUseGlobalNew)
+{
+  auto pointer = new int(5);
+  const long before = getGlobalNewCount();
+
+  bg::MutableSharedPtr<int> p(pointer);
+
+  ASSERT_EQ(before, getGlobalNewCount());
+}
+
+TEST(mutable_shared_ptr,
+     InlineDeleterConstructor_CalledWithLambda_DoesNotUseGlobalNew)
+{
+  auto pointer = new int(5);
+  int calls = 0;
+  const long before = getGlobalNewCount();
+
+  bg::MutableSharedPtr<int> p(pointer, [&calls](int *i) { calls++; delete i; });
+
+  ASSERT_EQ(before, getGlobalNewCount());
+}
+
+TEST(mutable_shared_ptr,
+     InlineDeleterConstructor_CalledWithLambdaThenDestructed_CallsLambda)
+{
+  int calls = 0;
+
+  {
+    bg::MutableSharedPtr<int> p(new int(5), [&calls](int *i) { calls++; delete i; });
+    auto copy = p;
+  }
+
+  ASSERT_EQ(1, calls);
+}
+
+TEST(mutable_shared_ptr,
+     InlineDeleterConstructor_CalledWithLambda_GetDeleterCallsLambda)
+{
+  int calls = 0;
+  bg::MutableSharedPtr<int> p(new int(5), [&calls](int *i) { calls++; delete i; });
+
+  p.getDeleter()(nullptr);
+
+  ASSERT_EQ(1, calls);
+}
+
+TEST(mutable_shared_ptr,
+     InlineDeleterConstructor_CalledWithDeleterValue_CallsDeleterOnRelease)
+{
+  CountableTestDeleter<int>::reset();
+
+  {
+    bg::MutableSharedPtr<int> p(new int(5), CountableTestDeleter<int>());
+  }
+
+  ASSERT_EQ(1, CountableTestDeleter<int>::getDeleteCount());
+}
+
+TEST(mutable_shared_ptr,
+     InlineDeleterConstructor_CalledWithFunctionPointer_CallsFunction)
+{
+  static int calls;
+  calls = 0;
+
+  {
+    bg::MutableSharedPtr<int> p(new int(5), +[](int *i) { calls++; delete i; });
+  }
+
+  ASSERT_EQ(1, calls);
+}
+
 //---------------------
 //  Reset
 //---------------------
@@ -219,6 +363,7 @@ TEST(mutable_shared_ptr,
   bg::MutableSharedPtr<TrackedDeletableTestObject> p(new TrackedDeletableTestObject());
   ASSERT_EQ(expected + 1, TrackedDeletableTestObject::getLiveObjectCount());
   p.reset(secondObject);
+  settleRetiredObjects();
 
   ASSERT_EQ(expected, TrackedDeletableTestObject::getLiveObjectCount());
 }
@@ -274,6 +419,135 @@ TEST(mutable_shared_ptr,
   ASSERT_EQ(1, CountableTestDeleter<int>::getDeleteCount());
 }
 
+//---------------------
+//  Move constructor / Assignment
+//---------------------
+
+TEST(mutable_shared_ptr,
+     MoveConstructor_Called_TakesOverReferenceAndEmptiesOriginal)
+{
+  auto original = bg::makeMutableShared<int>(5);
+
+  auto moved = std::move(original);
+
+  ASSERT_FALSE(original);
+  ASSERT_EQ(5, *moved);
+  ASSERT_EQ(1, moved.useCount());
+}
+
+TEST(mutable_shared_ptr,
+     MoveConstructor_Called_PerformsNoReferenceOperations)
+{
+  auto original = bg::makeMutableShared<int>(5);
+  const long before = bg::inner::referenceOperationCount();
+
+  bg::MutableSharedPtr<int> moved(std::move(original));
+
+  ASSERT_EQ(before, bg::inner::referenceOperationCount());
+}
+
+TEST(mutable_shared_ptr,
+     CopyAssignment_Called_SharesObjectAndReleasesPrevious)
+{
+  TrackedDeletableTestObject::reset();
+  auto first = bg::makeMutableShared<TrackedDeletableTestObject>();
+  auto second = bg::makeMutableShared<TrackedDeletableTestObject>();
+
+  second = first;
+
+  ASSERT_EQ(1, TrackedDeletableTestObject::getLiveObjectCount());
+  ASSERT_EQ(first.get(), second.get());
+  ASSERT_EQ(2, first.useCount());
+}
+
+TEST(mutable_shared_ptr,
+     CopyAssignment_SelfAssigned_KeepsObject)
+{
+  auto p = bg::makeMutableShared<int>(5);
+  auto &alias = p;
+
+  p = alias;
+
+  ASSERT_EQ(5, *p);
+  ASSERT_EQ(1, p.useCount());
+}
+
+TEST(mutable_shared_ptr,
+     CopyAssignment_CalledWithEmptyPointer_ReleasesObject)
+{
+  TrackedDeletableTestObject::reset();
+  auto p = bg::makeMutableShared<TrackedDeletableTestObject>();
+
+  p = bg::MutableSharedPtr<TrackedDeletableTestObject>();
+
+  ASSERT_FALSE(p);
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+TEST(mutable_shared_ptr,
+     MoveAssignment_Called_ReleasesPreviousAndEmptiesOriginal)
+{
+  TrackedDeletableTestObject::reset();
+  auto first = bg::makeMutableShared<TrackedDeletableTestObject>();
+  auto second = bg::makeMutableShared<TrackedDeletableTestObject>();
+  auto expected = first.get();
+
+  second = std::move(first);
+
+  ASSERT_FALSE(first);
+  ASSERT_EQ(expected, second.get());
+  ASSERT_EQ(1, second.useCount());
+  ASSERT_EQ(1, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+TEST(mutable_shared_ptr,
+     MoveAssignment_Called_PerformsNoReferenceOperationsOnNewObject)
+{
+  auto first = bg::makeMutableShared<int>(1);
+  bg::MutableSharedPtr<int> second;
+  const long before = bg::inner::referenceOperationCount();
+
+  second = std::move(first);
+
+  ASSERT_EQ(before, bg::inner::referenceOperationCount());
+}
+
+TEST(mutable_shared_ptr,
+     ConvertingAssignment_FromDerivedType_IsNotAvailable)
+{
+  struct Base
+  {
+    virtual ~Base() = default;
+  };
+  struct Derived : Base
+  {
+  };
+
+  ASSERT_FALSE((std::is_assignable<bg::MutableSharedPtr<Base> &, const bg::MutableSharedPtr<Derived> &>::value));
+  ASSERT_FALSE((std::is_constructible<bg::MutableSharedPtr<Base>, const bg::MutableSharedPtr<Derived> &>::value));
+  ASSERT_TRUE((std::is_assignable<bg::MutableSharedPtr<Base> &, const bg::MutableSharedPtr<Base> &>::value));
+}
+
+TEST(mutable_shared_ptr,
+     Vector_Reallocated_PerformsNoReferenceOperations)
+{
+  std::vector<bg::MutableSharedPtr<int>> pointers;
+  pointers.reserve(1);
+  for (int i = 0; i < 64; i++)
+  {
+    auto p = bg::makeMutableShared<int>(i);
+    const long before = bg::inner::referenceOperationCount();
+    pointers.push_back(std::move(p));
+    ASSERT_EQ(before, bg::inner::referenceOperationCount());
+  }
+
+  for (int i = 0; i < 64; i++)
+  {
+    ASSERT_EQ(1, pointers[i].useCount());
+    ASSERT_EQ(i, *pointers[i]);
+  }
+}
+
 //---------------------
 //  Swap
 //---------------------
@@ -323,4 +597,87 @@ TEST(mutable_shared_ptr,
   ASSERT_EQ(changedValue, *firstPointer);
   ASSERT_EQ(initialValue, *secondPointer);
   ASSERT_EQ(initialValue, *newPointer);
-}
\ No newline at end of file
+}
+
+//---------------------
+//  MakeMutableShared
+//---------------------
+
+TEST(mutable_shared_ptr,
+     MakeMutableShared_Called_ConstructsObjectWithArguments)
+{
+  const int expected = 42;
+
+  auto p = bg::makeMutableShared<SimpleTestObject>(expected);
+
+  ASSERT_EQ(expected, p->GetValue());
+  ASSERT_EQ(1, p.useCount());
+}
+
+TEST(mutable_shared_ptr,
+     MakeMutableShared_CalledThenDestructed_DestructsTheObject)
+{
+  TrackedDeletableTestObject::reset();
+
+  {
+    auto p = bg::makeMutableShared<TrackedDeletableTestObject>();
+    ASSERT_EQ(1, TrackedDeletableTestObject::getLiveObjectCount());
+  }
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+TEST(mutable_shared_ptr,
+     AllocateMutableShared_Called_MakesSingleAllocation)
+{
+  CountingTestAllocator allocator;
+
+  {
+    auto p = bg::allocateMutableShared<int>(allocator, 3);
+    auto p2 = p;
+
+    ASSERT_EQ(1, allocator.getAllocateCount());
+    ASSERT_EQ(3, *p2);
+  }
+
+  ASSERT_EQ(1, allocator.getDeallocateCount());
+}
+
+TEST(mutable_shared_ptr,
+     AllocateMutableShared_CalledWithWeakPtrOutliving_FreesMemoryAfterWeakPtr)
+{
+  CountingTestAllocator allocator;
+  TrackedDeletableTestObject::reset();
+
+  {
+    bg::MutableWeakPtr<TrackedDeletableTestObject> w;
+    {
+      auto p = bg::allocateMutableShared<TrackedDeletableTestObject>(allocator);
+      w = p;
+    }
+
+    ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+    ASSERT_EQ(0, allocator.getDeallocateCount());
+  }
+
+  ASSERT_EQ(1, allocator.getDeallocateCount());
+}
+
+TEST(mutable_shared_ptr,
+     MakeMutableShared_Mutated_DeletesInPlaceObjectAndOwnsReplacement)
+{
+  TrackedDeletableTestObject::reset();
+
+  {
+    auto p = bg::makeMutableShared<TrackedDeletableTestObject>();
+    auto replacement = new TrackedDeletableTestObject();
+    bg::SharedPtrMutator<TrackedDeletableTestObject> m(p);
+    m.mutate(replacement);
+    settleRetiredObjects();
+
+    ASSERT_EQ(replacement, p.get());
+    ASSERT_EQ(1, TrackedDeletableTestObject::getLiveObjectCount());
+  }
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
@@ -3,10 +3,13 @@
 #include "bgmemory/pointers/MutableSharedPtr.hxx"
 #include "bgmemory/pointers/SharedPtrMutator.hxx"
 #include "./TestHelpers.hxx"
+#include "../TestAllocators.hxx"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include <iostream>
+#include <utility>
+#include <vector>
 
 TEST(mutable_weak_ptr,
      Constructor_CopiedFromSharedPtr_DoesntDeleteSharedPtrAfterFallingOutOfScope)
@@ -35,6 +38,116 @@ TEST(mutable_weak_ptr,
     ASSERT_EQ(1, CountableTestDeleter<int>::getDeleteCount());
 }
 
+TEST(mutable_weak_ptr,
+     DefaultConstructor_Called_DoesNotAllocate)
+{
+    const long before = getGlobalNewCount();
+
+    {
+        bg::MutableWeakPtr<int> w;
+        auto w2 = w;
+    }
+
+    ASSERT_EQ(before, getGlobalNewCount());
+}
+
+TEST(mutable_weak_ptr,
+     DefaultConstructor_Called_IsExpired)
+{
+    bg::MutableWeakPtr<int> w;
+
+    ASSERT_TRUE(w.expired());
+    ASSERT_EQ(0, w.useCount());
+}
+
+TEST(mutable_weak_ptr,
+     Constructor_AssignedTwice_ReleasesFirstPayload)
+{
+    CountableTestDeleter<int>::reset();
+
+    bg::MutableWeakPtr<int> w;
+    {
+        bg::MutableSharedPtr<int> p(new int(3), new CountableTestDeleter<int>());
+        w = p;
+    }
+    bg::MutableSharedPtr<int> p2(new int(4));
+    w = p2;
+
+    ASSERT_EQ(1, CountableTestDeleter<int>::getDeleteCount());
+    ASSERT_EQ(4, *w.lock());
+}
+
+TEST(mutable_weak_ptr,
+     Constructor_SelfAssigned_KeepsReference)
+{
+    bg::MutableSharedPtr<int> p(new int(3));
+    bg::MutableWeakPtr<int> w = p;
+    auto &alias = w;
+
+    w = alias;
+
+    ASSERT_EQ(3, *w.lock());
+}
+
+//************************
+// Move
+//************************
+
+TEST(mutable_weak_ptr,
+     MoveConstructor_Called_TakesOverReferenceAndEmptiesOriginal)
+{
+  auto shared = bg::makeMutableShared<int>(5);
+  bg::MutableWeakPtr<int> original(shared);
+
+  bg::MutableWeakPtr<int> moved(std::move(original));
+
+  ASSERT_TRUE(original.expired());
+  ASSERT_EQ(5, *moved.lock());
+}
+
+TEST(mutable_weak_ptr,
+     MoveConstructor_Called_PerformsNoReferenceOperations)
+{
+  auto shared = bg::makeMutableShared<int>(5);
+  bg::MutableWeakPtr<int> original(shared);
+  const long before = bg::inner::referenceOperationCount();
+
+  bg::MutableWeakPtr<int> moved(std::move(original));
+
+  ASSERT_EQ(before, bg::inner::referenceOperationCount());
+}
+
+TEST(mutable_weak_ptr,
+     MoveAssignment_Called_TakesOverReferenceAndEmptiesOriginal)
+{
+  auto first = bg::makeMutableShared<int>(1);
+  auto second = bg::makeMutableShared<int>(2);
+  bg::MutableWeakPtr<int> original(first);
+  bg::MutableWeakPtr<int> target(second);
+
+  target = std::move(original);
+
+  ASSERT_TRUE(original.expired());
+  ASSERT_EQ(1, *target.lock());
+}
+
+TEST(mutable_weak_ptr,
+     Vector_Reallocated_PerformsNoReferenceOperations)
+{
+  auto shared = bg::makeMutableShared<int>(5);
+  std::vector<bg::MutableWeakPtr<int>> pointers;
+  pointers.reserve(1);
+  for (int i = 0; i < 64; i++)
+  {
+    bg::MutableWeakPtr<int> p(shared);
+    const long before = bg::inner::referenceOperationCount();
+    pointers.push_back(std::move(p));
+    ASSERT_EQ(before, bg::inner::referenceOperationCount());
+  }
+
+  ASSERT_EQ(1, shared.useCount());
+}
+
 //************************
 // Expired
 //************************
@@ -95,6 +208,25 @@ TEST(mutable_weak_ptr,
     ASSERT_EQ(expected, p2.get());
 }
 
+TEST(mutable_weak_ptr,
+     Lock_CalledWithExpiredPointer_DoesNotAllocate)
+{
+    bg::MutableWeakPtr<int> w;
+    {
+        bg::MutableSharedPtr<int> p(new int(3));
+        w = p;
+    }
+    bg::MutableWeakPtr<int> empty;
+    const long before = getGlobalNewCount();
+
+    auto p2 = w.lock();
+    auto p3 = empty.lock();
+
+    ASSERT_EQ(before, getGlobalNewCount());
+    ASSERT_FALSE(p2);
+    ASSERT_FALSE(p3);
+}
+
 //************************
 // Reset
 //************************
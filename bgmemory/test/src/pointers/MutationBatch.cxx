@@ -0,0 +1,292 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pointers/MutableSharedPtr.hxx"
+#include "bgmemory/pointers/SharedPtrMutator.hxx"
+#include "bgmemory/pointers/MutationBatch.hxx"
+#include "./TestHelpers.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//---------------------
+//  Add / Commit
+//---------------------
+
+TEST(mutation_batch,
+     Add_BeforeCommit_LeavesPointersUnchanged)
+{
+  bg::MutableSharedPtr<int> p(new int(1));
+  bg::MutationBatch<int> batch;
+
+  ASSERT_TRUE(batch.add(bg::SharedPtrMutator<int>(p), new int(2)));
+
+  ASSERT_EQ(1, *p);
+  ASSERT_EQ(1u, batch.size());
+  batch.commit();
+}
+
+TEST(mutation_batch,
+     Commit_Called_RetargetsEveryPointer)
+{
+  std::vector<bg::MutableSharedPtr<int>> pointers;
+  std::vector<bg::MutableSharedPtr<int>> copies;
+  for (int i = 0; i < 40; i++)
+  {
+    pointers.emplace_back(new int(i));
+    copies.push_back(pointers.back());
+  }
+
+  bg::MutationBatch<int> batch;
+  for (int i = 0; i < 40; i++)
+  {
+    batch.add(bg::SharedPtrMutator<int>(pointers[i]), new int(i + 100));
+  }
+  batch.commit();
+
+  ASSERT_EQ(0u, batch.size());
+  for (int i = 0; i < 40; i++)
+  {
+    ASSERT_EQ(i + 100, *pointers[i]);
+    ASSERT_EQ(i + 100, *copies[i]);
+  }
+}
+
+TEST(mutation_batch,
+     Commit_Called_DisposesReplacedObjectsThroughTheirDeleters)
+{
+  CountableTestDeleter<int>::reset();
+  bg::MutableSharedPtr<int> first(new int(1), new CountableTestDeleter<int>());
+  bg::MutableSharedPtr<int> second(new int(2), new CountableTestDeleter<int>());
+
+  bg::MutationBatch<int> batch;
+  batch.add(bg::SharedPtrMutator<int>(first), new int(3));
+  batch.add(bg::SharedPtrMutator<int>(second), new int(4));
+  batch.commit();
+  settleRetiredObjects();
+
+  ASSERT_EQ(2, CountableTestDeleter<int>::getDeleteCount());
+}
+
+TEST(mutation_batch,
+     Commit_LastPointerDroppedWhileQueued_CleansUpBothObjects)
+{
+  TrackedDeletableTestObject::reset();
+  bg::MutationBatch<TrackedDeletableTestObject> batch;
+  {
+    bg::MutableSharedPtr<TrackedDeletableTestObject> p(new TrackedDeletableTestObject());
+    batch.add(bg::SharedPtrMutator<TrackedDeletableTestObject>(p), new TrackedDeletableTestObject());
+  }
+  ASSERT_EQ(2, TrackedDeletableTestObject::getLiveObjectCount());
+
+  batch.commit();
+  settleRetiredObjects();
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+TEST(mutation_batch,
+     Add_ObjectExpired_CleansUpReplacementAndReturnsFalse)
+{
+  TrackedDeletableTestObject::reset();
+  bg::MutableWeakPtr<TrackedDeletableTestObject> w;
+  {
+    bg::MutableSharedPtr<TrackedDeletableTestObject> p(new TrackedDeletableTestObject());
+    w = p;
+  }
+  bg::MutationBatch<TrackedDeletableTestObject> batch;
+
+  ASSERT_FALSE(batch.add(bg::SharedPtrMutator<TrackedDeletableTestObject>(w), new TrackedDeletableTestObject()));
+  ASSERT_EQ(0u, batch.size());
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+TEST(mutation_batch,
+     Add_EmptyPointer_CleansUpReplacementAndReturnsFalse)
+{
+  TrackedDeletableTestObject::reset();
+  bg::MutableSharedPtr<TrackedDeletableTestObject> p;
+  bg::MutationBatch<TrackedDeletableTestObject> batch;
+
+  ASSERT_FALSE(batch.add(bg::SharedPtrMutator<TrackedDeletableTestObject>(p), new TrackedDeletableTestObject()));
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+TEST(mutation_batch,
+     Destructor_MutationsQueued_CommitsThem)
+{
+  bg::MutableSharedPtr<int> p(new int(1));
+  {
+    bg::MutationBatch<int> batch(4);
+    batch.add(bg::SharedPtrMutator<int>(p), new int(2));
+  }
+
+  ASSERT_EQ(2, *p);
+}
+
+TEST(mutation_batch,
+     Commit_Empty_DoesNothing)
+{
+  bg::MutationBatch<int> batch;
+  batch.commit();
+  batch.commit([](int *const *, size_t) { FAIL(); });
+
+  ASSERT_EQ(0u, batch.size());
+}
+
+//---------------------
+//  Relocate / Recycle
+//---------------------
+
+TEST(mutation_batch,
+     Relocate_Called_MovesObjectIntoDestination)
+{
+  // Heap storage, so the default deleter can clean up the moved object.
+  void *destination = ::operator new(sizeof(SimpleTestObject));
+  bg::MutableSharedPtr<SimpleTestObject> p(new SimpleTestObject(7));
+  bg::MutationBatch<SimpleTestObject> batch;
+
+  SimpleTestObject *moved = batch.relocate(bg::SharedPtrMutator<SimpleTestObject>(p), destination);
+  ASSERT_EQ(destination, static_cast<void *>(moved));
+  ASSERT_EQ(7, moved->GetValue());
+  ASSERT_NE(moved, p.get());
+
+  batch.commit();
+  settleRetiredObjects();
+
+  ASSERT_EQ(moved, p.get());
+  ASSERT_EQ(7, p->GetValue());
+}
+
+TEST(mutation_batch,
+     Relocate_ObjectExpired_ReturnsNull)
+{
+  using Storage = std::aligned_storage<sizeof(int), alignof(int)>::type;
+  Storage destination;
+  bg::MutableWeakPtr<int> w;
+  {
+    bg::MutableSharedPtr<int> p(new int(1));
+    w = p;
+  }
+  bg::MutationBatch<int> batch;
+
+  ASSERT_EQ(nullptr, batch.relocate(bg::SharedPtrMutator<int>(w), &destination));
+  ASSERT_EQ(0u, batch.size());
+}
+
+TEST(mutation_batch,
+     CommitWithRecycle_Called_HandsEveryReplacedObjectOverInOneCall)
+{
+  std::vector<bg::MutableSharedPtr<int>> pointers;
+  std::vector<int *> originals;
+  for (int i = 0; i < 20; i++)
+  {
+    pointers.emplace_back(new int(i));
+    originals.push_back(pointers.back().get());
+  }
+
+  int calls = 0;
+  std::vector<int *> recycled;
+  bg::MutationBatch<int> batch;
+  for (auto &p : pointers)
+  {
+    batch.add(bg::SharedPtrMutator<int>(p), new int(*p));
+  }
+  batch.commit([&](int *const *objects, size_t count) {
+    calls++;
+    recycled.assign(objects, objects + count);
+    for (auto object : recycled)
+    {
+      delete object;
+    }
+  });
+  settleRetiredObjects();
+
+  ASSERT_EQ(1, calls);
+  ASSERT_EQ(originals, recycled);
+}
+
+TEST(mutation_batch,
+     CommitWithRecycle_NullObjectsReplaced_SkipsThem)
+{
+  bg::MutableSharedPtr<int> empty(new int(1));
+  bg::SharedPtrMutator<int>(empty).mutate(nullptr);
+  bg::MutableSharedPtr<int> full(new int(2));
+
+  size_t recycledCount = 0;
+  bg::MutationBatch<int> batch;
+  batch.add(bg::SharedPtrMutator<int>(empty), new int(3));
+  batch.add(bg::SharedPtrMutator<int>(full), new int(4));
+  batch.commit([&](int *const *objects, size_t count) {
+    recycledCount += count;
+    for (size_t i = 0; i < count; i++)
+    {
+      delete objects[i];
+    }
+  });
+  settleRetiredObjects();
+
+  ASSERT_EQ(1u, recycledCount);
+  ASSERT_EQ(3, *empty);
+  ASSERT_EQ(4, *full);
+}
+
+#ifdef BG_MEMORY_MULTITHREAD
+//---------------------
+//  Retirement
+//---------------------
+
+TEST(mutation_batch,
+     Commit_ReaderInsideGuard_KeepsReplacedObjectsUntilGuardEnds)
+{
+  TrackedDeletableTestObject::reset();
+  bg::MutableSharedPtr<TrackedDeletableTestObject> first(new TrackedDeletableTestObject());
+  bg::MutableSharedPtr<TrackedDeletableTestObject> second(new TrackedDeletableTestObject());
+
+  {
+    bg::EpochGuard guard;
+    bg::MutationBatch<TrackedDeletableTestObject> batch;
+    batch.add(bg::SharedPtrMutator<TrackedDeletableTestObject>(first), new TrackedDeletableTestObject());
+    batch.add(bg::SharedPtrMutator<TrackedDeletableTestObject>(second), new TrackedDeletableTestObject());
+    batch.commit();
+    bg::reclaimRetired();
+
+    ASSERT_EQ(4, TrackedDeletableTestObject::getLiveObjectCount());
+  }
+  settleRetiredObjects();
+
+  ASSERT_EQ(2, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+TEST(mutation_batch,
+     Relocate_ConcurrentMutate_MovesFromLiveObject)
+{
+  using Values = std::vector<int>;
+  bg::MutableSharedPtr<Values> p(new Values(64, 1));
+  std::atomic<bool> done{false};
+  std::thread mutator([&] {
+    bg::SharedPtrMutator<Values> m(p);
+    while (!done.load())
+    {
+      m.mutate(new Values(64, 1));
+    }
+  });
+
+  size_t movedSizes = 0;
+  for (int i = 0; i < 2000; i++)
+  {
+    bg::MutationBatch<Values> batch;
+    Values *moved = batch.relocate(bg::SharedPtrMutator<Values>(p), ::operator new(sizeof(Values)));
+    movedSizes += moved->size();
+    batch.commit();
+  }
+  done = true;
+  mutator.join();
+  settleRetiredObjects();
+
+  ASSERT_EQ(2000u * 64u, movedSizes);
+}
+#endif // BG_MEMORY_MULTITHREAD
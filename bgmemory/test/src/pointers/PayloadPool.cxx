@@ -0,0 +1,115 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pointers/inner/PayloadPool.hxx"
+#include "../TestAllocators.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+//---------------------
+//  Allocate
+//---------------------
+
+TEST(payload_pool,
+     Allocate_Called_ReturnsAlignedMemory)
+{
+  auto pointer = bg::inner::allocatePayload(40);
+
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(pointer) % bg::inner::payloadGranularity);
+
+  bg::inner::deallocatePayload(pointer, 40);
+}
+
+TEST(payload_pool,
+     Allocate_CalledAfterDeallocate_ReusesBlock)
+{
+  auto first = bg::inner::allocatePayload(40);
+  bg::inner::deallocatePayload(first, 40);
+
+  auto second = bg::inner::allocatePayload(40);
+
+  ASSERT_EQ(first, second);
+  bg::inner::deallocatePayload(second, 40);
+}
+
+TEST(payload_pool,
+     Allocate_CalledRepeatedlyOnNewThread_ReturnsAdjacentBlocks)
+{
+  // A size class no other test uses, so the new thread starts from fresh slab.
+  const size_t size = 200;
+  std::vector<unsigned char *> blocks;
+
+  std::thread([&blocks, size]() {
+    for (int i = 0; i < 4; i++)
+    {
+      blocks.push_back(static_cast<unsigned char *>(bg::inner::allocatePayload(size)));
+    }
+    for (auto block : blocks)
+    {
+      bg::inner::deallocatePayload(block, size);
+    }
+  }).join();
+
+  for (size_t i = 1; i < blocks.size(); i++)
+  {
+    ASSERT_EQ(blocks[i - 1] + 208, blocks[i]);
+  }
+}
+
+TEST(payload_pool,
+     Allocate_CalledWithOversizedPayload_ReturnsUsableMemory)
+{
+  const size_t size = bg::inner::payloadMaxPooledSize + 1;
+
+  auto pointer = static_cast<unsigned char *>(bg::inner::allocatePayload(size));
+  pointer[0] = 1;
+  pointer[size - 1] = 1;
+
+  bg::inner::deallocatePayload(pointer, size);
+}
+
+TEST(payload_pool,
+     Allocate_CalledManyTimes_DoesNotUseGlobalNew)
+{
+  bg::inner::deallocatePayload(bg::inner::allocatePayload(48), 48);
+  std::vector<void *> blocks(1000);
+  const long before = getGlobalNewCount();
+
+  for (auto &block : blocks)
+  {
+    block = bg::inner::allocatePayload(48);
+  }
+  for (auto block : blocks)
+  {
+    bg::inner::deallocatePayload(block, 48);
+  }
+
+  ASSERT_EQ(before, getGlobalNewCount());
+}
+
+//---------------------
+//  Deallocate
+//---------------------
+
+TEST(payload_pool,
+     Deallocate_CalledFromAnotherThread_MakesBlockReusable)
+{
+  auto pointer = bg::inner::allocatePayload(64);
+
+  void *reused = nullptr;
+  std::thread([pointer, &reused]() {
+    bg::inner::deallocatePayload(pointer, 64);
+    reused = bg::inner::allocatePayload(64);
+    bg::inner::deallocatePayload(reused, 64);
+  }).join();
+
+  ASSERT_EQ(pointer, reused);
+}
+
+TEST(payload_pool,
+     Deallocate_CalledWithNullPtr_DoesNothing)
+{
+  bg::inner::deallocatePayload(nullptr, 40);
+}
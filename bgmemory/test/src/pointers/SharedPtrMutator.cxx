@@ -7,6 +7,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include <iostream>
+#include <utility>
 
 //---------------------
 //  Mutate
@@ -47,6 +48,7 @@ TEST(shared_ptr_mutator,
     ASSERT_EQ(expected + 1, TrackedDeletableTestObject::getLiveObjectCount());
     bg::SharedPtrMutator<TrackedDeletableTestObject> m(p);
     m.mutate(secondObject);
+    settleRetiredObjects();
 
     ASSERT_EQ(expected, TrackedDeletableTestObject::getLiveObjectCount());
 }
@@ -105,6 +107,7 @@ TEST(shared_ptr_mutator,
     ASSERT_EQ(expected + 1, TrackedDeletableTestObject::getLiveObjectCount());
     bg::SharedPtrMutator<TrackedDeletableTestObject> m(w);
     m.mutate(secondObject);
+    settleRetiredObjects();
 
     ASSERT_EQ(expected, TrackedDeletableTestObject::getLiveObjectCount());
 }
@@ -124,4 +127,80 @@ TEST(shared_ptr_mutator,
 
     ASSERT_EQ(changedValue, *firstPointer);
     ASSERT_EQ(changedValue, *secondPointer);
-}
\ No newline at end of file
+}
+
+TEST(shared_ptr_mutator,
+     Mutate_CalledOnEmptyPointer_DeletesNewObject)
+{
+    TrackedDeletableTestObject::reset();
+
+    bg::MutableSharedPtr<TrackedDeletableTestObject> p;
+    bg::SharedPtrMutator<TrackedDeletableTestObject> m(p);
+    m.mutate(new TrackedDeletableTestObject());
+
+    ASSERT_EQ(nullptr, p.get());
+    ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+TEST(shared_ptr_mutator,
+     Mutate_CalledAfterObjectExpired_DeletesNewObject)
+{
+    TrackedDeletableTestObject::reset();
+
+    bg::MutableWeakPtr<TrackedDeletableTestObject> w;
+    {
+        bg::MutableSharedPtr<TrackedDeletableTestObject> p(new TrackedDeletableTestObject());
+        w = p;
+    }
+    bg::SharedPtrMutator<TrackedDeletableTestObject> m(w);
+    m.mutate(new TrackedDeletableTestObject());
+
+    ASSERT_TRUE(w.expired());
+    ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+//---------------------
+//  Copy / Assignment
+//---------------------
+
+TEST(shared_ptr_mutator,
+     CopyConstructor_Called_BothMutatorsChangeTheSameObject)
+{
+  bg::MutableSharedPtr<int> p(new int(1));
+  bg::SharedPtrMutator<int> mutator(p);
+  bg::SharedPtrMutator<int> copy(mutator);
+
+  mutator.mutate(new int(2));
+  copy.mutate(new int(3));
+
+  ASSERT_EQ(3, *p);
+}
+
+TEST(shared_ptr_mutator,
+     CopyAssignment_Called_MutatesTheNewObject)
+{
+  bg::MutableSharedPtr<int> first(new int(1));
+  bg::MutableSharedPtr<int> second(new int(2));
+  bg::SharedPtrMutator<int> mutator(first);
+  bg::SharedPtrMutator<int> other(second);
+
+  mutator = other;
+  mutator.mutate(new int(3));
+
+  ASSERT_EQ(1, *first);
+  ASSERT_EQ(3, *second);
+}
+
+TEST(shared_ptr_mutator,
+     MoveConstructor_Called_PerformsNoReferenceOperations)
+{
+  bg::MutableSharedPtr<int> p(new int(1));
+  bg::SharedPtrMutator<int> mutator(p);
+  const long before = bg::inner::referenceOperationCount();
+
+  bg::SharedPtrMutator<int> moved(std::move(mutator));
+
+  ASSERT_EQ(before, bg::inner::referenceOperationCount());
+  moved.mutate(new int(2));
+  ASSERT_EQ(2, *p);
+}
@@ -1,3 +1,5 @@
 #include "./TestHelpers.hxx"
 
-int TrackedDeletableTestObject::liveObjectCount;
\ No newline at end of file
+int TrackedDeletableTestObject::liveObjectCount;
+int IntrusiveTestObject::liveObjectCount;
+int CountedTestValue::liveObjectCount;
@@ -3,6 +3,21 @@
 #define TEST_POINTERS_TESTHELPERS_HXX_
 
 #include "bgmemory/pointers/Deleter.hxx"
+#include "bgmemory/pointers/IntrusiveMutablePtr.hxx"
+#include "bgmemory/reclamation/EpochReclamation.hxx"
+
+#include <stdexcept>
+
+/*
+  In multithreaded mode mutated objects are retired and cleaned up later.
+  Call before checking that a replaced object was cleaned up.
+*/
+inline void settleRetiredObjects()
+{
+#ifdef BG_MEMORY_MULTITHREAD
+  bg::synchronizeRetired();
+#endif // BG_MEMORY_MULTITHREAD
+}
 
 template <class T>
 class IdTestDeleter : public bg::Deleter<T>
@@ -109,6 +124,86 @@ public:
   }
 };
 
+class IntrusiveTestObject : public bg::IntrusiveMutable<IntrusiveTestObject>
+{
+  static int liveObjectCount;
+  int value;
+
+public:
+  explicit IntrusiveTestObject(int v) : value(v)
+  {
+    IntrusiveTestObject::liveObjectCount++;
+  }
+
+  ~IntrusiveTestObject()
+  {
+    IntrusiveTestObject::liveObjectCount--;
+  }
+
+  static void reset()
+  {
+    liveObjectCount = 0;
+  }
+
+  static int getLiveObjectCount() { return liveObjectCount; }
+
+  int GetValue() const
+  {
+    return value;
+  }
+};
+
+/*
+  Movable value counting its live instances, for checking that containers
+  construct and destroy exactly the values they should.
+*/
+class CountedTestValue
+{
+  static int liveObjectCount;
+
+public:
+  int value;
+
+  explicit CountedTestValue(int v) : value(v)
+  {
+    CountedTestValue::liveObjectCount++;
+  }
+
+  CountedTestValue(CountedTestValue &&other) noexcept : value(other.value)
+  {
+    CountedTestValue::liveObjectCount++;
+  }
+
+  ~CountedTestValue()
+  {
+    CountedTestValue::liveObjectCount--;
+  }
+
+  static void reset()
+  {
+    liveObjectCount = 0;
+  }
+
+  static int getLiveObjectCount() { return liveObjectCount; }
+};
+
+/*
+  Writes to its storage before optionally throwing from its constructor, for
+  checking that containers recover the slot a failed construction used.
+*/
+struct ThrowingTestObject
+{
+  int value;
+
+  explicit ThrowingTestObject(bool shouldThrow) : value(12345)
+  {
+    if (shouldThrow)
+    {
+      throw std::runtime_error("ThrowingTestObject");
+    }
+  }
+};
+
 template <class T>
 int CountableTestDeleter<T>::deleteCount;
 template <class T>
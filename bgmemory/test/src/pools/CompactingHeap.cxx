@@ -0,0 +1,283 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pools/CompactingHeap.hxx"
+#include "../pointers/TestHelpers.hxx"
+#include "../TestAllocators.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <utility>
+#include <vector>
+
+namespace
+{
+  class MoveTrackedTestObject
+  {
+    static int liveObjectCount;
+    static int moveCount;
+
+  public:
+    int value;
+
+    explicit MoveTrackedTestObject(int v) : value(v)
+    {
+      liveObjectCount++;
+    }
+
+    MoveTrackedTestObject(MoveTrackedTestObject &&other) : value(other.value)
+    {
+      other.value = -1;
+      liveObjectCount++;
+      moveCount++;
+    }
+
+    ~MoveTrackedTestObject()
+    {
+      liveObjectCount--;
+    }
+
+    static void reset()
+    {
+      liveObjectCount = 0;
+      moveCount = 0;
+    }
+
+    static int getLiveObjectCount() { return liveObjectCount; }
+    static int getMoveCount() { return moveCount; }
+  };
+
+  int MoveTrackedTestObject::liveObjectCount;
+  int MoveTrackedTestObject::moveCount;
+
+  // Fills the heap then drops every other handle, leaving alternating holes.
+  std::vector<bg::MutableSharedPtr<MoveTrackedTestObject>> makeFragmented(
+      bg::CompactingHeap<MoveTrackedTestObject> &heap)
+  {
+    std::vector<bg::MutableSharedPtr<MoveTrackedTestObject>> kept;
+    std::vector<bg::MutableSharedPtr<MoveTrackedTestObject>> dropped;
+    for (uint32_t i = 0; i < heap.capacity(); i++)
+    {
+      if (i % 2 == 0)
+      {
+        dropped.push_back(heap.make(static_cast<int>(i)));
+      }
+      else
+      {
+        kept.push_back(heap.make(static_cast<int>(i)));
+      }
+    }
+    return kept;
+  }
+} // namespace
+
+//---------------------
+//  Make
+//---------------------
+
+TEST(compacting_heap,
+     Make_Called_ConstructsObjectInsideHeap)
+{
+  bg::CompactingHeap<SimpleTestObject> heap(4);
+
+  auto handle = heap.make(42);
+
+  ASSERT_EQ(42, handle.get()->GetValue());
+  ASSERT_TRUE(heap.owns(handle.get()));
+  ASSERT_EQ(1u, heap.liveCount());
+}
+
+TEST(compacting_heap,
+     Make_CalledUntilFull_ReturnsEmptyHandle)
+{
+  bg::CompactingHeap<int> heap(1);
+
+  auto first = heap.make(1);
+  auto second = heap.make(2);
+
+  ASSERT_TRUE(first);
+  ASSERT_FALSE(second);
+}
+
+TEST(compacting_heap,
+     Make_CalledAfterRelease_ReusesLowestFreeSlot)
+{
+  bg::CompactingHeap<int> heap(4);
+  auto first = heap.make(1);
+  int *released;
+  {
+    auto second = heap.make(2);
+    released = second.get();
+  }
+  auto third = heap.make(3);
+
+  auto reused = heap.make(4);
+
+  ASSERT_EQ(released, third.get());
+  ASSERT_EQ(third.get() + 1, reused.get());
+}
+
+//---------------------
+//  Release
+//---------------------
+
+TEST(compacting_heap,
+     HandleDropped_LastReference_DestructsObjectAndFreesSlot)
+{
+  TrackedDeletableTestObject::reset();
+  bg::CompactingHeap<TrackedDeletableTestObject> heap(4);
+
+  {
+    auto handle = heap.make();
+    auto copy = handle;
+  }
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+  ASSERT_EQ(0u, heap.liveCount());
+}
+
+//---------------------
+//  Defragment
+//---------------------
+
+TEST(compacting_heap,
+     Defragment_CalledOnFragmentedHeap_PacksObjectsAtFront)
+{
+  MoveTrackedTestObject::reset();
+  bg::CompactingHeap<MoveTrackedTestObject> heap(8);
+  auto kept = makeFragmented(heap);
+
+  auto moves = heap.defragment();
+  settleRetiredObjects();
+
+  auto stats = heap.getStats();
+  ASSERT_EQ(2u, moves);
+  ASSERT_EQ(4u, stats.highWaterMark);
+  ASSERT_EQ(0u, stats.holes);
+  ASSERT_EQ(4, MoveTrackedTestObject::getLiveObjectCount());
+}
+
+TEST(compacting_heap,
+     Defragment_Called_HandlesFollowMovedObjects)
+{
+  MoveTrackedTestObject::reset();
+  bg::CompactingHeap<MoveTrackedTestObject> heap(8);
+  auto kept = makeFragmented(heap);
+  std::vector<bg::MutableWeakPtr<MoveTrackedTestObject>> weak;
+  for (auto &handle : kept)
+  {
+    weak.emplace_back(handle);
+  }
+
+  heap.defragment();
+  settleRetiredObjects();
+
+  for (size_t i = 0; i < kept.size(); i++)
+  {
+    const int expected = static_cast<int>(i * 2 + 1);
+    ASSERT_EQ(expected, kept[i].get()->value);
+    ASSERT_EQ(expected, weak[i].lock().get()->value);
+    ASSERT_TRUE(heap.owns(kept[i].get()));
+  }
+}
+
+TEST(compacting_heap,
+     Defragment_Called_MovesRatherThanCopies)
+{
+  MoveTrackedTestObject::reset();
+  bg::CompactingHeap<MoveTrackedTestObject> heap(8);
+  auto kept = makeFragmented(heap);
+
+  heap.defragment();
+
+  ASSERT_EQ(2, MoveTrackedTestObject::getMoveCount());
+}
+
+TEST(compacting_heap,
+     Defragment_CalledWithMoveBudget_StopsAtBudget)
+{
+  bg::CompactingHeap<MoveTrackedTestObject> heap(8);
+  auto kept = makeFragmented(heap);
+
+  auto moves = heap.defragment(1);
+  settleRetiredObjects();
+
+  ASSERT_EQ(1u, moves);
+  ASSERT_EQ(6u, heap.getStats().highWaterMark);
+}
+
+TEST(compacting_heap,
+     Defragment_CalledOnCompactHeap_MovesNothing)
+{
+  bg::CompactingHeap<int> heap(4);
+  auto first = heap.make(1);
+  auto second = heap.make(2);
+
+  ASSERT_EQ(0u, heap.defragment());
+}
+
+TEST(compacting_heap,
+     Defragment_CalledThenHandlesDropped_DestructsEveryObject)
+{
+  MoveTrackedTestObject::reset();
+
+  {
+    bg::CompactingHeap<MoveTrackedTestObject> heap(8);
+    {
+      auto kept = makeFragmented(heap);
+      heap.defragment();
+    }
+    settleRetiredObjects();
+
+    ASSERT_EQ(0u, heap.liveCount());
+  }
+
+  ASSERT_EQ(0, MoveTrackedTestObject::getLiveObjectCount());
+}
+
+//---------------------
+//  Stats
+//---------------------
+
+TEST(compacting_heap,
+     GetStats_CalledOnFragmentedHeap_ReportsHoles)
+{
+  bg::CompactingHeap<MoveTrackedTestObject> heap(8);
+  auto kept = makeFragmented(heap);
+
+  auto stats = heap.getStats();
+
+  ASSERT_EQ(8u, stats.capacity);
+  ASSERT_EQ(4u, stats.liveCount);
+  ASSERT_EQ(8u, stats.highWaterMark);
+  ASSERT_EQ(4u, stats.holes);
+  ASSERT_DOUBLE_EQ(0.5, stats.fragmentation);
+}
+
+TEST(compacting_heap,
+     GetStats_CalledThroughConstReference_ReportsLiveCount)
+{
+  bg::CompactingHeap<int> heap(4);
+  auto handle = heap.make(1);
+  const auto &view = heap;
+
+  ASSERT_EQ(1u, view.getStats().liveCount);
+  ASSERT_EQ(1u, view.liveCount());
+}
+
+//---------------------
+//  Allocator
+//---------------------
+
+TEST(compacting_heap,
+     Constructor_CalledWithAllocator_AllocatesStorageOnceFromIt)
+{
+  CountingTestAllocator allocator;
+
+  {
+    bg::CompactingHeap<int> heap(64, allocator);
+    auto handle = heap.make(1);
+
+    ASSERT_EQ(1, allocator.getAllocateCount());
+  }
+
+  ASSERT_EQ(1, allocator.getDeallocateCount());
+}
@@ -0,0 +1,283 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pools/ConcurrentBulletPool.hxx"
+#include "../pointers/TestHelpers.hxx"
+#include "../TestAllocators.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+//---------------------
+//  Acquire
+//---------------------
+
+TEST(concurrent_bullet_pool,
+     Acquire_Called_ConstructsObjectWithArguments)
+{
+  bg::ConcurrentBulletPool<SimpleTestObject> pool(64);
+  bg::ConcurrentBulletPool<SimpleTestObject>::Cache cache(pool);
+
+  auto object = cache.acquire(42);
+
+  ASSERT_EQ(42, object->GetValue());
+  ASSERT_TRUE(pool.owns(object));
+  cache.release(object);
+}
+
+TEST(concurrent_bullet_pool,
+     Acquire_CalledOnFreshPool_HandsOutContiguousSlots)
+{
+  bg::ConcurrentBulletPool<double> pool(64);
+  bg::ConcurrentBulletPool<double>::Cache cache(pool);
+
+  auto first = cache.acquire(1.0);
+  auto second = cache.acquire(2.0);
+
+  ASSERT_EQ(first + 1, second);
+  cache.release(first);
+  cache.release(second);
+}
+
+TEST(concurrent_bullet_pool,
+     Acquire_CalledUntilFull_ReturnsNullPtr)
+{
+  bg::ConcurrentBulletPool<int> pool(10, 4);
+  bg::ConcurrentBulletPool<int>::Cache cache(pool);
+  std::vector<int *> objects;
+
+  for (int i = 0; i < 10; i++)
+  {
+    objects.push_back(cache.acquire(i));
+    ASSERT_NE(nullptr, objects.back());
+  }
+
+  ASSERT_EQ(nullptr, cache.acquire(11));
+  for (auto object : objects)
+  {
+    cache.release(object);
+  }
+}
+
+TEST(concurrent_bullet_pool,
+     Acquire_CalledUntilFull_HandsOutEverySlotOnce)
+{
+  bg::ConcurrentBulletPool<int> pool(100, 8);
+  bg::ConcurrentBulletPool<int>::Cache cache(pool);
+  std::set<int *> objects;
+
+  for (int i = 0; i < 100; i++)
+  {
+    objects.insert(cache.acquire(i));
+  }
+
+  ASSERT_EQ(100u, objects.size());
+  for (auto object : objects)
+  {
+    cache.release(object);
+  }
+}
+
+TEST(concurrent_bullet_pool,
+     Acquire_CalledWhileAnotherCacheHoldsSlots_FailsUntilFlushed)
+{
+  bg::ConcurrentBulletPool<int> pool(4, 4);
+  bg::ConcurrentBulletPool<int>::Cache first(pool);
+  bg::ConcurrentBulletPool<int>::Cache second(pool);
+  first.release(first.acquire(1));
+
+  ASSERT_EQ(nullptr, second.acquire(2));
+  first.flush();
+
+  auto object = second.acquire(2);
+  ASSERT_NE(nullptr, object);
+  second.release(object);
+}
+
+//---------------------
+//  Release
+//---------------------
+
+TEST(concurrent_bullet_pool,
+     Release_Called_DestructsTheObject)
+{
+  TrackedDeletableTestObject::reset();
+  bg::ConcurrentBulletPool<TrackedDeletableTestObject> pool(8);
+  bg::ConcurrentBulletPool<TrackedDeletableTestObject>::Cache cache(pool);
+
+  cache.release(cache.acquire());
+
+  ASSERT_EQ(0, TrackedDeletableTestObject::getLiveObjectCount());
+}
+
+TEST(concurrent_bullet_pool,
+     Release_CalledThenAcquired_ReusesReleasedSlot)
+{
+  bg::ConcurrentBulletPool<int> pool(64);
+  bg::ConcurrentBulletPool<int>::Cache cache(pool);
+  auto first = cache.acquire(1);
+
+  cache.release(first);
+
+  ASSERT_EQ(first, cache.acquire(2));
+  cache.release(first);
+}
+
+TEST(concurrent_bullet_pool,
+     Release_CalledThroughAnotherCache_KeepsSlotInReleasingCache)
+{
+  bg::ConcurrentBulletPool<int> pool(64, 4);
+  bg::ConcurrentBulletPool<int>::Cache first(pool);
+  bg::ConcurrentBulletPool<int>::Cache second(pool);
+  auto object = first.acquire(1);
+
+  second.release(object);
+
+  ASSERT_EQ(1u, second.cachedCount());
+  ASSERT_EQ(object, second.acquire(2));
+  second.release(object);
+}
+
+TEST(concurrent_bullet_pool,
+     Release_CalledPastTwoMagazines_ReturnsBatchToPool)
+{
+  bg::ConcurrentBulletPool<int> pool(12, 4);
+  bg::ConcurrentBulletPool<int>::Cache cache(pool);
+  std::vector<int *> objects;
+  for (int i = 0; i < 12; i++)
+  {
+    objects.push_back(cache.acquire(i));
+  }
+
+  for (auto object : objects)
+  {
+    cache.release(object);
+  }
+
+  ASSERT_EQ(8u, cache.cachedCount());
+}
+
+TEST(concurrent_bullet_pool,
+     CacheDestructor_Called_ReturnsSlotsToPool)
+{
+  bg::ConcurrentBulletPool<int> pool(4, 4);
+  {
+    bg::ConcurrentBulletPool<int>::Cache first(pool);
+    first.release(first.acquire(1));
+  }
+  bg::ConcurrentBulletPool<int>::Cache second(pool);
+
+  auto object = second.acquire(2);
+
+  ASSERT_NE(nullptr, object);
+  second.release(object);
+}
+
+//---------------------
+//  Allocator
+//---------------------
+
+TEST(concurrent_bullet_pool,
+     Constructor_CalledWithAllocator_AllocatesStorageOnceFromIt)
+{
+  CountingTestAllocator allocator;
+
+  {
+    bg::ConcurrentBulletPool<int> pool(64, 8, allocator);
+    bg::ConcurrentBulletPool<int>::Cache cache(pool);
+    for (int i = 0; i < 64; i++)
+    {
+      cache.release(cache.acquire(i));
+    }
+
+    ASSERT_EQ(1, allocator.getAllocateCount());
+  }
+
+  ASSERT_EQ(1, allocator.getDeallocateCount());
+}
+
+//---------------------
+//  Threads
+//---------------------
+
+TEST(concurrent_bullet_pool,
+     AcquireRelease_CalledFromManyThreads_NeverHandsOutASlotTwice)
+{
+  const int threadCount = 8;
+  const int perThread = 32;
+  bg::ConcurrentBulletPool<std::atomic<int>> pool(threadCount * perThread * 2, 8);
+  std::atomic<int> failures(0);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; t++)
+  {
+    threads.emplace_back([&pool, &failures, t]() {
+      bg::ConcurrentBulletPool<std::atomic<int>>::Cache cache(pool);
+      std::vector<std::atomic<int> *> held;
+      for (int round = 0; round < 200; round++)
+      {
+        for (int i = 0; i < perThread; i++)
+        {
+          auto object = cache.acquire(t);
+          if (object != nullptr)
+          {
+            held.push_back(object);
+          }
+        }
+        for (auto object : held)
+        {
+          if (object->load() != t)
+          {
+            failures++;
+          }
+          cache.release(object);
+        }
+        held.clear();
+      }
+    });
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+
+  ASSERT_EQ(0, failures.load());
+}
+
+TEST(concurrent_bullet_pool,
+     Release_CalledOnDifferentThreadThanAcquire_ReturnsEverySlot)
+{
+  const uint32_t capacity = 256;
+  bg::ConcurrentBulletPool<int> pool(capacity, 8);
+  std::vector<int *> objects;
+
+  std::thread([&pool, &objects, capacity]() {
+    bg::ConcurrentBulletPool<int>::Cache cache(pool);
+    for (uint32_t i = 0; i < capacity; i++)
+    {
+      objects.push_back(cache.acquire(static_cast<int>(i)));
+    }
+  }).join();
+  std::thread([&pool, &objects]() {
+    bg::ConcurrentBulletPool<int>::Cache cache(pool);
+    for (auto object : objects)
+    {
+      cache.release(object);
+    }
+  }).join();
+
+  bg::ConcurrentBulletPool<int>::Cache cache(pool);
+  std::set<int *> reacquired;
+  for (uint32_t i = 0; i < capacity; i++)
+  {
+    reacquired.insert(cache.acquire(0));
+  }
+  ASSERT_EQ(capacity, reacquired.size());
+  ASSERT_EQ(0u, reacquired.count(nullptr));
+  for (auto object : reacquired)
+  {
+    cache.release(object);
+  }
+}
@@ -0,0 +1,224 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pools/GrowablePool.hxx"
+#include "../pointers/TestHelpers.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <vector>
+
+//---------------------
+//  Constructor
+//---------------------
+
+TEST(growable_pool,
+     Constructor_Called_CommitsNothing)
+{
+  bg::GrowablePool<double> pool(1000000);
+
+  ASSERT_EQ(1000000u, pool.maxCapacity());
+  ASSERT_EQ(0u, pool.capacity());
+  ASSERT_EQ(0u, pool.committedBytes());
+}
+
+TEST(growable_pool,
+     Constructor_ZeroCapacity_AcquireReturnsNullPtr)
+{
+  bg::GrowablePool<int> pool(0);
+
+  ASSERT_TRUE(pool.full());
+  ASSERT_EQ(nullptr, pool.acquire(1));
+}
+
+//---------------------
+//  Acquire / Release
+//---------------------
+
+TEST(growable_pool,
+     Acquire_Called_ConstructsObject)
+{
+  bg::GrowablePool<CountedTestValue> pool(100);
+
+  auto object = pool.acquire(7);
+
+  ASSERT_EQ(7, object->value);
+  ASSERT_EQ(1u, pool.liveCount());
+  ASSERT_TRUE(pool.owns(object));
+}
+
+TEST(growable_pool,
+     Acquire_PastCommittedSlots_GrowsWithoutMovingObjects)
+{
+  bg::GrowablePool<int> pool(1000000);
+  std::vector<int *> objects;
+
+  for (int i = 0; i < 100000; i++)
+  {
+    objects.push_back(pool.acquire(i));
+  }
+
+  ASSERT_GE(pool.capacity(), 100000u);
+  ASSERT_LT(pool.capacity(), pool.maxCapacity());
+  for (int i = 0; i < 100000; i++)
+  {
+    ASSERT_EQ(i, *objects[i]);
+  }
+}
+
+TEST(growable_pool,
+     Acquire_MaxCapacityReached_ReturnsNullPtr)
+{
+  bg::GrowablePool<int> pool(3);
+  pool.acquire(1);
+  pool.acquire(2);
+  pool.acquire(3);
+
+  ASSERT_TRUE(pool.full());
+  ASSERT_EQ(nullptr, pool.acquire(4));
+  ASSERT_EQ(3u, pool.capacity());
+}
+
+TEST(growable_pool,
+     Acquire_ConstructorThrows_KeepsSlotFree)
+{
+  bg::GrowablePool<ThrowingTestObject> pool(3);
+  auto first = pool.acquire(false);
+  pool.release(first);
+
+  ASSERT_THROW(pool.acquire(true), std::runtime_error);
+
+  ASSERT_EQ(0u, pool.liveCount());
+  ASSERT_EQ(first, pool.acquire(false));
+  for (int i = 0; i < 2; i++)
+  {
+    auto object = pool.acquire(false);
+    ASSERT_TRUE(pool.owns(object));
+  }
+  ASSERT_TRUE(pool.full());
+  pool.clear();
+}
+
+TEST(growable_pool,
+     Release_Called_ReusesSlot)
+{
+  CountedTestValue::reset();
+  bg::GrowablePool<CountedTestValue> pool(100);
+  pool.acquire(1);
+  auto second = pool.acquire(2);
+
+  pool.release(second);
+
+  ASSERT_EQ(1, CountedTestValue::getLiveObjectCount());
+  ASSERT_EQ(second, pool.acquire(3));
+  pool.clear();
+}
+
+TEST(growable_pool,
+     Destructor_LiveObjects_DestroysThem)
+{
+  CountedTestValue::reset();
+  {
+    bg::GrowablePool<CountedTestValue> pool(100);
+    pool.acquire(1);
+    pool.acquire(2);
+  }
+
+  ASSERT_EQ(0, CountedTestValue::getLiveObjectCount());
+}
+
+//---------------------
+//  Trim
+//---------------------
+
+TEST(growable_pool,
+     Trim_TrailingChunksEmpty_DecommitsThem)
+{
+  bg::GrowablePool<int> pool(1000000);
+  std::vector<int *> objects;
+  for (int i = 0; i < 100000; i++)
+  {
+    objects.push_back(pool.acquire(i));
+  }
+  const size_t grown = pool.committedBytes();
+  for (int i = 100; i < 100000; i++)
+  {
+    pool.release(objects[i]);
+  }
+
+  pool.trim();
+
+  ASSERT_LT(pool.committedBytes(), grown);
+  ASSERT_LT(pool.capacity(), 100000u);
+  for (int i = 0; i < 100; i++)
+  {
+    ASSERT_EQ(i, *objects[i]);
+  }
+}
+
+TEST(growable_pool,
+     Trim_ThenAcquire_GrowsAgain)
+{
+  bg::GrowablePool<int> pool(1000000);
+  std::vector<int *> objects;
+  for (int i = 0; i < 50000; i++)
+  {
+    objects.push_back(pool.acquire(i));
+  }
+  pool.clear();
+  pool.trim();
+  ASSERT_EQ(0u, pool.capacity());
+
+  for (int i = 0; i < 50000; i++)
+  {
+    ASSERT_EQ(objects[i], pool.acquire(i));
+  }
+}
+
+TEST(growable_pool,
+     Trim_LiveObjectInLastChunk_KeepsEverything)
+{
+  bg::GrowablePool<int> pool(1000000);
+  std::vector<int *> objects;
+  for (int i = 0; i < 50000; i++)
+  {
+    objects.push_back(pool.acquire(i));
+  }
+  for (int i = 0; i < 49999; i++)
+  {
+    pool.release(objects[i]);
+  }
+  const uint32_t capacity = pool.capacity();
+
+  pool.trim();
+
+  ASSERT_EQ(capacity, pool.capacity());
+  ASSERT_EQ(49999, *objects[49999]);
+}
+
+//---------------------
+//  Iteration
+//---------------------
+
+TEST(growable_pool,
+     ForEach_Called_VisitsLiveObjectsInOrder)
+{
+  bg::GrowablePool<int> pool(100000);
+  std::vector<int *> objects;
+  for (int i = 0; i < 20000; i++)
+  {
+    objects.push_back(pool.acquire(i));
+  }
+  for (int i = 0; i < 20000; i += 2)
+  {
+    pool.release(objects[i]);
+  }
+
+  std::vector<int> visited;
+  const auto &constPool = pool;
+  constPool.forEach([&](const int &value) { visited.push_back(value); });
+
+  ASSERT_EQ(10000u, visited.size());
+  for (size_t i = 0; i < visited.size(); i++)
+  {
+    ASSERT_EQ(static_cast<int>(i * 2 + 1), visited[i]);
+  }
+}
@@ -0,0 +1,379 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pools/PersistentPool.hxx"
+#include "../pointers/TestHelpers.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+  struct TestRecord
+  {
+    int value;
+    double weight;
+    bg::PersistentHandle next;
+
+    TestRecord() = default;
+    TestRecord(int v, double w) : value(v), weight(w) {}
+  };
+
+  // Removes the pool file around each test.
+  class PoolFile
+  {
+    std::string filePath;
+
+  public:
+    explicit PoolFile(const char *name)
+        : filePath(testing::TempDir() + name)
+    {
+      remove(filePath.c_str());
+    }
+
+    ~PoolFile()
+    {
+      remove(filePath.c_str());
+    }
+
+    const std::string &path() const
+    {
+      return filePath;
+    }
+  };
+
+  // Overwrites one 32 bit field of a closed pool file's header.
+  void patchHeader(const std::string &path, size_t offset, uint32_t value)
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+} // namespace
+
+//---------------------
+//  Constructor
+//---------------------
+
+TEST(persistent_pool,
+     Constructor_FileMissing_CreatesEmptyPool)
+{
+  PoolFile file("persistent_pool_create.bin");
+
+  bg::PersistentPool<TestRecord> pool(file.path(), 100);
+
+  ASSERT_EQ(100u, pool.capacity());
+  ASSERT_EQ(0u, pool.liveCount());
+  ASSERT_FALSE(pool.full());
+}
+
+TEST(persistent_pool,
+     Constructor_ExistingFile_KeepsItsCapacity)
+{
+  PoolFile file("persistent_pool_capacity.bin");
+  {
+    bg::PersistentPool<TestRecord> pool(file.path(), 100);
+  }
+
+  bg::PersistentPool<TestRecord> pool(file.path(), 5);
+
+  ASSERT_EQ(100u, pool.capacity());
+}
+
+TEST(persistent_pool,
+     Constructor_DifferentRecordSize_Throws)
+{
+  PoolFile file("persistent_pool_layout.bin");
+  {
+    bg::PersistentPool<TestRecord> pool(file.path(), 10);
+  }
+
+  ASSERT_THROW(bg::PersistentPool<char> pool(file.path(), 10), std::runtime_error);
+}
+
+TEST(persistent_pool,
+     Constructor_NotAPoolFile_Throws)
+{
+  PoolFile file("persistent_pool_garbage.bin");
+  {
+    std::ofstream out(file.path());
+    out << "definitely not a pool, but long enough to hold a header";
+  }
+
+  ASSERT_THROW(bg::PersistentPool<TestRecord> pool(file.path(), 10), std::runtime_error);
+}
+
+TEST(persistent_pool,
+     Constructor_BumpIndexPastCapacity_Throws)
+{
+  PoolFile file("persistent_pool_bump.bin");
+  {
+    bg::PersistentPool<int> pool(file.path(), 4);
+  }
+  patchHeader(file.path(), offsetof(bg::inner::PersistentPoolHeader, bumpIndex), 5);
+
+  ASSERT_THROW(bg::PersistentPool<int> pool(file.path(), 4), std::runtime_error);
+}
+
+TEST(persistent_pool,
+     Constructor_LiveCountPastBumpIndex_Throws)
+{
+  PoolFile file("persistent_pool_live.bin");
+  {
+    bg::PersistentPool<int> pool(file.path(), 4);
+    pool.acquire(1);
+  }
+  patchHeader(file.path(), offsetof(bg::inner::PersistentPoolHeader, live), 2);
+
+  ASSERT_THROW(bg::PersistentPool<int> pool(file.path(), 4), std::runtime_error);
+}
+
+TEST(persistent_pool,
+     Constructor_FreeHeadPastBumpIndex_Throws)
+{
+  PoolFile file("persistent_pool_free_head.bin");
+  {
+    bg::PersistentPool<int> pool(file.path(), 4);
+    pool.acquire(1);
+  }
+  patchHeader(file.path(), offsetof(bg::inner::PersistentPoolHeader, freeHead), 1);
+
+  ASSERT_THROW(bg::PersistentPool<int> pool(file.path(), 4), std::runtime_error);
+}
+
+TEST(persistent_pool,
+     Constructor_UnopenablePath_ThrowsSystemError)
+{
+  ASSERT_THROW(bg::PersistentPool<TestRecord> pool(testing::TempDir() + "missing_directory/pool.bin", 10),
+               std::system_error);
+}
+
+//---------------------
+//  Acquire / Release
+//---------------------
+
+TEST(persistent_pool,
+     Acquire_Called_ConstructsObject)
+{
+  PoolFile file("persistent_pool_acquire.bin");
+  bg::PersistentPool<TestRecord> pool(file.path(), 10);
+
+  auto handle = pool.acquire(4, 2.5);
+
+  ASSERT_TRUE(static_cast<bool>(handle));
+  ASSERT_EQ(4, pool.get(handle)->value);
+  ASSERT_EQ(2.5, pool.get(handle)->weight);
+  ASSERT_EQ(1u, pool.liveCount());
+}
+
+TEST(persistent_pool,
+     Acquire_PoolFull_ReturnsEmptyHandle)
+{
+  PoolFile file("persistent_pool_full.bin");
+  bg::PersistentPool<int> pool(file.path(), 2);
+  pool.acquire(1);
+  pool.acquire(2);
+
+  ASSERT_TRUE(pool.full());
+  ASSERT_FALSE(static_cast<bool>(pool.acquire(3)));
+}
+
+TEST(persistent_pool,
+     Acquire_ConstructorThrows_KeepsSlotFree)
+{
+  PoolFile file("persistent_pool_throw.bin");
+  bg::PersistentPool<ThrowingTestObject> pool(file.path(), 2);
+  auto first = pool.acquire(false);
+  pool.release(first);
+
+  ASSERT_THROW(pool.acquire(true), std::runtime_error);
+  ASSERT_EQ(first, pool.acquire(false));
+  ASSERT_THROW(pool.acquire(true), std::runtime_error);
+  ASSERT_TRUE(static_cast<bool>(pool.acquire(false)));
+
+  ASSERT_EQ(2u, pool.liveCount());
+  ASSERT_TRUE(pool.full());
+}
+
+TEST(persistent_pool,
+     Release_Called_ReusesSlot)
+{
+  PoolFile file("persistent_pool_reuse.bin");
+  bg::PersistentPool<int> pool(file.path(), 2);
+  pool.acquire(1);
+  auto second = pool.acquire(2);
+  ASSERT_TRUE(pool.full());
+
+  pool.release(second);
+
+  ASSERT_FALSE(pool.full());
+  ASSERT_EQ(nullptr, pool.get(second));
+  ASSERT_EQ(second, pool.acquire(3));
+}
+
+TEST(persistent_pool,
+     Release_EmptyHandle_DoesNothing)
+{
+  PoolFile file("persistent_pool_release_empty.bin");
+  bg::PersistentPool<int> pool(file.path(), 2);
+  pool.acquire(1);
+
+  pool.release(bg::PersistentHandle());
+
+  ASSERT_EQ(1u, pool.liveCount());
+}
+
+TEST(persistent_pool,
+     Clear_Called_ReleasesEverything)
+{
+  PoolFile file("persistent_pool_clear.bin");
+  bg::PersistentPool<int> pool(file.path(), 3);
+  auto handle = pool.acquire(1);
+  pool.acquire(2);
+
+  pool.clear();
+
+  ASSERT_EQ(0u, pool.liveCount());
+  ASSERT_EQ(nullptr, pool.get(handle));
+  int visited = 0;
+  pool.forEach([&](int &) { visited++; });
+  ASSERT_EQ(0, visited);
+}
+
+//---------------------
+//  Handles
+//---------------------
+
+TEST(persistent_pool,
+     Get_HandleNotInPool_ReturnsNull)
+{
+  PoolFile file("persistent_pool_bad_handle.bin");
+  bg::PersistentPool<TestRecord> pool(file.path(), 4);
+  auto handle = pool.acquire(1, 1.0);
+
+  ASSERT_EQ(nullptr, pool.get(bg::PersistentHandle()));
+  ASSERT_EQ(nullptr, pool.get(bg::PersistentHandle{handle.offset + 1}));
+  ASSERT_EQ(nullptr, pool.get(bg::PersistentHandle{handle.offset + 1000 * sizeof(TestRecord)}));
+}
+
+TEST(persistent_pool,
+     HandleOf_Called_RoundTrips)
+{
+  PoolFile file("persistent_pool_handle_of.bin");
+  bg::PersistentPool<TestRecord> pool(file.path(), 4);
+  pool.acquire(1, 1.0);
+  auto handle = pool.acquire(2, 2.0);
+
+  ASSERT_EQ(handle, pool.handleOf(pool.get(handle)));
+}
+
+//---------------------
+//  Persistence
+//---------------------
+
+TEST(persistent_pool,
+     Reopen_AfterFlush_RestoresObjectsAndHandles)
+{
+  PoolFile file("persistent_pool_reopen.bin");
+  std::vector<bg::PersistentHandle> handles;
+  {
+    bg::PersistentPool<TestRecord> pool(file.path(), 200);
+    for (int i = 0; i < 150; i++)
+    {
+      handles.push_back(pool.acquire(i, i * 0.5));
+    }
+    pool.flush();
+  }
+
+  bg::PersistentPool<TestRecord> pool(file.path(), 200);
+
+  ASSERT_EQ(150u, pool.liveCount());
+  for (int i = 0; i < 150; i++)
+  {
+    ASSERT_EQ(i, pool.get(handles[i])->value);
+    ASSERT_EQ(i * 0.5, pool.get(handles[i])->weight);
+  }
+}
+
+TEST(persistent_pool,
+     Reopen_AfterRelease_KeepsFreeList)
+{
+  PoolFile file("persistent_pool_reopen_free.bin");
+  bg::PersistentHandle released;
+  {
+    bg::PersistentPool<int> pool(file.path(), 3);
+    pool.acquire(1);
+    released = pool.acquire(2);
+    pool.acquire(3);
+    pool.release(released);
+  }
+
+  bg::PersistentPool<int> pool(file.path(), 3);
+
+  ASSERT_EQ(2u, pool.liveCount());
+  ASSERT_EQ(nullptr, pool.get(released));
+  ASSERT_EQ(released, pool.acquire(4));
+  ASSERT_TRUE(pool.full());
+}
+
+TEST(persistent_pool,
+     Reopen_LinkedRecords_FollowsStoredHandles)
+{
+  PoolFile file("persistent_pool_linked.bin");
+  bg::PersistentHandle head;
+  {
+    bg::PersistentPool<TestRecord> pool(file.path(), 10);
+    for (int i = 0; i < 5; i++)
+    {
+      auto handle = pool.acquire(i, 0.0);
+      pool.get(handle)->next = head;
+      head = handle;
+    }
+  }
+
+  bg::PersistentPool<TestRecord> pool(file.path(), 10);
+  std::vector<int> values;
+  for (auto handle = head; handle; handle = pool.get(handle)->next)
+  {
+    values.push_back(pool.get(handle)->value);
+  }
+
+  ASSERT_THAT(values, testing::ElementsAre(4, 3, 2, 1, 0));
+}
+
+//---------------------
+//  Iteration
+//---------------------
+
+TEST(persistent_pool,
+     ForEach_Called_VisitsLiveObjectsInOrder)
+{
+  PoolFile file("persistent_pool_for_each.bin");
+  bg::PersistentPool<int> pool(file.path(), 130);
+  std::vector<bg::PersistentHandle> handles;
+  for (int i = 0; i < 130; i++)
+  {
+    handles.push_back(pool.acquire(i));
+  }
+  for (int i = 0; i < 130; i += 2)
+  {
+    pool.release(handles[i]);
+  }
+
+  std::vector<int> visited;
+  const auto &constPool = pool;
+  constPool.forEach([&](const int &value) { visited.push_back(value); });
+
+  ASSERT_EQ(65u, visited.size());
+  for (size_t i = 0; i < visited.size(); i++)
+  {
+    ASSERT_EQ(static_cast<int>(i * 2 + 1), visited[i]);
+  }
+}
@@ -0,0 +1,211 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pools/SlotMap.hxx"
+#include "../TestAllocators.hxx"
+#include "../pointers/TestHelpers.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <numeric>
+
+//---------------------
+//  Constructor
+//---------------------
+
+TEST(slot_map,
+     Constructor_Called_AllocatesOnceFromAllocator)
+{
+  CountingTestAllocator allocator;
+
+  {
+    bg::SlotMap<int> map(16, allocator);
+    map.insert(1);
+    ASSERT_EQ(1, allocator.getAllocateCount());
+  }
+
+  ASSERT_EQ(1, allocator.getDeallocateCount());
+}
+
+//---------------------
+//  Insert
+//---------------------
+
+TEST(slot_map,
+     Insert_Called_ReturnsHandleToValue)
+{
+  bg::SlotMap<int> map(4);
+
+  auto handle = map.insert(42);
+
+  ASSERT_TRUE(handle);
+  ASSERT_EQ(42, *map.get(handle));
+  ASSERT_EQ(1u, map.size());
+}
+
+TEST(slot_map,
+     Insert_Full_ReturnsEmptyHandle)
+{
+  bg::SlotMap<int> map(1);
+  map.insert(1);
+
+  auto handle = map.insert(2);
+
+  ASSERT_FALSE(handle);
+  ASSERT_TRUE(map.full());
+}
+
+TEST(slot_map,
+     Insert_Several_KeepsValuesDense)
+{
+  bg::SlotMap<int> map(8);
+
+  for (int i = 1; i <= 4; i++)
+  {
+    map.insert(i);
+  }
+
+  ASSERT_EQ(10, std::accumulate(map.begin(), map.end(), 0));
+  ASSERT_EQ(map.begin() + 4, map.end());
+}
+
+//---------------------
+//  Erase
+//---------------------
+
+TEST(slot_map,
+     Erase_MiddleValue_MovesLastValueIntoHole)
+{
+  bg::SlotMap<int> map(8);
+  auto first = map.insert(1);
+  auto second = map.insert(2);
+  auto third = map.insert(3);
+
+  ASSERT_TRUE(map.erase(second));
+
+  ASSERT_EQ(2u, map.size());
+  ASSERT_EQ(3, map.begin()[1]);
+  ASSERT_EQ(1, *map.get(first));
+  ASSERT_EQ(3, *map.get(third));
+}
+
+TEST(slot_map,
+     Erase_Called_MakesHandleStale)
+{
+  bg::SlotMap<int> map(4);
+  auto handle = map.insert(1);
+
+  map.erase(handle);
+
+  ASSERT_FALSE(map.contains(handle));
+  ASSERT_EQ(nullptr, map.get(handle));
+  ASSERT_FALSE(map.erase(handle));
+}
+
+TEST(slot_map,
+     Erase_SlotReused_OldHandleStaysStale)
+{
+  bg::SlotMap<int> map(1);
+  auto old = map.insert(1);
+  map.erase(old);
+
+  auto reused = map.insert(2);
+
+  ASSERT_EQ(old.index, reused.index);
+  ASSERT_NE(old, reused);
+  ASSERT_EQ(nullptr, map.get(old));
+  ASSERT_EQ(2, *map.get(reused));
+}
+
+TEST(slot_map,
+     Erase_EmptyHandle_ReturnsFalse)
+{
+  bg::SlotMap<int> map(4);
+  map.insert(1);
+
+  ASSERT_FALSE(map.erase(bg::SlotMapHandle()));
+  ASSERT_EQ(1u, map.size());
+}
+
+TEST(slot_map,
+     Erase_Called_DestroysExactlyOneValue)
+{
+  CountedTestValue::reset();
+  {
+    bg::SlotMap<CountedTestValue> map(4);
+    auto first = map.insert(1);
+    map.insert(2);
+
+    map.erase(first);
+
+    ASSERT_EQ(1, CountedTestValue::getLiveObjectCount());
+    ASSERT_EQ(2, map.begin()->value);
+  }
+
+  ASSERT_EQ(0, CountedTestValue::getLiveObjectCount());
+}
+
+//---------------------
+//  Clear
+//---------------------
+
+TEST(slot_map,
+     Clear_Called_MakesEveryHandleStale)
+{
+  bg::SlotMap<int> map(4);
+  auto first = map.insert(1);
+  auto second = map.insert(2);
+
+  map.clear();
+
+  ASSERT_EQ(0u, map.size());
+  ASSERT_FALSE(map.contains(first));
+  ASSERT_FALSE(map.contains(second));
+  ASSERT_TRUE(map.insert(3));
+}
+
+//---------------------
+//  Handles
+//---------------------
+
+TEST(slot_map,
+     HandleAt_DenseIndex_ReturnsHandleOfValue)
+{
+  bg::SlotMap<int> map(4);
+  map.insert(1);
+  auto second = map.insert(2);
+
+  ASSERT_EQ(second, map.handleAt(1));
+}
+
+TEST(slot_map,
+     ToBits_RoundTrip_ReturnsSameHandle)
+{
+  bg::SlotMapHandle handle{7, 3};
+
+  ASSERT_EQ(handle, bg::SlotMapHandle::fromBits(handle.toBits()));
+}
+
+TEST(slot_map,
+     Get_ForeignIndex_ReturnsNullPtr)
+{
+  bg::SlotMap<int> map(4);
+
+  ASSERT_EQ(nullptr, map.get(bg::SlotMapHandle{100, 1}));
+}
+
+TEST(slot_map,
+     Get_FreeSlotWithMatchingGeneration_ReturnsNullPtr)
+{
+  bg::SlotMap<int> map(4);
+  auto erased = map.insert(1);
+  map.insert(2);
+  map.erase(erased);
+  const bg::SlotMapHandle neverUsed{3, 1};
+  const bg::SlotMapHandle released{erased.index, erased.generation + 1};
+
+  ASSERT_FALSE(map.contains(neverUsed));
+  ASSERT_EQ(nullptr, map.get(neverUsed));
+  ASSERT_FALSE(map.erase(neverUsed));
+  ASSERT_FALSE(map.contains(released));
+  ASSERT_FALSE(map.erase(released));
+  ASSERT_EQ(1u, map.size());
+}
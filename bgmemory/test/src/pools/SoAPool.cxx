@@ -0,0 +1,250 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/pools/SoAPool.hxx"
+#include "../TestAllocators.hxx"
+#include "../pointers/TestHelpers.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <stdint.h>
+#include <memory>
+#include <numeric>
+#include <string>
+
+namespace
+{
+  using ParticlePool = bg::SoAPool<float, double, char>;
+} // namespace
+
+//---------------------
+//  Constructor
+//---------------------
+
+TEST(soa_pool,
+     Constructor_Called_AllocatesOnceFromAllocator)
+{
+  CountingTestAllocator allocator;
+
+  {
+    ParticlePool pool(16, allocator);
+    pool.insert(1.0f, 2.0, 'a');
+    ASSERT_EQ(1, allocator.getAllocateCount());
+  }
+
+  ASSERT_EQ(1, allocator.getDeallocateCount());
+}
+
+TEST(soa_pool,
+     Constructor_Called_AlignsEveryField)
+{
+  ParticlePool pool(13);
+
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(pool.field<0>().data()) % bg::simd512Alignment);
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(pool.field<1>().data()) % bg::simd512Alignment);
+  ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(pool.field<2>().data()) % bg::simd512Alignment);
+}
+
+TEST(soa_pool,
+     Constructor_ZeroCapacity_IsFull)
+{
+  ParticlePool pool(0);
+
+  ASSERT_TRUE(pool.full());
+  ASSERT_FALSE(pool.insert(1.0f, 2.0, 'a'));
+}
+
+//---------------------
+//  Insert
+//---------------------
+
+TEST(soa_pool,
+     Insert_Called_StoresEachField)
+{
+  ParticlePool pool(4);
+
+  auto handle = pool.insert(1.5f, 2.5, 'x');
+
+  ASSERT_TRUE(handle);
+  ASSERT_EQ(1.5f, *pool.get<0>(handle));
+  ASSERT_EQ(2.5, *pool.get<1>(handle));
+  ASSERT_EQ('x', *pool.get<2>(handle));
+  ASSERT_EQ(1u, pool.size());
+}
+
+TEST(soa_pool,
+     Insert_Full_ReturnsEmptyHandle)
+{
+  ParticlePool pool(1);
+  pool.insert(1.0f, 1.0, 'a');
+
+  auto handle = pool.insert(2.0f, 2.0, 'b');
+
+  ASSERT_FALSE(handle);
+  ASSERT_TRUE(pool.full());
+}
+
+TEST(soa_pool,
+     Insert_MoveOnlyField_TakesOwnership)
+{
+  bg::SoAPool<int, std::unique_ptr<std::string>> pool(2);
+
+  auto handle = pool.insert(1, std::unique_ptr<std::string>(new std::string("owned")));
+
+  ASSERT_EQ("owned", **pool.get<1>(handle));
+}
+
+//---------------------
+//  Fields
+//---------------------
+
+TEST(soa_pool,
+     Field_Several_SpansDenseValues)
+{
+  ParticlePool pool(8);
+  for (int i = 1; i <= 4; i++)
+  {
+    pool.insert(static_cast<float>(i), i * 10.0, 'a');
+  }
+
+  auto positions = pool.field<0>();
+  auto weights = pool.field<1>();
+
+  ASSERT_EQ(4u, positions.size());
+  ASSERT_EQ(10.0f, std::accumulate(positions.begin(), positions.end(), 0.0f));
+  ASSERT_EQ(100.0, std::accumulate(weights.begin(), weights.end(), 0.0));
+}
+
+TEST(soa_pool,
+     Field_Written_VisibleThroughHandle)
+{
+  ParticlePool pool(8);
+  auto first = pool.insert(1.0f, 0.0, 'a');
+  auto second = pool.insert(2.0f, 0.0, 'b');
+
+  auto positions = pool.field<0>();
+  for (uint32_t i = 0; i < positions.size(); i++)
+  {
+    positions[i] *= 3.0f;
+  }
+
+  ASSERT_EQ(3.0f, *pool.get<0>(first));
+  ASSERT_EQ(6.0f, *pool.get<0>(second));
+}
+
+TEST(soa_pool,
+     Field_ConstPool_ReturnsConstSpan)
+{
+  ParticlePool pool(4);
+  pool.insert(1.0f, 2.0, 'a');
+  const ParticlePool &constPool = pool;
+
+  auto weights = constPool.field<1>();
+
+  ASSERT_TRUE((std::is_same<const double *, decltype(weights.data())>::value));
+  ASSERT_EQ(2.0, weights[0]);
+}
+
+//---------------------
+//  Erase
+//---------------------
+
+TEST(soa_pool,
+     Erase_MiddleValue_MovesLastValueIntoHoleInEveryField)
+{
+  ParticlePool pool(8);
+  auto first = pool.insert(1.0f, 10.0, 'a');
+  auto second = pool.insert(2.0f, 20.0, 'b');
+  auto third = pool.insert(3.0f, 30.0, 'c');
+
+  ASSERT_TRUE(pool.erase(second));
+
+  ASSERT_EQ(2u, pool.size());
+  ASSERT_EQ(3.0f, pool.field<0>()[1]);
+  ASSERT_EQ(30.0, pool.field<1>()[1]);
+  ASSERT_EQ('c', pool.field<2>()[1]);
+  ASSERT_EQ(third, pool.handleAt(1));
+  ASSERT_EQ(1.0f, *pool.get<0>(first));
+  ASSERT_EQ(30.0, *pool.get<1>(third));
+}
+
+TEST(soa_pool,
+     Erase_Called_MakesHandleStale)
+{
+  ParticlePool pool(4);
+  auto handle = pool.insert(1.0f, 1.0, 'a');
+
+  pool.erase(handle);
+
+  ASSERT_FALSE(pool.contains(handle));
+  ASSERT_EQ(nullptr, pool.get<0>(handle));
+  ASSERT_FALSE(pool.erase(handle));
+}
+
+TEST(soa_pool,
+     Erase_SlotReused_OldHandleStaysStale)
+{
+  ParticlePool pool(1);
+  auto old = pool.insert(1.0f, 1.0, 'a');
+  pool.erase(old);
+
+  auto reused = pool.insert(2.0f, 2.0, 'b');
+
+  ASSERT_EQ(old.index, reused.index);
+  ASSERT_NE(old, reused);
+  ASSERT_EQ(nullptr, pool.get<2>(old));
+  ASSERT_EQ('b', *pool.get<2>(reused));
+}
+
+TEST(soa_pool,
+     Erase_Called_DestroysExactlyOneValue)
+{
+  CountedTestValue::reset();
+  {
+    bg::SoAPool<CountedTestValue, int> pool(4);
+    auto first = pool.insert(CountedTestValue(1), 1);
+    pool.insert(CountedTestValue(2), 2);
+
+    pool.erase(first);
+
+    ASSERT_EQ(1, CountedTestValue::getLiveObjectCount());
+    ASSERT_EQ(2, pool.field<0>()[0].value);
+  }
+
+  ASSERT_EQ(0, CountedTestValue::getLiveObjectCount());
+}
+
+TEST(soa_pool,
+     Erase_FreeSlotWithMatchingGeneration_ReturnsFalse)
+{
+  ParticlePool pool(4);
+  auto erased = pool.insert(1.0f, 1.0, 'a');
+  pool.insert(2.0f, 2.0, 'b');
+  pool.erase(erased);
+  const ParticlePool::Handle neverUsed{3, 1};
+  const ParticlePool::Handle released{erased.index, erased.generation + 1};
+
+  ASSERT_FALSE(pool.contains(neverUsed));
+  ASSERT_EQ(nullptr, pool.get<0>(neverUsed));
+  ASSERT_FALSE(pool.erase(neverUsed));
+  ASSERT_FALSE(pool.contains(released));
+  ASSERT_FALSE(pool.erase(released));
+  ASSERT_EQ(1u, pool.size());
+}
+
+//---------------------
+//  Clear
+//---------------------
+
+TEST(soa_pool,
+     Clear_Called_MakesEveryHandleStale)
+{
+  ParticlePool pool(4);
+  auto first = pool.insert(1.0f, 1.0, 'a');
+  auto second = pool.insert(2.0f, 2.0, 'b');
+
+  pool.clear();
+
+  ASSERT_EQ(0u, pool.size());
+  ASSERT_FALSE(pool.contains(first));
+  ASSERT_FALSE(pool.contains(second));
+  ASSERT_TRUE(pool.insert(3.0f, 3.0, 'c'));
+}
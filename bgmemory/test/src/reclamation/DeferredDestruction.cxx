@@ -0,0 +1,238 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/reclamation/DeferredDestruction.hxx"
+#include "bgmemory/pointers/MutableSharedPtr.hxx"
+#include "bgmemory/pointers/MutableWeakPtr.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  class DeferredTestObject
+  {
+    static std::atomic<int> destroyedCount;
+    int id;
+    std::vector<int> *order;
+
+  public:
+    bg::MutableSharedPtr<DeferredTestObject> child;
+    std::thread::id destroyedOn;
+    std::thread::id *destroyedOnOut = nullptr;
+
+    explicit DeferredTestObject(int i, std::vector<int> *o = nullptr) : id(i), order(o) {}
+
+    ~DeferredTestObject()
+    {
+      if (order != nullptr)
+      {
+        order->push_back(id);
+      }
+      if (destroyedOnOut != nullptr)
+      {
+        *destroyedOnOut = std::this_thread::get_id();
+      }
+      destroyedCount++;
+    }
+
+    static int getDestroyedCount()
+    {
+      return destroyedCount.load();
+    }
+
+    static void reset()
+    {
+      destroyedCount = 0;
+    }
+  };
+
+  std::atomic<int> DeferredTestObject::destroyedCount(0);
+} // namespace
+
+//---------------------
+//  Scope
+//---------------------
+
+TEST(deferred_destruction,
+     Release_OutsideScope_DestroysImmediately)
+{
+  DeferredTestObject::reset();
+
+  {
+    bg::MutableSharedPtr<DeferredTestObject> pointer(new DeferredTestObject(1));
+  }
+
+  ASSERT_EQ(1, DeferredTestObject::getDestroyedCount());
+  ASSERT_EQ(0u, bg::pendingDestructions());
+}
+
+TEST(deferred_destruction,
+     Release_InsideScope_DefersUntilCollect)
+{
+  DeferredTestObject::reset();
+
+  {
+    bg::DeferredDestructionScope scope;
+    bg::MutableSharedPtr<DeferredTestObject> pointer(new DeferredTestObject(1));
+  }
+
+  ASSERT_EQ(0, DeferredTestObject::getDestroyedCount());
+  ASSERT_EQ(1u, bg::pendingDestructions());
+
+  ASSERT_EQ(1u, bg::collect());
+  ASSERT_EQ(1, DeferredTestObject::getDestroyedCount());
+  ASSERT_EQ(0u, bg::pendingDestructions());
+}
+
+TEST(deferred_destruction,
+     Release_InsideScope_WeakPointerSeesExpired)
+{
+  DeferredTestObject::reset();
+
+  bg::MutableWeakPtr<DeferredTestObject> weak;
+  {
+    bg::DeferredDestructionScope scope;
+    auto pointer = bg::makeMutableShared<DeferredTestObject>(1);
+    weak = pointer;
+  }
+
+  ASSERT_TRUE(weak.expired());
+  ASSERT_FALSE(weak.lock());
+  ASSERT_EQ(0, DeferredTestObject::getDestroyedCount());
+  bg::collect();
+}
+
+TEST(deferred_destruction,
+     Release_NotLastReference_DoesNotQueue)
+{
+  DeferredTestObject::reset();
+
+  bg::MutableSharedPtr<DeferredTestObject> kept(new DeferredTestObject(1));
+  {
+    bg::DeferredDestructionScope scope;
+    auto copy = kept;
+  }
+
+  ASSERT_EQ(0u, bg::pendingDestructions());
+}
+
+//---------------------
+//  Collect
+//---------------------
+
+TEST(deferred_destruction,
+     Collect_Limit_DestroysOldestFirst)
+{
+  DeferredTestObject::reset();
+
+  std::vector<int> order;
+  {
+    bg::DeferredDestructionScope scope;
+    for (int i = 0; i < 4; i++)
+    {
+      bg::MutableSharedPtr<DeferredTestObject> pointer(new DeferredTestObject(i, &order));
+    }
+  }
+
+  ASSERT_EQ(2u, bg::collect(2));
+  ASSERT_THAT(order, testing::ElementsAre(0, 1));
+  ASSERT_EQ(2u, bg::pendingDestructions());
+
+  ASSERT_EQ(2u, bg::collect());
+  ASSERT_THAT(order, testing::ElementsAre(0, 1, 2, 3));
+}
+
+TEST(deferred_destruction,
+     Collect_MixedPayloadTypes_DestroysEachTypeTogether)
+{
+  DeferredTestObject::reset();
+
+  std::vector<int> order;
+  {
+    bg::DeferredDestructionScope scope;
+    for (int i = 0; i < 3; i++)
+    {
+      bg::MutableSharedPtr<DeferredTestObject> heap(new DeferredTestObject(i, &order));
+      auto inplace = bg::makeMutableShared<DeferredTestObject>(10 + i, &order);
+    }
+  }
+
+  bg::collect();
+
+  ASSERT_EQ(6u, order.size());
+  const std::vector<int> heapFirst{0, 1, 2, 10, 11, 12};
+  const std::vector<int> inplaceFirst{10, 11, 12, 0, 1, 2};
+  ASSERT_TRUE(order == heapFirst || order == inplaceFirst);
+}
+
+TEST(deferred_destruction,
+     Collect_InsideScope_DestroysReleasedChildrenInSameCall)
+{
+  DeferredTestObject::reset();
+
+  bg::DeferredDestructionScope scope;
+  {
+    bg::MutableSharedPtr<DeferredTestObject> parent(new DeferredTestObject(1));
+    parent->child = bg::MutableSharedPtr<DeferredTestObject>(new DeferredTestObject(2));
+  }
+
+  ASSERT_EQ(1u, bg::collect());
+
+  ASSERT_EQ(2, DeferredTestObject::getDestroyedCount());
+  ASSERT_EQ(0u, bg::pendingDestructions());
+}
+
+TEST(deferred_destruction,
+     Collect_NothingQueued_ReturnsZero)
+{
+  DeferredTestObject::reset();
+
+  ASSERT_EQ(0u, bg::collect());
+}
+
+//---------------------
+//  Background Collector
+//---------------------
+
+TEST(deferred_destruction,
+     BackgroundCollector_Notified_DestroysOnCollectorThread)
+{
+  DeferredTestObject::reset();
+
+  std::thread::id destroyedOn;
+  bg::BackgroundCollector collector(std::chrono::hours(1));
+  {
+    bg::DeferredDestructionScope scope;
+    bg::MutableSharedPtr<DeferredTestObject> pointer(new DeferredTestObject(1));
+    pointer->destroyedOnOut = &destroyedOn;
+  }
+
+  collector.notify();
+  while (DeferredTestObject::getDestroyedCount() == 0)
+  {
+    std::this_thread::yield();
+  }
+
+  ASSERT_NE(std::this_thread::get_id(), destroyedOn);
+}
+
+TEST(deferred_destruction,
+     BackgroundCollector_Destroyed_CollectsRemaining)
+{
+  DeferredTestObject::reset();
+
+  {
+    bg::BackgroundCollector collector(std::chrono::hours(1));
+    bg::DeferredDestructionScope scope;
+    for (int i = 0; i < 10; i++)
+    {
+      bg::MutableSharedPtr<DeferredTestObject> pointer(new DeferredTestObject(i));
+    }
+  }
+
+  ASSERT_EQ(10, DeferredTestObject::getDestroyedCount());
+  ASSERT_EQ(0u, bg::pendingDestructions());
+}
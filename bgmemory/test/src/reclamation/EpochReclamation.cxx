@@ -0,0 +1,98 @@
+// Copyright [2020] BlindGarret<lroe2930@gmail.com>
+#include "bgmemory/reclamation/EpochReclamation.hxx"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <thread>
+
+namespace
+{
+  void countReclaim(void *, void *context)
+  {
+    (*static_cast<std::atomic<int> *>(context))++;
+  }
+} // namespace
+
+TEST(epoch_reclamation,
+     Retire_ThenSynchronized_ReclaimsObject)
+{
+  std::atomic<int> reclaimed(0);
+  int object = 0;
+
+  bg::retire(&object, &countReclaim, &reclaimed);
+  bg::synchronizeRetired();
+
+  ASSERT_EQ(1, reclaimed.load());
+}
+
+TEST(epoch_reclamation,
+     Retire_WhileGuardHeldOnOtherThread_WaitsForGuardToEnd)
+{
+  std::atomic<int> reclaimed(0);
+  std::atomic<bool> guardEntered(false);
+  std::atomic<bool> releaseGuard(false);
+  int object = 0;
+
+  std::thread reader([&guardEntered, &releaseGuard]() {
+    bg::EpochGuard guard;
+    guardEntered = true;
+    while (!releaseGuard.load())
+    {
+      std::this_thread::yield();
+    }
+  });
+  while (!guardEntered.load())
+  {
+    std::this_thread::yield();
+  }
+
+  bg::retire(&object, &countReclaim, &reclaimed);
+  for (int i = 0; i < 10; i++)
+  {
+    bg::reclaimRetired();
+  }
+  ASSERT_EQ(0, reclaimed.load());
+
+  releaseGuard = true;
+  reader.join();
+  bg::synchronizeRetired();
+
+  ASSERT_EQ(1, reclaimed.load());
+}
+
+TEST(epoch_reclamation,
+     Retire_CalledInsideGuardOnSameThread_NotReclaimedWhileGuardHeld)
+{
+  std::atomic<int> reclaimed(0);
+  int object = 0;
+
+  {
+    bg::EpochGuard guard;
+    bg::EpochGuard nested;
+    bg::retire(&object, &countReclaim, &reclaimed);
+    bg::reclaimRetired();
+    bg::reclaimRetired();
+
+    ASSERT_EQ(0, reclaimed.load());
+  }
+  bg::synchronizeRetired();
+
+  ASSERT_EQ(1, reclaimed.load());
+}
+
+TEST(epoch_reclamation,
+     Retire_ManyObjectsWithoutReaders_ReclaimsInBatches)
+{
+  std::atomic<int> reclaimed(0);
+  int objects[1000];
+
+  for (auto &object : objects)
+  {
+    bg::retire(&object, &countReclaim, &reclaimed);
+  }
+
+  ASSERT_LT(0, reclaimed.load());
+  bg::synchronizeRetired();
+  ASSERT_EQ(1000, reclaimed.load());
+}